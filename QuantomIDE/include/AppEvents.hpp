@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Events.hpp>
+#include <FileSearch.hpp>
+#include <TextEncoding.hpp>
+
+#include "BuildTrace.hpp"
+#include "LSP.hpp"
+
+// Events of the application layer, numbered in the slots core leaves to the application.
+// All are posted from background threads and handled on the UI thread.
+enum class AppEvent : std::size_t {
+	DocumentPreview,
+	DocumentLoaded,
+	DocumentsSaved,
+	CompletionReceived,
+	BuildFinished,
+	SearchResults,
+	TraceCaptured,
+
+	Count
+};
+static_assert(static_cast<std::size_t>(AppEvent::Count) <= core::AppEventCount, "more application events than core reserves slots for");
+
+constexpr core::EventId IdOf(AppEvent event)
+{
+	return core::AppEventId(static_cast<std::size_t>(event));
+}
+
+// The beginning of a file that is still being read, enough for the first screen
+struct DocumentPreview {
+	static constexpr core::EventId Id = IdOf(AppEvent::DocumentPreview);
+
+	std::string tabId;
+	std::string text;
+};
+
+// A file read by EditorManager::openFile on the thread pool, already decoded and indexed
+struct DocumentLoaded {
+	static constexpr core::EventId Id = IdOf(AppEvent::DocumentLoaded);
+
+	struct Contents {
+		std::string text;
+		std::vector<std::size_t> lineStarts;
+		core::TextEncoding encoding;
+	};
+
+	std::string tabId;
+	std::filesystem::path path;
+	// Null if the file could not be read. Handlers only get a const event, so the tab takes the
+	// contents over through the pointer instead of copying a possibly huge file.
+	std::unique_ptr<Contents> contents;
+};
+
+// Result of TabBar::saveAll, posted by the last of its writes
+struct DocumentsSaved {
+	static constexpr core::EventId Id = IdOf(AppEvent::DocumentsSaved);
+
+	struct SavedDocument {
+		std::string tabId;
+		std::filesystem::path path;
+		std::uint64_t revision; // of the document when it was snapshotted
+		std::shared_ptr<const std::string> text;
+		core::TextEncoding encoding; // written in
+		bool saved;
+	};
+
+	std::vector<SavedDocument> documents;
+};
+
+struct CompletionReceived {
+	static constexpr core::EventId Id = IdOf(AppEvent::CompletionReceived);
+
+	int requestId;
+	std::vector<CompletionItem> items;
+};
+
+struct BuildFinished {
+	static constexpr core::EventId Id = IdOf(AppEvent::BuildFinished);
+
+	std::string output;
+	std::shared_ptr<const BuildSummary> summary;
+};
+
+// Files with matches of a FindInFiles search, posted from the thread pool as each file is searched
+struct SearchResults {
+	static constexpr core::EventId Id = IdOf(AppEvent::SearchResults);
+
+	std::uint64_t searchId;
+	// Null in the last event of a search, posted once it is over. Like DocumentLoaded, the pointer
+	// lets the handler take the lines over from a const event.
+	std::unique_ptr<core::FileSearch::FileResult> file;
+};
+
+// A trace written by Application::CaptureTrace (F12), shown in the status bar
+struct TraceCaptured {
+	static constexpr core::EventId Id = IdOf(AppEvent::TraceCaptured);
+
+	std::filesystem::path file;
+	bool written;
+};
@@ -1,87 +1,101 @@
-#pragma once
-#define IMGUI_ENABLE_DOCKING
-#include <string>
-#include <memory>
-#include <imgui.h>
-#include "imgui_impl_glfw.h"
-#include "imgui_impl_opengl3.h"
-#include <stdio.h>
-#include <GLFW/glfw3.h>
-#include <filesystem>
-#include <iostream>
-#include <fstream>
-
-
-#include "EditorManager.hpp"
-#include "UIManager.hpp"
-#include "BuildSystem.hpp"
-#include "DebugSystem.hpp"
-
-
-// Forward declarations to avoid unnecessary includes
-struct GLFWwindow;
-class Core;
-
-// Application class managing the core lifecycle
-class Application
-{
-public:
-    // Constructor / Destructor
-    Application(const std::string& title = "Quantom IDE", int width = 1280, int height = 720);
-    ~Application();
-
-    // Prevent copy
-    Application(const Application&) = delete;
-    Application& operator=(const Application&) = delete;
-
-    // Allow move (optional)
-    Application(Application&&) noexcept = default;
-    Application& operator=(Application&&) noexcept = default;
-
-    // Main run loop
-    void Run();
-
-    // Should be called once per frame (used for testing or external integration)
-    void Update();
-
-    // Accessors
-    inline GLFWwindow* GetWindow() const { return m_Window; }
-    inline bool ShouldClose() const;
-
-private:
-    // Internal methods
-    void InitGLFW();
-    void InitImGui();
-    void Shutdown();
-
-    void ShowMainDockSpaceWithStatusBar();
-    void ShowMainDockSpace();
-
-    void BeginFrame();
-    void EndFrame();
-
-private:
-    GLFWwindow* m_Window = nullptr;
-    ImGuiIO* m_IO = nullptr;
-    std::string m_Title;
-    int m_Width;
-    int m_Height;
-    bool m_Running = false;
-    bool show_demo_window = true;
-    bool show_another_window = false;
-    bool m_debugSessionActive = false;
-    ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
-    std::vector<CompletionItem> m_completionItems;
-    int m_pendingCompletionId = -1;
-    bool m_showCompletionPopup = false;
-
-    
-    EditorManager m_Editor;
-    UIManager m_UIManager;
-    BuildSystem m_BuildSytem;
-    TreeView m_TreeView;
-    StatusBar m_StatusBar;
-    MenuBar m_MenuBar;
-    Project m_Project;
-    DebugSystem m_DebugSystem;
-};
+#pragma once
+#define IMGUI_ENABLE_DOCKING
+#include <string>
+#include <memory>
+#include <imgui.h>
+#include "imgui_impl_glfw.h"
+#include "imgui_impl_opengl3.h"
+#include <stdio.h>
+#include <GLFW/glfw3.h>
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+
+
+#include "EditorManager.hpp"
+#include "UIManager.hpp"
+#include "BuildSystem.hpp"
+#include "DebugSystem.hpp"
+#include "LSP.hpp"
+
+
+// Forward declarations to avoid unnecessary includes
+struct GLFWwindow;
+class Core;
+
+// Application class managing the core lifecycle
+class Application
+{
+public:
+    // Constructor / Destructor
+    Application(const std::string& title = "Quantom IDE", int width = 1280, int height = 720);
+    ~Application();
+
+    // Prevent copy
+    Application(const Application&) = delete;
+    Application& operator=(const Application&) = delete;
+
+    // Allow move (optional)
+    Application(Application&&) noexcept = default;
+    Application& operator=(Application&&) noexcept = default;
+
+    // Main run loop
+    void Run();
+
+    // Should be called once per frame (used for testing or external integration)
+    void Update();
+
+    // Accessors
+    inline GLFWwindow* GetWindow() const { return m_Window; }
+    inline bool ShouldClose() const;
+
+private:
+    // Internal methods
+    void InitGLFW();
+    void InitImGui();
+    void Shutdown();
+
+    void ShowMainDockSpaceWithStatusBar();
+    void ShowMainDockSpace();
+
+    // Polls while there is activity, otherwise blocks until input or a background wake-up
+    void WaitForEvents();
+    void BeginFrame();
+    void EndFrame();
+
+    // Writes the profiler's zones of the last seconds as a Chrome/Perfetto trace (F12)
+    void CaptureTrace();
+
+private:
+    GLFWwindow* m_Window = nullptr;
+    ImGuiIO* m_IO = nullptr;
+    std::string m_Title;
+    int m_Width;
+    int m_Height;
+    bool m_Running = false;
+    bool show_demo_window = true;
+    bool show_another_window = false;
+    bool m_debugSessionActive = false;
+    ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+    std::vector<CompletionItem> m_completionItems;
+    int m_pendingCompletionId = -1;
+    bool m_showCompletionPopup = false;
+    std::uint64_t m_CompileDatabaseRevision = 0;
+    std::vector<core::EventBus::SubscriptionId> m_Subscriptions;
+    int m_ActiveFrames = 3; // frames left before the loop may block again, see WaitForEvents
+
+    //LSPClient m_LSPClient{ "C:\\Program Files\\LLVM\\bin\\clangd.exe", { "--log=verbose", "--all-scopes-completion", "--background-index", "--completion-style=detailed" } };
+    LSPClient m_LSPClient{ "clangd", { "--log=verbose", "--all-scopes-completion", "--background-index", "--completion-style=detailed" } };
+
+    
+    EditorManager m_Editor;
+    UIManager m_UIManager;
+    BuildSystem m_BuildSytem;
+    TreeView m_TreeView;
+    StatusBar m_StatusBar;
+    MenuBar m_MenuBar;
+    Project m_Project;
+    DebugSystem m_DebugSystem;
+    PerformanceMonitor m_PerformanceMonitor;
+    FindInFiles m_FindInFiles;
+};
@@ -1,167 +1,230 @@
-#include <atomic>
-#include <string>
-#include <mutex>
-#include <thread>
-#include <filesystem>
-#include <fstream>
-#include <algorithm> // for std::transform
-#include <stdexcept>
-#include <vector>
-#include <iostream>
-
-
-#include <Log.hpp>
-#include "Project.hpp"
-#include "EditorManager.hpp"
-
-
-enum class CompileMode {
-	CompileAndLink,  // default, no -c
-	CompileOnly      // -c
-};
-
-enum class Compiler
-{
-	gcc,
-	MSVC,
-	Clang
-};
-
-enum class CompilerFlag {
-	// C++ Standards
-	Cpp98,
-	Cpp03,
-	Cpp11,
-	Cpp14,
-	Cpp17,
-	Cpp20,
-	Cpp23,
-
-	// Optimization Levels
-	Optimize0,  // -O0 (no optimization)
-	Optimize1,  // -O1
-	Optimize2,  // -O2
-	Optimize3,  // -O3
-	OptimizeS,  // -Os (optimize for size)
-	OptimizeFast, // -Ofast (aggressive optimization, may break standards)
-
-	// Warning Flags
-	Wall,       // -Wall
-	Wextra,     // -Wextra
-	Werror,     // -Werror (treat warnings as errors)
-
-	// Debugging
-	Debug,      // -g (include debug symbols)
-
-	// Sanitizers (runtime checks)
-	AddressSanitizer, // -fsanitize=address
-	ThreadSanitizer,  // -fsanitize=thread
-	UndefinedBehaviorSanitizer, // -fsanitize=undefined
-
-	// Misc
-	Pedantic,   // -pedantic (strict standard compliance)
-	StdLibcxx,  // -stdlib=libc++ (choose libc++ standard library, useful on some platforms)
-	NoExceptions, // -fno-exceptions
-	NoRtti,       // -fno-rtti
-	Verbose
-};
-
-
-static std::string to_string(CompilerFlag flag) {
-	switch (flag) {
-		// C++ standards
-	case CompilerFlag::Cpp98: return "-std=c++98";
-	case CompilerFlag::Cpp03: return "-std=c++03";
-	case CompilerFlag::Cpp11: return "-std=c++11";
-	case CompilerFlag::Cpp14: return "-std=c++14";
-	case CompilerFlag::Cpp17: return "-std=c++17";
-	case CompilerFlag::Cpp20: return "-std=c++20";
-	case CompilerFlag::Cpp23: return "-std=c++23";
-
-		// Optimization
-	case CompilerFlag::Optimize0: return "-O0";
-	case CompilerFlag::Optimize1: return "-O1";
-	case CompilerFlag::Optimize2: return "-O2";
-	case CompilerFlag::Optimize3: return "-O3";
-	case CompilerFlag::OptimizeS: return "-Os";
-	case CompilerFlag::OptimizeFast: return "-Ofast";
-
-		// Warnings
-	case CompilerFlag::Wall: return "-Wall";
-	case CompilerFlag::Wextra: return "-Wextra";
-	case CompilerFlag::Werror: return "-Werror";
-
-		// Debug
-	case CompilerFlag::Debug: return "-g";
-
-		// Sanitizers
-	case CompilerFlag::AddressSanitizer: return "-fsanitize=address";
-	case CompilerFlag::ThreadSanitizer: return "-fsanitize=thread";
-	case CompilerFlag::UndefinedBehaviorSanitizer: return "-fsanitize=undefined";
-
-		// Misc
-	case CompilerFlag::Pedantic: return "-pedantic";
-	case CompilerFlag::StdLibcxx: return "-stdlib=libc++";
-	case CompilerFlag::NoExceptions: return "-fno-exceptions";
-	case CompilerFlag::NoRtti: return "-fno-rtti";
-	case CompilerFlag::Verbose: return "-v";
-	}
-	return "";
-}
-static std::string to_string(CompileMode mode) {
-	switch (mode) {
-	case CompileMode::CompileAndLink: return "";
-	case CompileMode::CompileOnly: return "-c";
-	}
-	return "";
-}
-
-static std::string parseCompiler(Compiler compiler)
-{
-	switch (compiler)
-	{
-	case Compiler::gcc:   return "g++";
-	case Compiler::MSVC:  return "cl";     // MSVC compiler executable is `cl`
-	case Compiler::Clang: return "clang";
-	}
-	return ""; // or throw, if you prefer
-}
-
-class BuildSystem {
-public:
-	BuildSystem();
-
-	void BuildCurrentProject( EditorManager&, Project& );
-	void RunCurrentProject(const Project& p_Project);
-
-	std::string BuildFlags(const std::vector<CompilerFlag>&);
-	std::string BuildFiles(std::vector<std::filesystem::path>);
-
-
-
-
-	//    std::vector<std::string> otherOptions = {
-	//    "-Iinclude",       // include directory
-	//    "-DDEBUG=1",       // macro define
-	//    "-Llibs",          // library directory
-	//    "-lm"              // math lib
-	//    };
-	//
-	static std::mutex s_ConsoleMutex;
-	static std::string s_ConsoleOutput;
-
-	static std::mutex s_OutputMutex;
-	static std::string s_BuildOutput;
-	std::mutex m_BuildMutex;
-private:
-	Compiler m_Compiler;
-	std::vector<CompilerFlag> m_BuildFlags;
-
-
-
-	char m_EditorBuffer[1024 * 16];
-	std::atomic_bool m_IsBuilding; // ne se global, static znaci deka kje ima samo vo toj translation unit ili obj file, mislese deka se global zs pravese vo cpp, toa e samo init sto pravis vo cpp inc tuka se deklarirani
-
-
-
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <filesystem>
+#include <fstream>
+#include <algorithm> // for std::transform
+#include <stdexcept>
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+
+
+#include <Log.hpp>
+#include <ThreadPool.hpp>
+#include "BuildTrace.hpp"
+#include "CommandLineBuilder.hpp"
+#include "CompilationDatabase.hpp"
+#include "Project.hpp"
+#include "EditorManager.hpp"
+
+
+enum class CompileMode {
+	CompileAndLink,  // default, no -c
+	CompileOnly      // -c
+};
+
+enum class Compiler
+{
+	gcc,
+	MSVC,
+	Clang
+};
+
+enum class CompilerFlag {
+	// C++ Standards
+	Cpp98,
+	Cpp03,
+	Cpp11,
+	Cpp14,
+	Cpp17,
+	Cpp20,
+	Cpp23,
+
+	// Optimization Levels
+	Optimize0,  // -O0 (no optimization)
+	Optimize1,  // -O1
+	Optimize2,  // -O2
+	Optimize3,  // -O3
+	OptimizeS,  // -Os (optimize for size)
+	OptimizeFast, // -Ofast (aggressive optimization, may break standards)
+
+	// Warning Flags
+	Wall,       // -Wall
+	Wextra,     // -Wextra
+	Werror,     // -Werror (treat warnings as errors)
+
+	// Debugging
+	Debug,      // -g (include debug symbols)
+
+	// Sanitizers (runtime checks)
+	AddressSanitizer, // -fsanitize=address
+	ThreadSanitizer,  // -fsanitize=thread
+	UndefinedBehaviorSanitizer, // -fsanitize=undefined
+
+	// Misc
+	Pedantic,   // -pedantic (strict standard compliance)
+	StdLibcxx,  // -stdlib=libc++ (choose libc++ standard library, useful on some platforms)
+	NoExceptions, // -fno-exceptions
+	NoRtti,       // -fno-rtti
+	Verbose
+};
+
+
+static std::string to_string(CompilerFlag flag) {
+	switch (flag) {
+		// C++ standards
+	case CompilerFlag::Cpp98: return "-std=c++98";
+	case CompilerFlag::Cpp03: return "-std=c++03";
+	case CompilerFlag::Cpp11: return "-std=c++11";
+	case CompilerFlag::Cpp14: return "-std=c++14";
+	case CompilerFlag::Cpp17: return "-std=c++17";
+	case CompilerFlag::Cpp20: return "-std=c++20";
+	case CompilerFlag::Cpp23: return "-std=c++23";
+
+		// Optimization
+	case CompilerFlag::Optimize0: return "-O0";
+	case CompilerFlag::Optimize1: return "-O1";
+	case CompilerFlag::Optimize2: return "-O2";
+	case CompilerFlag::Optimize3: return "-O3";
+	case CompilerFlag::OptimizeS: return "-Os";
+	case CompilerFlag::OptimizeFast: return "-Ofast";
+
+		// Warnings
+	case CompilerFlag::Wall: return "-Wall";
+	case CompilerFlag::Wextra: return "-Wextra";
+	case CompilerFlag::Werror: return "-Werror";
+
+		// Debug
+	case CompilerFlag::Debug: return "-g";
+
+		// Sanitizers
+	case CompilerFlag::AddressSanitizer: return "-fsanitize=address";
+	case CompilerFlag::ThreadSanitizer: return "-fsanitize=thread";
+	case CompilerFlag::UndefinedBehaviorSanitizer: return "-fsanitize=undefined";
+
+		// Misc
+	case CompilerFlag::Pedantic: return "-pedantic";
+	case CompilerFlag::StdLibcxx: return "-stdlib=libc++";
+	case CompilerFlag::NoExceptions: return "-fno-exceptions";
+	case CompilerFlag::NoRtti: return "-fno-rtti";
+	case CompilerFlag::Verbose: return "-v";
+	}
+	return "";
+}
+static std::string to_string(CompileMode mode) {
+	switch (mode) {
+	case CompileMode::CompileAndLink: return "";
+	case CompileMode::CompileOnly: return "-c";
+	}
+	return "";
+}
+
+static std::string parseCompiler(Compiler compiler)
+{
+	switch (compiler)
+	{
+	case Compiler::gcc:   return "g++";
+	case Compiler::MSVC:  return "cl";     // MSVC compiler executable is `cl`
+	case Compiler::Clang: return "clang";
+	}
+	return ""; // or throw, if you prefer
+}
+
+// A single compiler invocation producing one object file (a source file or a unity batch)
+struct CompileJob {
+	std::filesystem::path directory;
+	std::filesystem::path source;
+	std::filesystem::path object;
+	std::shared_ptr<const CompileCommand> command; // cached compiler argv, run from directory
+	std::vector<std::string> extraArguments; // build-only arguments not listed in compile_commands.json
+	std::uint64_t hash = 0; // command and extra arguments, an object built with a different hash is stale
+	std::vector<std::filesystem::path> dependencies; // from the previous build's .d file, empty if there is none
+	std::filesystem::path timeTraceFile; // written by clang's -ftime-trace, empty for other compilers
+	bool upToDate = false; // skipped, the object is newer than the source and its dependencies
+
+	std::string output;
+	int exitCode = 0;
+
+	std::chrono::steady_clock::time_point queued;
+	std::chrono::steady_clock::time_point started;
+	std::chrono::steady_clock::time_point finished;
+	int worker = 0;
+};
+
+class BuildSystem {
+public:
+	BuildSystem();
+	~BuildSystem(); // cancels and waits for a running build
+
+	// Saves the dirty documents and builds on the thread pool. Compiling waits only for the saves
+	// of files the jobs read, the others finish alongside the build.
+	void BuildCurrentProject( EditorManager&, Project& );
+
+	// Compile jobs that have not started are skipped and nothing is linked; running compilers finish
+	void CancelBuild();
+	// Blocks until the build task is over, it works on a copy of the project and posts BuildFinished
+	void WaitForBuild();
+
+	void RunCurrentProject(const Project& p_Project);
+
+	static std::filesystem::path GetBuildDirectory(const Project& p_Project);
+
+	// Splits the project sources into at most batchCount unity batches. Sources are ordered by
+	// directory so related files share a batch, and batches are balanced by file size.
+	static std::vector<std::vector<std::filesystem::path>> CreateUnityBatches(const Project& p_Project, std::size_t batchCount);
+
+	// Rewrites <root>/compile_commands.json for clangd when the per-file compile commands changed.
+	// Shares the command line cache with the build task, so not while IsBuilding().
+	bool UpdateCompilationDatabase(const Project& p_Project);
+
+	bool IsBuilding() const { return m_IsBuilding.load(); }
+
+
+
+
+	//    std::vector<std::string> otherOptions = {
+	//    "-Iinclude",       // include directory
+	//    "-DDEBUG=1",       // macro define
+	//    "-Llibs",          // library directory
+	//    "-lm"              // math lib
+	//    };
+	//
+	static std::mutex s_ConsoleMutex;
+	static std::string s_ConsoleOutput;
+
+private:
+	// The build task: compiles, links and posts BuildFinished
+	void RunBuild(const Project& p_Project, const std::vector<PendingSave>& saves, const core::CancellationToken& token);
+	std::vector<CompileJob> CreateCompileJobs(const Project& p_Project);
+	CompileJob CreateCompileJob(const Project& p_Project, std::filesystem::path source);
+	bool WriteUnitySource(const std::filesystem::path& unityFile, const std::vector<std::filesystem::path>& sources);
+	void RunCompileJobs(std::vector<CompileJob>& jobs, const core::CancellationToken& token);
+	static void RunJob(CompileJob& job, int worker);
+	static int RunProcess(const std::string& command, std::string& output);
+
+	// Incremental builds: command hashes of the objects built so far, kept in <build>/command_hashes
+	bool IsUpToDate(const CompileJob& job) const;
+	void LoadCommandHashes(const Project& p_Project);
+	void SaveCommandHashes(const Project& p_Project) const;
+
+	Compiler m_Compiler;
+	std::vector<CompilerFlag> m_BuildFlags; // defaults when the project has no compilerFlags
+	CommandLineBuilder m_CommandLine;
+	CompilationDatabase m_CompilationDatabase;
+	std::unordered_map<std::filesystem::path, std::uint64_t> m_CommandHashes;
+
+
+
+	char m_EditorBuffer[1024 * 16];
+	std::future<void> m_Build;
+	core::CancellationToken m_BuildToken; // a new one for every build
+	std::atomic_bool m_IsBuilding; // ne se global, static znaci deka kje ima samo vo toj translation unit ili obj file, mislese deka se global zs pravese vo cpp, toa e samo init sto pravis vo cpp inc tuka se deklarirani
+
+
+
 };
\ No newline at end of file
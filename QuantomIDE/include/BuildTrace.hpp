@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+struct CompileJob;
+
+struct BuildTimingEntry {
+	std::string name;
+	double milliseconds = 0.0;
+	double queueMilliseconds = 0.0;
+};
+
+// Aggregated timings of the last build, shown in the "Build Timings" window
+struct BuildSummary {
+	double totalMilliseconds = 0.0;
+	std::filesystem::path traceFile;
+	std::vector<BuildTimingEntry> slowestUnits;
+	std::vector<BuildTimingEntry> slowestHeaders;
+};
+
+// Collects per-job timings of one build and writes them as a Chrome/Perfetto trace-event file.
+// When the compiler produced a -ftime-trace file for a job, its events are merged into the job's track.
+class BuildTrace {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit BuildTrace(Clock::time_point buildStart);
+
+	void addJob(const CompileJob& job);
+
+	// Writes the trace to traceFile and returns the summary of the slowest units and headers
+	BuildSummary finish(const std::filesystem::path& traceFile, std::size_t maxEntries = 20);
+
+private:
+	void addTimeTrace(const CompileJob& job);
+	double toMicroseconds(Clock::time_point time) const;
+
+	Clock::time_point m_BuildStart;
+	nlohmann::json m_Events = nlohmann::json::array();
+	std::vector<BuildTimingEntry> m_Units;
+	std::unordered_map<std::string, double> m_HeaderTimes;
+	int m_WorkerCount = 0;
+};
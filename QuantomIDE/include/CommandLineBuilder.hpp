@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Project.hpp"
+
+// Resolved compiler invocation for one translation unit (or link step)
+struct CompileCommand {
+	std::vector<std::string> arguments; // argv, arguments[0] is the compiler
+	std::uint64_t hash = 0;             // stable hash of arguments, compared by incremental builds
+};
+
+// Resolves the project's toolchain (compiler, profile flags, project flags and include dirs) once
+// and caches the argv of every translation unit. The cache is dropped only when the project's
+// revision changes, so repeated builds and compile_commands.json updates reuse the same vectors.
+class CommandLineBuilder {
+public:
+	CommandLineBuilder(std::string defaultCompiler, std::vector<std::string> defaultFlags);
+
+	// Re-resolves the toolchain if the project was edited since the last call
+	void sync(const Project& p_Project);
+
+	std::shared_ptr<const CompileCommand> getCompileCommand(const std::filesystem::path& source, const std::filesystem::path& object);
+	std::shared_ptr<const CompileCommand> getLinkCommand(const std::vector<std::filesystem::path>& objects, const std::filesystem::path& output) const;
+
+	bool isClang() const;
+
+	static std::vector<std::string> GetProfileFlags(BuildProfile profile);
+	// Quotes an argument for the shell popen runs, sh or cmd.exe, so it reaches the program unchanged
+	static std::string Quote(const std::string& argument);
+	static std::string Join(const std::vector<std::string>& arguments);
+	static std::uint64_t Hash(const std::vector<std::string>& arguments);
+
+private:
+	std::string m_DefaultCompiler;
+	std::vector<std::string> m_DefaultFlags;
+
+	mutable std::mutex m_Mutex;
+	std::uint64_t m_Revision = 0;
+	std::vector<std::string> m_CompileArguments; // compiler, profile, project flags and include dirs
+	std::vector<std::string> m_LinkArguments;    // compiler, profile and project flags
+	std::unordered_map<std::filesystem::path, std::shared_ptr<const CompileCommand>> m_Commands;
+};
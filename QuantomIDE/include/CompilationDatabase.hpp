@@ -0,0 +1,19 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct CompileJob;
+
+// Maintains a clang compile_commands.json. The file is only replaced when its contents change,
+// so clangd's background index is not invalidated by no-op rewrites.
+class CompilationDatabase {
+public:
+	// Returns true if the file on disk was rewritten
+	bool update(const std::filesystem::path& file, const std::vector<CompileJob>& jobs);
+
+private:
+	std::filesystem::path m_File;
+	std::size_t m_ContentHash = 0;
+};
@@ -1,167 +1,249 @@
-// EditorManager.hpp
-#pragma once
-
-#include <vector>
-#include <memory>
-#include <string>
-#include <filesystem>
-#include <iostream>
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <random>
-#include <sstream>
-#include <optional>
-
-#include "FileManager.hpp"
-#include "LSP.hpp"
-#include "imgui_internal.h"
-
-// Forward declarations
-class Document;
-class SyntaxHighlighter;
-class EditorTab;
-class TabBar;
-
-// Represents the text buffer and handles undo/redo
-class Document {
-public:
-	Document() = default;
-	~Document() = default;
-
-	void setText(const std::string& text);
-	std::string& getText();
-
-	void undo();
-	void redo();
-
-	void insertText(size_t position, const std::string& text);
-	void insertTextAtCursor(const std::string& text);
-
-	bool isDirty() const { return m_Dirty; }
-	void markClean() { m_Dirty = false; }
-
-	void setCursorPos(size_t pos);
-	std::pair<size_t, size_t> getCursorPos() const; // returns cursor line then column
-	size_t getCursorIndex() const { return m_CursorPos; }
-private:
-	std::string m_TextBuffer;
-	bool m_Dirty = false;
-
-	std::vector<std::string> m_UndoStack;
-	std::vector<std::string> m_RedoStack;
-
-	size_t m_CursorPos = 0;
-};
-
-// Handles syntax highlighting of text
-class SyntaxHighlighter { // TODO replace with the GitHub one
-public:
-	SyntaxHighlighter();
-	~SyntaxHighlighter();
-
-	// Apply syntax highlighting to a document
-	void highlight(const Document& doc);
-
-private:
-	// Internal data/methods to handle syntax rules
-};
-
-// Represents a single tab in the editor, managing a document and highlighter
-class EditorTab {
-public:
-	EditorTab(std::string );
-	EditorTab(std::unique_ptr<Document> doc);
-	~EditorTab();
-
-	bool getFocusEditorNextFrame() const { return m_focusEditorNextFrame; }
-	void setFocusEditorNextFrame(bool value) { m_focusEditorNextFrame = value; }
-	void setTabName(std::string name) { m_TabName = name; }
-	void setFilePath(std::filesystem::path path) { m_Path = path; }
-	std::optional<std::filesystem::path> save();
-	std::filesystem::path getFilePath()
-	{
-		if (this == nullptr) {
-			std::cerr << "EditorTab 'this' pointer is null!\n";
-			#ifdef MSVC
-			__debugbreak();
-			#endif
-		}
-		if (m_Path.empty() && !m_TabName.empty())
-		{
-			//TODO only call on tab not always
-			return std::filesystem::path();
-		}
-		return m_Path;
-	}
-
-	void insertText(const std::string& text);
-
-	void setID(std::string& id) { m_UniqueID = id; }
-	std::string getID() { return m_UniqueID; }
-	Document& getDocument();
-	std::string& getTabName() { return m_TabName; }
-	SyntaxHighlighter& getSyntaxHighlighter();
-
-private:
-	std::string m_UniqueID;
-	std::string m_TabName;
-	std::filesystem::path m_Path = "";
-	SyntaxHighlighter m_SyntaxHighlighter;
-	std::unique_ptr<Document> m_Document;
-	bool m_focusEditorNextFrame = false;
-};
-
-// Manages the collection of tabs
-class TabBar {
-public:
-	TabBar();
-	~TabBar();
-
-	void addTab(std::unique_ptr<EditorTab> tab);
-	void closeTab(int index);
-	void closeAll();
-	void saveAll();
-	EditorTab* getTab(int index);
-
-	int getTabCount() const;
-
-	// New:
-	int getCurrentTabIndex() const;
-	EditorTab* getCurrentTab();
-
-	void setCurrentTabIndex(int index);
-
-	void insertText(const std::string& text);
-
-private:
-	std::vector<std::unique_ptr<EditorTab>> m_Tabs;
-	int m_CurrentTabIndex = -1;  // -1 means no active tab
-};
-
-
-// Main manager class for the editor subsystem
-class EditorManager {
-public:
-	EditorManager();
-	~EditorManager();
-
-	void openFile(const std::string& filepath);
-
-	void closeFile(int tabIndex);
-
-	void insertText(const std::string& text);
-
-	TabBar& getTabBar();
-
-	void updateAutosave(float deltaTimeSeconds);
-	void setAutosaveInterval(float seconds) { m_autoSaveInterval = seconds; }
-	void setAutosaveEnabled(bool enabled) { m_autoSaveEnabled = enabled; }
-
-private:
-	TabBar m_TabBar;
-
-	bool m_autoSaveEnabled		= false;
-	float m_autoSaveInterval	= 60.0f;
-	float m_autoSaveTimer		= 0.0f;
-};
+// EditorManager.hpp
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <filesystem>
+#include <iostream>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <sstream>
+#include <optional>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <unordered_map>
+
+#include "FileManager.hpp"
+#include "LSP.hpp"
+#include "EventBus.hpp"
+#include "Platform.hpp"
+#include "TextEncoding.hpp"
+#include "ThreadPool.hpp"
+#include "imgui_internal.h"
+
+// Forward declarations
+class Document;
+class SyntaxHighlighter;
+class EditorTab;
+class TabBar;
+struct DocumentPreview;
+struct DocumentLoaded;
+struct DocumentsSaved;
+
+// Represents the text buffer and handles undo/redo
+class Document {
+public:
+	Document() = default;
+	~Document() = default;
+
+	void setText(const std::string& text);
+	void setText(std::string&& text); // takes over the buffer, e.g. a file that was just read
+	std::string& getText();
+
+	// Replaces the text with a file that finished loading: clean, without history and with its lines
+	// already indexed, so getCursorPos() does not scan the whole file until the first edit
+	void setLoadedText(std::string&& text, std::vector<size_t> lineStarts, core::TextEncoding encoding);
+	core::TextEncoding getEncoding() const { return m_Encoding; }
+	void setEncoding(core::TextEncoding encoding) { m_Encoding = encoding; }
+	// The encoding a save writes: the one the file was read in, or UTF-8 from the first save on which
+	// the text holds characters that encoding cannot store
+	core::TextEncoding getSaveEncoding();
+
+	void undo();
+	void redo();
+
+	void insertText(size_t position, const std::string& text);
+	void insertTextAtCursor(const std::string& text);
+
+	bool isDirty() const { return m_Dirty; }
+	void markClean() { m_Dirty = false; }
+	// Changes with every edit, tells snapshots of the text apart
+	std::uint64_t getRevision() const { return m_Revision; }
+
+	void setCursorPos(size_t pos);
+	void setCursorPos(size_t line, size_t column); // clamped to the text
+	std::pair<size_t, size_t> getCursorPos() const; // returns cursor line then column
+	size_t getCursorIndex() const { return m_CursorPos; }
+private:
+	std::string m_TextBuffer;
+	bool m_Dirty = false;
+	std::uint64_t m_Revision = 0;
+	std::vector<size_t> m_LineStarts; // empty once the text was edited
+	core::TextEncoding m_Encoding = core::TextEncoding::Utf8;
+
+	std::vector<std::string> m_UndoStack;
+	std::vector<std::string> m_RedoStack;
+
+	size_t m_CursorPos = 0;
+};
+
+// Handles syntax highlighting of text
+class SyntaxHighlighter { // TODO replace with the GitHub one
+public:
+	SyntaxHighlighter();
+	~SyntaxHighlighter();
+
+	// Apply syntax highlighting to a document
+	void highlight(const Document& doc);
+
+private:
+	// Internal data/methods to handle syntax rules
+};
+
+// A file being read on the thread pool, shared by its tab and the loading task
+struct FileLoad {
+	std::atomic<size_t> bytesRead{ 0 };
+	std::atomic<size_t> size{ 0 };
+	core::CancellationToken token; // cancelled when the tab closes
+	std::string preview;           // first screen of the file, UI thread only
+	std::optional<std::pair<size_t, size_t>> cursor; // line and column to show once loaded, UI thread only
+
+	float getProgress() const;
+};
+
+// A document write started by TabBar::saveAll, the future tells whether it succeeded
+struct PendingSave {
+	std::filesystem::path path;
+	std::shared_future<bool> written;
+};
+
+// Represents a single tab in the editor, managing a document and highlighter
+class EditorTab {
+public:
+	EditorTab(std::string );
+	EditorTab(std::unique_ptr<Document> doc);
+	~EditorTab();
+
+	bool getFocusEditorNextFrame() const { return m_focusEditorNextFrame; }
+	void setFocusEditorNextFrame(bool value) { m_focusEditorNextFrame = value; }
+	void setTabName(std::string name) { m_TabName = name; }
+	void setFilePath(std::filesystem::path path) { m_Path = path; }
+	std::optional<std::filesystem::path> save();
+	std::filesystem::path getFilePath()
+	{
+		if (this == nullptr) {
+			std::cerr << "EditorTab 'this' pointer is null!\n";
+			#ifdef MSVC
+			__debugbreak();
+			#endif
+		}
+		if (m_Path.empty() && !m_TabName.empty())
+		{
+			//TODO only call on tab not always
+			return std::filesystem::path();
+		}
+		return m_Path;
+	}
+
+	void insertText(const std::string& text);
+
+	// Set while the file is read in the background, the document stays empty until it is done
+	bool isLoading() const { return m_Load != nullptr; }
+	FileLoad* getLoad() { return m_Load.get(); }
+	void setLoad(std::shared_ptr<FileLoad> load) { m_Load = std::move(load); }
+	void finishLoad() { m_Load.reset(); }
+
+	void setID(std::string& id) { m_UniqueID = id; }
+	const std::string& getID() const { return m_UniqueID; }
+	Document& getDocument();
+	std::string& getTabName() { return m_TabName; }
+	SyntaxHighlighter& getSyntaxHighlighter();
+
+private:
+	std::string m_UniqueID;
+	std::string m_TabName;
+	std::filesystem::path m_Path = "";
+	SyntaxHighlighter m_SyntaxHighlighter;
+	std::unique_ptr<Document> m_Document;
+	std::shared_ptr<FileLoad> m_Load;
+	bool m_focusEditorNextFrame = false;
+};
+
+// Manages the collection of tabs
+class TabBar {
+public:
+	TabBar();
+	~TabBar();
+
+	void addTab(std::unique_ptr<EditorTab> tab);
+	void closeTab(int index);
+	void closeAll();
+	// Writes every dirty document that has a file in parallel on the thread pool and returns at once.
+	// The documents are marked clean and the LSP is notified in one batch when all writes are done,
+	// the returned futures let a caller wait for just the files it needs.
+	std::vector<PendingSave> saveAll();
+	EditorTab* getTab(int index);
+	EditorTab* findTab(const std::string& id);
+
+	int getTabCount() const;
+
+	// New:
+	int getCurrentTabIndex() const;
+	EditorTab* getCurrentTab();
+
+	void setCurrentTabIndex(int index);
+
+	void insertText(const std::string& text);
+
+private:
+	std::vector<std::unique_ptr<EditorTab>> m_Tabs;
+	int m_CurrentTabIndex = -1;  // -1 means no active tab
+};
+
+
+// Main manager class for the editor subsystem
+class EditorManager {
+public:
+	EditorManager();
+	~EditorManager();
+
+	// Shows the tab right away and reads the file on the thread pool. The first screen appears as
+	// soon as it is read, decoding, line indexing and the LSP didOpen follow once the whole file is in.
+	void openFile(const std::string& filepath);
+
+	void closeFile(int tabIndex);
+
+	// Selects the tab of path, opening the file if it has none, and puts the cursor on line and column
+	void showLocation(const std::filesystem::path& path, size_t line, size_t column);
+
+	void insertText(const std::string& text);
+
+	TabBar& getTabBar();
+
+	// Crash recovery. Every interval the dirty documents are snapshotted and written to this process's
+	// session in the recovery directory on the thread pool, never to the files themselves; a clean exit
+	// removes them again. A session is a directory named after the pid, owned through a lock file that
+	// is held while the process lives.
+	void updateAutosave(float deltaTimeSeconds);
+	// Reopens the documents of the sessions whose process is gone, those of running instances are left alone
+	void recoverDocuments();
+	void setAutosaveInterval(float seconds) { m_autoSaveInterval = seconds; }
+	void setAutosaveEnabled(bool enabled) { m_autoSaveEnabled = enabled; }
+
+private:
+	void onPreview(const DocumentPreview& event);
+	void onLoaded(const DocumentLoaded& event);
+	void onSaved(const DocumentsSaved& event);
+
+	TabBar m_TabBar;
+	core::EventBus::SubscriptionId m_PreviewSubscription = 0;
+	core::EventBus::SubscriptionId m_LoadedSubscription = 0;
+	core::EventBus::SubscriptionId m_SavedSubscription = 0;
+
+	struct RecoveryFile {
+		std::filesystem::path file;
+		std::uint64_t revision = 0; // of the document it holds
+	};
+	std::unordered_map<std::string, RecoveryFile> m_RecoveryFiles; // by tab id
+	std::future<void> m_AutosaveTask;
+	std::filesystem::path m_RecoverySession; // empty if it could not be locked, nothing is autosaved then
+	core::Platform::FileLock m_RecoveryLock = 0;
+
+	bool m_autoSaveEnabled		= true;
+	float m_autoSaveInterval	= 30.0f;
+	float m_autoSaveTimer		= 0.0f;
+};
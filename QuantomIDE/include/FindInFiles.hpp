@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <EventBus.hpp>
+#include <FileSearch.hpp>
+
+struct SearchResults;
+
+// Model of the "Find in Files" window. A search runs as a core::FileSearch over the project tree on the
+// thread pool, its results arrive as SearchResults events and are appended here on the UI thread. Rows
+// flatten the files and their lines so the window can draw only the visible part of the list.
+class FindInFiles
+{
+public:
+	static constexpr std::uint32_t FileRow = UINT32_MAX; // Row::line of a file's header
+	static constexpr std::size_t MaxMatches = 100000;    // the search is stopped beyond
+
+	struct Row {
+		std::uint32_t file; // index into getFiles()
+		std::uint32_t line; // index into the file's lines, FileRow for its header
+	};
+
+	FindInFiles();  // subscribes to SearchResults
+	~FindInFiles(); // cancels a running search and waits for it
+
+	// Replaces the results with a new search of root. False if the pattern is not valid, getError() says why.
+	bool start(const std::filesystem::path& root, const std::string& pattern, core::SearchOptions options);
+	// Returns at once, the search stops after the files at hand
+	void cancel();
+
+	bool isRunning() const { return m_Running; }
+	bool isTruncated() const { return m_Truncated; }
+	const std::string& getError() const { return m_Error; }
+	const std::filesystem::path& getRoot() const { return m_Root; }
+
+	const std::vector<core::FileSearch::FileResult>& getFiles() const { return m_Files; }
+	const std::vector<Row>& getRows() const { return m_Rows; }
+	std::size_t getMatchCount() const { return m_MatchCount; }
+	std::size_t getSearchedFileCount() const;
+	std::size_t getSearchedByteCount() const;
+	double getElapsedSeconds() const;
+
+private:
+	void onResults(const SearchResults& event);
+
+	std::unique_ptr<core::FileSearch> m_Search;
+	std::uint64_t m_SearchId = 0; // events of earlier searches are dropped
+	bool m_Running = false;
+	bool m_Truncated = false;
+	std::string m_Error;
+	std::filesystem::path m_Root;
+
+	std::vector<core::FileSearch::FileResult> m_Files;
+	std::vector<Row> m_Rows;
+	std::size_t m_MatchCount = 0;
+
+	std::chrono::steady_clock::time_point m_StartTime;
+	std::chrono::steady_clock::duration m_Elapsed{}; // of the finished search
+
+	core::EventBus::SubscriptionId m_ResultsSubscription = 0;
+};
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
 #include <unordered_map>
 #include <functional>
 #include <memory>
@@ -21,6 +24,8 @@ struct CompletionItem {
     std::string insertText;
 };
 
+// Messages are serialised and written by a writer thread in the order they were sent, so no call
+// blocks on the JSON or on the pipe and a didChange can never overtake the didOpen before it.
 class LSPClient {
 public:
     using OnDiagnostics = std::function<void(const std::filesystem::path& uri, const json& diagnostics)>;
@@ -34,16 +39,21 @@ public:
     bool start();
     void stop();
 
-    // Requests
+    // Requests, queued for the writer thread. The texts are copied unless they are shared already.
     int textDocumentCompletion(const std::filesystem::path& uri, int line, int character);
-    void textDocumentDidOpen(const std::filesystem::path& uri, const std::string& languageId, const std::string& text);
-    void textDocumentDidChange(const std::filesystem::path& uri, const std::string& text);
+    void textDocumentDidOpen(const std::filesystem::path& uri, std::string_view languageId, std::string_view text);
+    void textDocumentDidChange(const std::filesystem::path& uri, std::string_view text);
+    // didChange of several documents in a single write, e.g. after saving all tabs
+    void textDocumentsDidChange(std::vector<std::pair<std::filesystem::path, std::shared_ptr<const std::string>>> documents);
 
     // Configuration
     void setOnDiagnostics(OnDiagnostics cb) { diagnosticsCB = std::move(cb); }
     void setOnCompletion(OnCompletion cb) { completionCB = std::move(cb); }
     void setOnLog(OnLog cb) { logCB = std::move(cb); }
 
+    // Requests sent to the server that have not been answered yet
+    std::size_t getPendingRequestCount() const { return pendingRequests.load(std::memory_order_relaxed); }
+
     // Platform abstraction
     class PlatformImpl {
     public:
@@ -61,11 +71,18 @@ private:
     std::string serverPath;
     std::vector<std::string> args;
 
+    using Message = std::function<std::string()>; // returns the framed bytes to write
+
     std::thread readerThread;
+    std::thread writerThread;
     std::atomic<bool> running{false};
     std::mutex writeMutex;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<Message> outgoing; // guarded by queueMutex
+    bool writerStopping = false;  // guarded by queueMutex, the writer drains the queue and exits
     int idCounter = 1;
-    std::unordered_map<int, int> pendingRequests;
+    std::atomic<std::size_t> pendingRequests{0};
 
     // Callbacks
     OnDiagnostics diagnosticsCB;
@@ -75,6 +92,9 @@ private:
     // Core methods
     int nextId();
     bool writeRaw(const std::string& s);
+    void send(Message message);
+    void stopWriter();
+    void writerLoop();
     void readerLoop();
     void handleJsonMessage(const json& msg);
     std::string toLspUri(const std::filesystem::path& path) const;
@@ -1,8 +1,8 @@
-#pragma once
-
-class MenuBar
-{
-public:
-	MenuBar();
-	~MenuBar();
+#pragma once
+
+class MenuBar
+{
+public:
+	MenuBar();
+	~MenuBar();
 };
\ No newline at end of file
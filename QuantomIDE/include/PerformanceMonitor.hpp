@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <Profiler.hpp>
+
+// Numbers of the "Performance" window, aggregated from the profiler's per-thread rings. update()
+// copies only the zones recorded since its previous call and UIManager calls it only while the
+// window is visible, so a closed or hidden window costs nothing.
+class PerformanceMonitor
+{
+public:
+	static constexpr std::size_t HistorySize = 600; // frames kept for the graph and the percentiles
+
+	struct ZoneTiming {
+		const core::ZoneSite* site;
+		double millisecondsPerFrame;
+		double maxMilliseconds; // longest single call
+		std::size_t calls;
+	};
+
+	// Published twice a second so the numbers stay readable
+	struct Snapshot {
+		std::vector<ZoneTiming> zones;       // slowest first
+		double poolUtilisation = 0.0;        // busy share of the thread pool's workers, 0..1
+		std::size_t poolThreads = 0;
+		std::size_t lspPendingRequests = 0;
+		std::size_t frameAllocations = 0;    // frame arena, last complete frame
+		std::size_t frameBytes = 0;
+		std::size_t memoryPoolBlocksInUse = 0;
+	};
+
+	struct Percentiles {
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+	};
+
+	void update(std::size_t lspPendingRequests);
+
+	// Milliseconds per frame, oldest first
+	const std::vector<float>& getFrameTimes() const { return m_FrameTimes; }
+	// Number of frames per 1 ms bucket
+	const std::vector<float>& getFrameHistogram() const { return m_Histogram; }
+	const Percentiles& getFramePercentiles() const { return m_Percentiles; }
+	const Snapshot& getSnapshot() const { return m_Snapshot; }
+
+private:
+	struct ZoneTotal {
+		double milliseconds = 0.0;
+		double maxMilliseconds = 0.0;
+		std::size_t calls = 0;
+	};
+
+	void addFrame(float milliseconds);
+	void publish(std::uint64_t now, double ticksPerMillisecond, std::size_t lspPendingRequests);
+
+	std::uint64_t m_LastUpdate = 0;    // profiler ticks
+	std::uint64_t m_IntervalStart = 0;
+	std::size_t m_IntervalFrames = 0;
+	std::unordered_map<const core::ZoneSite*, ZoneTotal> m_Interval;
+
+	std::vector<float> m_FrameTimes;
+	std::vector<float> m_Sorted; // scratch for the percentiles
+	std::vector<float> m_Histogram;
+	Percentiles m_Percentiles;
+	Snapshot m_Snapshot;
+};
@@ -1,9 +1,66 @@
-#pragma once
-#include "Project.hpp"
-class TreeView
-{
-
-public:
-	TreeView();
-	~TreeView();
-};
\ No newline at end of file
+#pragma once
+#include "Project.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <Core.hpp>
+
+// Cached directory entry of the file explorer, children are read from disk on first expand
+struct TreeNode
+{
+	std::filesystem::path path;
+	std::string name;
+	std::string sortKey; // natural-order key of name, see TreeView::MakeSortKey
+	bool isDirectory = false;
+	bool loaded = false;
+	bool expanded = false;
+	TreeNode* parent = nullptr;
+	std::vector<std::unique_ptr<TreeNode>> children;
+};
+
+// One visible line of the explorer
+struct TreeRow
+{
+	TreeNode* node;
+	int depth;
+};
+
+// In-memory model of the explorer tree. Drawing only reads the model, the disk is touched when a
+// directory is expanded for the first time or when the file watcher reports a change below the root.
+class TreeView
+{
+
+public:
+	TreeView();
+	~TreeView();
+
+	TreeView(const TreeView&) = delete;
+	TreeView& operator=(const TreeView&) = delete;
+
+	// Drops the cached tree and watches the new root
+	void setRoot(const std::filesystem::path& root);
+	TreeNode* getRootNode() { return m_Root.get(); }
+
+	// Loads the children of a directory if they were not read yet
+	void expand(TreeNode& node);
+	void setExpanded(TreeNode& node, bool expanded);
+
+	// Expanded tree flattened into rows, rebuilt only after expand/collapse or a change on disk
+	const std::vector<TreeRow>& getVisibleRows();
+
+	// Case-insensitive key whose byte order is the natural order, e.g. "file2" < "File10"
+	static std::string MakeSortKey(const std::string& name);
+
+private:
+	void rebuildRows();
+	void loadChildren(TreeNode& node);
+	void applyChanges(const std::vector<core::FileChange>& changes);
+	TreeNode* findNode(const std::filesystem::path& path);
+	static void sortChildren(TreeNode& node);
+
+	std::unique_ptr<TreeNode> m_Root;
+	std::vector<TreeRow> m_Rows;
+	bool m_RowsDirty = true;
+};
@@ -1,41 +1,81 @@
-#pragma once
-#define IMGUI_ENABLE_DOCKING
-#include <imgui.h>
-#include <vector>
-#include <cstring> 
-
-
-
-#include "FileManager.hpp"
-#include "EditorManager.hpp"
-#include "TreeView.hpp"
-#include "MenuBar.hpp"
-#include "StatusBar.hpp"
-
-class UIManager {
-public:
-    UIManager() = default;
-    ~UIManager() = default;
-
-    void draw(EditorManager& editor, Project& e) {
-        drawEditor(editor,e);
-    }
-
-    void draw(TreeView& tree, Project& p) {
-        drawTreeView(tree, p);
-    }
-
-    void draw(MenuBar& menu, EditorManager& editor, Project& prj) {
-        drawMenuBar(menu, editor,prj);
-    }
-
-    void draw(StatusBar& status, EditorManager& editor, Project& prj) {
-        drawStatusBar(status, editor, prj);
-    }
-
-private:
-    void drawEditor(EditorManager&,Project&);
-    void drawTreeView(TreeView& p_TreeView, Project& p_Project);
-    void drawMenuBar(MenuBar& menuBar, EditorManager& m_Editor, Project& m_Project);
-    void drawStatusBar(StatusBar& statusBar, EditorManager& editor, Project& m_Project);
+#pragma once
+#define IMGUI_ENABLE_DOCKING
+#include <imgui.h>
+#include <vector>
+#include <cstring> 
+#include <memory>
+#include <string>
+
+#include <EventBus.hpp>
+
+
+
+#include "FileManager.hpp"
+#include "EditorManager.hpp"
+#include "TreeView.hpp"
+#include "MenuBar.hpp"
+#include "StatusBar.hpp"
+#include "BuildTrace.hpp"
+#include "LSP.hpp"
+#include "PerformanceMonitor.hpp"
+#include "FindInFiles.hpp"
+
+class UIManager {
+public:
+    UIManager();  // subscribes to BuildFinished
+    ~UIManager();
+
+    void draw(EditorManager& editor, Project& e) {
+        drawEditor(editor,e);
+    }
+
+    void draw(TreeView& tree, Project& p) {
+        drawTreeView(tree, p);
+    }
+
+    void draw(MenuBar& menu, EditorManager& editor, Project& prj) {
+        drawMenuBar(menu, editor,prj);
+    }
+
+    void draw(StatusBar& status, EditorManager& editor, Project& prj) {
+        drawStatusBar(status, editor, prj);
+    }
+
+    void draw(PerformanceMonitor& monitor, const LSPClient& lsp) {
+        drawPerformance(monitor, lsp);
+    }
+
+    void draw(FindInFiles& search, EditorManager& editor, Project& prj) {
+        drawFindInFiles(search, editor, prj);
+    }
+
+    // Opens the "Find in Files" window with the pattern field focused, Ctrl+Shift+F
+    void showFindInFiles();
+
+private:
+    void drawEditor(EditorManager&,Project&);
+    void drawTreeView(TreeView& p_TreeView, Project& p_Project);
+    void drawMenuBar(MenuBar& menuBar, EditorManager& m_Editor, Project& m_Project);
+    void drawStatusBar(StatusBar& statusBar, EditorManager& editor, Project& m_Project);
+    void drawPerformance(PerformanceMonitor& monitor, const LSPClient& lsp);
+    void drawFindInFiles(FindInFiles& search, EditorManager& editor, Project& project);
+
+    // Result of the last build, delivered through the event bus
+    std::string m_BuildOutput;
+    std::shared_ptr<const BuildSummary> m_LastBuildSummary;
+    core::EventBus::SubscriptionId m_BuildFinishedSubscription = 0;
+
+    // Outcome of the last trace capture (F12), shown in the status bar for a while
+    std::string m_TraceNotice;
+    double m_TraceNoticeUntil = 0.0; // ImGui::GetTime()
+    core::EventBus::SubscriptionId m_TraceCapturedSubscription = 0;
+
+    bool m_ShowPerformance = true; // View > Performance
+
+    // View > Find in Files
+    bool m_ShowFindInFiles = false;
+    bool m_FocusFindPattern = false;
+    char m_FindPattern[256] = {};
+    bool m_FindRegex = false;
+    bool m_FindCaseSensitive = false;
 };
\ No newline at end of file
@@ -1,134 +1,539 @@
-#include "BuildSystem.hpp"
-
-std::string BuildSystem::s_BuildOutput;
-std::string BuildSystem::s_ConsoleOutput;
-
-BuildSystem::BuildSystem()
-{
-	m_Compiler = Compiler::gcc;
-	m_BuildFlags.push_back(CompilerFlag::Cpp20);
-	m_BuildFlags.push_back(CompilerFlag::Optimize0);
-	m_BuildFlags.push_back(CompilerFlag::Debug);
-}
-
-void BuildSystem::BuildCurrentProject(EditorManager& p_Editor, Project& p_Project)
-{
-	if (m_IsBuilding.exchange(true)) {
-		// Already building, ignore subsequent calls
-		return;
-	}
-
-	// Save project if dirty
-	if (p_Project.isDirty())
-	{
-		LOG("[Warning]: Project not saved, saving...", core::Log::LogLevel::Warn);
-		p_Editor.getTabBar().saveAll();
-		p_Project.save();
-	}
-
-	std::thread([this, &p_Project]() {
-		std::string output;
-
-#ifdef _WIN32
-		std::string buildCommand =
-			"cd \"" + p_Project.getRootDirectory().string() + "\""
-			+ " && " + parseCompiler(m_Compiler) + " "
-			+ BuildFlags(m_BuildFlags) + " "
-			+ BuildFiles(p_Project.getSourceFiles()) + " "
-			+ " -o \"" + p_Project.getRootDirectory().string() + "\\" + p_Project.getName() + ".exe\""
-			+ " 2>&1"; // Redirect stderr to stdout
-#else
-		std::string buildCommand =
-			"cd \"" + p_Project.getRootDirectory().string() + "\""
-			+ " && " + parseCompiler(m_Compiler) + " "
-			+ BuildFlags(m_BuildFlags) + " "
-			+ BuildFiles(p_Project.getSourceFiles()) + " "
-			+ " -o \"" + p_Project.getRootDirectory().string() + "/" + p_Project.getName() + "\""
-			+ " 2>&1"; // Redirect stderr to stdout
-#endif
-
-#ifdef _WIN32
-		FILE* pipe = _popen(buildCommand.c_str(), "r");
-#else
-		FILE* pipe = popen(buildCommand.c_str(), "r");
-#endif
-		if (pipe) {
-			char buffer[512];
-			while (fgets(buffer, sizeof(buffer), pipe)) {
-				output += buffer;
-			}
-#ifdef _WIN32
-			_pclose(pipe);
-#else
-			pclose(pipe);
-#endif
-		}
-		else {
-			output = "Failed to start compiler process\n";
-		}
-
-		{
-			std::lock_guard<std::mutex> lock(m_BuildMutex);
-			s_BuildOutput = output;
-			if (output.empty())
-			{
-				s_BuildOutput = "Build is successfull";
-			}
-
-
-		}
-
-		m_IsBuilding.store(false);
-		}).detach();
-}
-
-void BuildSystem::RunCurrentProject(const Project& p_Project)
-{
-	if (p_Project.getName().empty())
-	{
-		LOG("No project is open", core::Log::LogLevel::Warn);
-		return;
-	}
-#ifdef _WIN32
-	std::string command = "\"" + p_Project.getRootDirectory().string() + "\\" + p_Project.getName() + "\"";  // Quote it in case of spaces
-#else
-	std::string command = "\"" + p_Project.getRootDirectory().string() + "/" + p_Project.getName() + "\"";  // Quote it in case of spaces
-#endif
-	std::string result;
-	char buffer[128];
-
-	// "r" = read the output of the command
-#ifdef __linux__
-	std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
-#elif _WIN32
-	std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(command.c_str(), "r"), _pclose);
-#endif
-	if (!pipe.get())
-		throw std::runtime_error("Failed to run command");
-
-	while (fgets(buffer, sizeof(buffer), pipe.get()) != nullptr)
-	{
-		result += buffer;
-	}
-	s_ConsoleOutput = result;
-
-	LOG("Console pipe output: %s", core::Log::LogLevel::Tracer, result.c_str());
-}
-
-std::string BuildSystem::BuildFlags(const std::vector<CompilerFlag>& flags)
-{
-	std::string compilerFlags;
-	for (auto f : flags) {
-		compilerFlags += " " + to_string(f);
-	}
-	return compilerFlags;
-}
-
-std::string BuildSystem::BuildFiles(std::vector<std::filesystem::path> p_Sources)
-{
-	std::string inputFiles;
-	for (const auto& src : p_Sources) {
-		inputFiles += " \"" + src.string() + "\"";
-	}
-	return inputFiles;
-}
\ No newline at end of file
+#include "BuildSystem.hpp"
+#include <Core.hpp>
+#include "AppEvents.hpp"
+#include <FileSystem.hpp>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+extern core::Core g_Core;
+
+std::string BuildSystem::s_ConsoleOutput;
+
+static std::vector<std::string> ToStrings(const std::vector<CompilerFlag>& flags)
+{
+	std::vector<std::string> strings;
+	strings.reserve(flags.size());
+	for (auto flag : flags)
+		strings.push_back(to_string(flag));
+	return strings;
+}
+
+// Optimization and debug info come from the project's BuildProfile
+BuildSystem::BuildSystem()
+	: m_Compiler(Compiler::gcc)
+	, m_BuildFlags{ CompilerFlag::Cpp20 }
+	, m_CommandLine(parseCompiler(m_Compiler), ToStrings(m_BuildFlags))
+{
+}
+
+BuildSystem::~BuildSystem()
+{
+	CancelBuild();
+	WaitForBuild();
+}
+
+void BuildSystem::CancelBuild()
+{
+	m_BuildToken.cancel();
+}
+
+void BuildSystem::WaitForBuild()
+{
+	if (m_Build.valid())
+		g_Core.getThreadPool()->waitFor(m_Build);
+}
+
+// Reads the make rule written by -MMD, "obj.o: src.cpp header.hpp \\" with escaped spaces
+static std::vector<fs::path> ReadDependencies(const fs::path& depFile, const fs::path& directory)
+{
+	std::vector<fs::path> dependencies;
+	auto content = core::FileSystem::readFile(depFile);
+	if (!content.has_value())
+		return dependencies;
+
+	const std::string& text = content.value();
+	std::size_t i = text.find(": ");
+	if (i == std::string::npos)
+		return dependencies;
+
+	std::string current;
+	for (i += 2; i <= text.size(); ++i) {
+		const char c = i < text.size() ? text[i] : ' ';
+		if (c == '\\' && i + 1 < text.size() && text[i + 1] == ' ') {
+			current += ' ';
+			++i;
+		}
+		else if (c == '\\' && i + 1 < text.size() && (text[i + 1] == '\n' || text[i + 1] == '\r')) {
+			continue; // line continuation
+		}
+		else if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+			if (!current.empty()) {
+				fs::path dependency(current);
+				dependencies.push_back(dependency.is_absolute() ? dependency : directory / dependency);
+				current.clear();
+			}
+		}
+		else {
+			current += c;
+		}
+	}
+	return dependencies;
+}
+
+// Blocks the build until the saves of the files its jobs read are written: sources and the
+// dependencies the previous build recorded. A job built for the first time has no dependency
+// list yet, then every save counts.
+static void WaitForSaves(const std::vector<CompileJob>& jobs, const std::vector<PendingSave>& saves)
+{
+	if (saves.empty())
+		return;
+
+	auto normal = [](const fs::path& path) { return fs::absolute(path).lexically_normal(); };
+	bool everything = false;
+	std::vector<fs::path> read;
+	for (const auto& job : jobs) {
+		if (job.dependencies.empty()) {
+			everything = true;
+			break;
+		}
+		read.push_back(normal(job.directory / job.source));
+		for (const auto& dependency : job.dependencies)
+			read.push_back(normal(dependency));
+	}
+	std::sort(read.begin(), read.end());
+
+	core::ThreadPool& pool = *g_Core.getThreadPool();
+	for (const auto& save : saves) {
+		if (!everything && !std::binary_search(read.begin(), read.end(), normal(save.path)))
+			continue;
+		pool.waitFor(save.written);
+		if (!save.written.get())
+			LOG("[BuildSystem]: {} could not be saved, building the version on disk", core::Log::LogLevel::Warn, save.path);
+	}
+}
+
+void BuildSystem::BuildCurrentProject(EditorManager& p_Editor, Project& p_Project)
+{
+	if (m_IsBuilding.exchange(true)) {
+		// Already building, ignore subsequent calls
+		return;
+	}
+
+	// Written in parallel while the build starts
+	std::vector<PendingSave> saves = p_Editor.getTabBar().saveAll();
+
+	// Save project if dirty
+	if (p_Project.isDirty())
+	{
+		LOG("[Warning]: Project not saved, saving...", core::Log::LogLevel::Warn);
+		p_Project.save();
+	}
+
+	UpdateCompilationDatabase(p_Project);
+
+	// The build works on a copy: the menus keep editing the project (sources, unity settings, profile)
+	// on the UI thread while it runs, the edits apply to the next build
+	Project project = p_Project;
+
+	// Runs on the shared pool, the compile jobs are spawned from this task and stolen by idle workers
+	m_BuildToken = core::CancellationToken();
+	m_Build = g_Core.getThreadPool()->enqueue([this, project = std::move(project), saves = std::move(saves), token = m_BuildToken]() {
+		// Cleared however the build ends, a flag left set would refuse every later build
+		struct BuildingFlag {
+			std::atomic_bool& flag;
+			~BuildingFlag() { flag.store(false); }
+		} building{ m_IsBuilding };
+
+		try {
+			RunBuild(project, saves, token);
+		}
+		catch (const std::exception& e) {
+			LOG("[BuildSystem]: Build failed: {}", core::Log::LogLevel::Error, e.what());
+			g_Core.getEventBus()->post(BuildFinished{ std::string("Build failed: ") + e.what() + "\n", nullptr });
+		}
+	});
+}
+
+void BuildSystem::RunBuild(const Project& p_Project, const std::vector<PendingSave>& saves, const core::CancellationToken& token)
+{
+	std::string output;
+	BuildTrace trace(BuildTrace::Clock::now());
+
+	LoadCommandHashes(p_Project);
+	std::vector<CompileJob> jobs = CreateCompileJobs(p_Project);
+	for (auto& job : jobs)
+		job.dependencies = ReadDependencies(fs::path(job.object).replace_extension(".d"), job.directory);
+	WaitForSaves(jobs, saves);
+	for (auto& job : jobs)
+		job.upToDate = IsUpToDate(job);
+
+	RunCompileJobs(jobs, token);
+	if (token.isCancelled()) {
+		// The hashes of the jobs that did run are not kept, they compile again next time
+		return;
+	}
+
+	bool compiled = !jobs.empty();
+	bool rebuilt = false;
+	std::vector<fs::path> objects;
+	objects.reserve(jobs.size());
+	for (const auto& job : jobs) {
+		objects.push_back(job.object);
+		if (job.upToDate)
+			continue;
+
+		trace.addJob(job);
+		output += job.output;
+		compiled = compiled && job.exitCode == 0;
+		rebuilt = true;
+		if (job.exitCode == 0)
+			m_CommandHashes[job.object] = job.hash;
+		else
+			m_CommandHashes.erase(job.object);
+	}
+
+	if (compiled) {
+#ifdef _WIN32
+		const fs::path executable = p_Project.getRootDirectory() / (p_Project.getName() + ".exe");
+#else
+		const fs::path executable = p_Project.getRootDirectory() / p_Project.getName();
+#endif
+		CompileJob linkJob;
+		linkJob.directory = p_Project.getRootDirectory();
+		linkJob.object = executable;
+		linkJob.command = m_CommandLine.getLinkCommand(objects, executable);
+		linkJob.hash = linkJob.command->hash;
+
+		auto stored = m_CommandHashes.find(executable);
+		const bool linked = stored != m_CommandHashes.end() && stored->second == linkJob.hash && fs::exists(executable);
+		if (rebuilt || !linked) {
+			linkJob.queued = BuildTrace::Clock::now();
+			RunJob(linkJob, 0);
+			trace.addJob(linkJob);
+
+			output += linkJob.output;
+			if (linkJob.exitCode == 0)
+				m_CommandHashes[executable] = linkJob.hash;
+			else {
+				m_CommandHashes.erase(executable);
+				if (output.empty())
+					output = "Linking failed\n";
+			}
+		}
+		else {
+			output = "Build is up to date\n";
+		}
+	}
+	else if (jobs.empty()) {
+		output = "No source files to build\n";
+	}
+
+	SaveCommandHashes(p_Project);
+
+	auto summary = std::make_shared<const BuildSummary>(trace.finish(GetBuildDirectory(p_Project) / "build_trace.json"));
+	if (output.empty())
+		output = "Build is successfull";
+
+	g_Core.getEventBus()->post(BuildFinished{ std::move(output), std::move(summary) });
+}
+
+void BuildSystem::RunCurrentProject(const Project& p_Project)
+{
+	if (p_Project.getName().empty())
+	{
+		LOG("No project is open", core::Log::LogLevel::Warn);
+		return;
+	}
+#ifdef _WIN32
+	std::string command = CommandLineBuilder::Quote(p_Project.getRootDirectory().string() + "\\" + p_Project.getName());
+#else
+	std::string command = CommandLineBuilder::Quote(p_Project.getRootDirectory().string() + "/" + p_Project.getName());
+#endif
+	std::string result;
+	char buffer[128];
+
+	// "r" = read the output of the command
+#ifdef __linux__
+	std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
+#elif _WIN32
+	std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(command.c_str(), "r"), _pclose);
+#endif
+	if (!pipe.get())
+		throw std::runtime_error("Failed to run command");
+
+	while (fgets(buffer, sizeof(buffer), pipe.get()) != nullptr)
+	{
+		result += buffer;
+	}
+	s_ConsoleOutput = result;
+
+	LOG("Console pipe output: {}", core::Log::LogLevel::Tracer, result);
+}
+
+fs::path BuildSystem::GetBuildDirectory(const Project& p_Project)
+{
+	return p_Project.getRootDirectory() / "build";
+}
+
+static fs::path ResolveSource(const Project& p_Project, const fs::path& source)
+{
+	return source.is_absolute() ? source : p_Project.getRootDirectory() / source;
+}
+
+// Flattens a source path into a unique object file name, e.g. "src/module/a.cpp" -> "src_module_a_cpp.o"
+static std::string ObjectName(const Project& p_Project, const fs::path& source)
+{
+	std::error_code ec;
+	fs::path relative = fs::relative(source, p_Project.getRootDirectory(), ec);
+	std::string name = (ec || relative.empty() ? source.filename() : relative).generic_string();
+	std::replace_if(name.begin(), name.end(), [](char c) { return c == '/' || c == ':' || c == '.'; }, '_');
+	return name + ".o";
+}
+
+std::vector<std::vector<fs::path>> BuildSystem::CreateUnityBatches(const Project& p_Project, std::size_t batchCount)
+{
+	struct Entry {
+		fs::path path;
+		std::uintmax_t size;
+	};
+
+	std::vector<Entry> entries;
+	std::uintmax_t totalSize = 0;
+	for (const auto& src : p_Project.getSourceFiles()) {
+		std::error_code ec;
+		fs::path path = ResolveSource(p_Project, src);
+		std::uintmax_t size = fs::file_size(path, ec);
+		if (ec)
+			size = 0;
+		totalSize += size;
+		entries.push_back({ std::move(path), size });
+	}
+
+	std::vector<std::vector<fs::path>> batches;
+	if (entries.empty() || batchCount == 0)
+		return batches;
+
+	// Keep files of the same directory next to each other so they end up in the same batch
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		if (a.path.parent_path() != b.path.parent_path())
+			return a.path.parent_path() < b.path.parent_path();
+		return a.path.filename() < b.path.filename();
+	});
+
+	batchCount = std::min(batchCount, entries.size());
+	const std::uintmax_t targetSize = std::max<std::uintmax_t>(1, totalSize / batchCount);
+
+	std::uintmax_t batchSize = 0;
+	batches.emplace_back();
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		const std::size_t remainingFiles = entries.size() - i;
+		const std::size_t missingBatches = batchCount - batches.size();
+		const bool full = batchSize >= targetSize || remainingFiles <= missingBatches;
+
+		if (!batches.back().empty() && missingBatches > 0 && full) {
+			batches.emplace_back();
+			batchSize = 0;
+		}
+		batches.back().push_back(entries[i].path);
+		batchSize += entries[i].size;
+	}
+	return batches;
+}
+
+bool BuildSystem::WriteUnitySource(const fs::path& unityFile, const std::vector<fs::path>& sources)
+{
+	std::string content = "// Generated by Quantom IDE for unity builds, do not edit.\n";
+	for (const auto& source : sources)
+		content += "#include \"" + source.generic_string() + "\"\n";
+
+	// Leave an unchanged batch untouched so its timestamp stays stable
+	auto existing = core::FileSystem::readFile(unityFile);
+	if (existing.has_value() && existing.value() == content)
+		return true;
+
+	return core::FileSystem::writeFile(unityFile, content);
+}
+
+std::vector<CompileJob> BuildSystem::CreateCompileJobs(const Project& p_Project)
+{
+	const fs::path buildDir = GetBuildDirectory(p_Project);
+	std::error_code ec;
+	fs::create_directories(buildDir / "obj", ec);
+	m_CommandLine.sync(p_Project);
+
+	std::vector<fs::path> sources;
+	if (p_Project.isUnityBuild()) {
+		const std::size_t batchCount = p_Project.getUnityBatchCount() > 0
+			? static_cast<std::size_t>(p_Project.getUnityBatchCount())
+			: g_Core.getThreadPool()->getThreadCount(); // one batch per pool worker
+
+		const auto batches = CreateUnityBatches(p_Project, batchCount);
+		fs::create_directories(buildDir / "unity", ec);
+		for (std::size_t i = 0; i < batches.size(); ++i) {
+			fs::path unityFile = buildDir / "unity" / ("unity_" + std::to_string(i) + ".cpp");
+			if (!WriteUnitySource(unityFile, batches[i])) {
+				LOG("[BuildSystem]: Failed to write unity source {}", core::Log::LogLevel::Error, unityFile);
+				continue;
+			}
+			sources.push_back(std::move(unityFile));
+		}
+	}
+	else {
+		for (const auto& src : p_Project.getSourceFiles())
+			sources.push_back(ResolveSource(p_Project, src));
+	}
+
+	std::vector<CompileJob> jobs;
+	jobs.reserve(sources.size());
+	for (auto& source : sources) {
+		CompileJob job = CreateCompileJob(p_Project, std::move(source));
+
+		// clang writes a per-TU time trace next to the object file, picked up by BuildTrace
+		if (m_CommandLine.isClang()) {
+			job.timeTraceFile = fs::path(job.object).replace_extension(".json");
+			job.extraArguments.push_back("-ftime-trace");
+			job.hash = CommandLineBuilder::Hash({ std::to_string(job.hash), "-ftime-trace" });
+		}
+		jobs.push_back(std::move(job));
+	}
+	return jobs;
+}
+
+CompileJob BuildSystem::CreateCompileJob(const Project& p_Project, fs::path source)
+{
+	CompileJob job;
+	job.directory = p_Project.getRootDirectory();
+	job.object = GetBuildDirectory(p_Project) / "obj" / ObjectName(p_Project, source);
+	job.command = m_CommandLine.getCompileCommand(source, job.object);
+	job.hash = job.command->hash;
+	job.source = std::move(source);
+	return job;
+}
+
+bool BuildSystem::UpdateCompilationDatabase(const Project& p_Project)
+{
+	if (!p_Project.isOpen())
+		return false;
+
+	// clangd needs the real sources, so unity batches are never listed here
+	m_CommandLine.sync(p_Project);
+	std::vector<CompileJob> jobs;
+	jobs.reserve(p_Project.getSourceFiles().size());
+	for (const auto& src : p_Project.getSourceFiles())
+		jobs.push_back(CreateCompileJob(p_Project, ResolveSource(p_Project, src)));
+
+	return m_CompilationDatabase.update(p_Project.getRootDirectory() / "compile_commands.json", jobs);
+}
+
+void BuildSystem::RunCompileJobs(std::vector<CompileJob>& jobs, const core::CancellationToken& token)
+{
+	core::ThreadPool& pool = *g_Core.getThreadPool();
+
+	const auto queued = BuildTrace::Clock::now();
+	std::vector<std::future<void>> running;
+	running.reserve(jobs.size());
+	for (auto& job : jobs) {
+		job.queued = queued;
+		if (!job.upToDate)
+			running.push_back(pool.enqueue(core::TaskPriority::Normal, token, [&job]() { RunJob(job, std::max(0, core::ThreadPool::getCurrentWorkerIndex())); }));
+	}
+
+	// Called from a pool task, waiting keeps this worker compiling too
+	for (auto& job : running)
+		pool.waitFor(job);
+}
+
+void BuildSystem::RunJob(CompileJob& job, int worker)
+{
+	PROFILE_ZONE("BuildSystem::RunJob");
+	if (!job.timeTraceFile.empty()) {
+		std::error_code ec;
+		fs::remove(job.timeTraceFile, ec); // never merge a stale trace from a previous build
+	}
+
+	job.worker = worker;
+	job.started = BuildTrace::Clock::now();
+	std::string command = CommandLineBuilder::Join(job.command->arguments);
+	if (!job.extraArguments.empty())
+		command += " " + CommandLineBuilder::Join(job.extraArguments);
+	job.exitCode = RunProcess("cd " + CommandLineBuilder::Quote(job.directory.string()) + " && " + command + " 2>&1", job.output); // Redirect stderr to stdout
+	job.finished = BuildTrace::Clock::now();
+}
+
+int BuildSystem::RunProcess(const std::string& command, std::string& output)
+{
+#ifdef _WIN32
+	FILE* pipe = _popen(command.c_str(), "r");
+#else
+	FILE* pipe = popen(command.c_str(), "r");
+#endif
+	if (!pipe) {
+		output += "Failed to start compiler process\n";
+		return -1;
+	}
+
+	char buffer[512];
+	while (fgets(buffer, sizeof(buffer), pipe)) {
+		output += buffer;
+	}
+#ifdef _WIN32
+	return _pclose(pipe);
+#else
+	return pclose(pipe);
+#endif
+}
+
+bool BuildSystem::IsUpToDate(const CompileJob& job) const
+{
+	auto stored = m_CommandHashes.find(job.object);
+	if (stored == m_CommandHashes.end() || stored->second != job.hash)
+		return false;
+
+	std::error_code ec;
+	const auto objectTime = fs::last_write_time(job.object, ec);
+	if (ec)
+		return false;
+
+	if (job.dependencies.empty())
+		return false;
+
+	for (const auto& dependency : job.dependencies) {
+		const auto time = fs::last_write_time(dependency, ec);
+		if (ec || time > objectTime)
+			return false;
+	}
+	return true;
+}
+
+void BuildSystem::LoadCommandHashes(const Project& p_Project)
+{
+	m_CommandHashes.clear();
+	auto content = core::FileSystem::readFile(GetBuildDirectory(p_Project) / "command_hashes");
+	if (!content.has_value())
+		return;
+
+	std::istringstream stream(content.value());
+	std::string line;
+	while (std::getline(stream, line)) {
+		const std::size_t tab = line.find('\t');
+		if (tab == std::string::npos)
+			continue;
+		try {
+			m_CommandHashes[line.substr(tab + 1)] = std::stoull(line.substr(0, tab));
+		}
+		catch (const std::exception&) {
+			// corrupt line, the object is rebuilt
+		}
+	}
+}
+
+void BuildSystem::SaveCommandHashes(const Project& p_Project) const
+{
+	std::string content;
+	for (const auto& [object, hash] : m_CommandHashes)
+		content += std::to_string(hash) + "\t" + object.string() + "\n";
+
+	if (!core::FileSystem::writeFile(GetBuildDirectory(p_Project) / "command_hashes", content))
+		LOG("[BuildSystem]: Failed to write command hashes", core::Log::LogLevel::Warn);
+}
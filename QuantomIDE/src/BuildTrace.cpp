@@ -0,0 +1,122 @@
+#include "BuildTrace.hpp"
+#include "BuildSystem.hpp"
+
+#include <FileSystem.hpp>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+BuildTrace::BuildTrace(Clock::time_point buildStart)
+	: m_BuildStart(buildStart)
+{
+}
+
+double BuildTrace::toMicroseconds(Clock::time_point time) const
+{
+	return std::chrono::duration<double, std::micro>(time - m_BuildStart).count();
+}
+
+void BuildTrace::addJob(const CompileJob& job)
+{
+	const double start = toMicroseconds(job.started);
+	const double duration = std::chrono::duration<double, std::micro>(job.finished - job.started).count();
+	const double queueWait = std::chrono::duration<double, std::micro>(job.started - job.queued).count();
+	const std::string name = job.source.empty() ? job.object.filename().string() : job.source.filename().string();
+
+	m_WorkerCount = std::max(m_WorkerCount, job.worker + 1);
+	m_Events.push_back({
+		{ "name", name },
+		{ "cat", job.source.empty() ? "link" : "compile" },
+		{ "ph", "X" },
+		{ "ts", start },
+		{ "dur", duration },
+		{ "pid", 1 },
+		{ "tid", job.worker + 1 },
+		{ "args", {
+			{ "source", job.source.string() },
+			{ "object", job.object.string() },
+			{ "queueWaitMs", queueWait / 1000.0 },
+			{ "exitCode", job.exitCode }
+		}}
+	});
+
+	if (!job.source.empty())
+		m_Units.push_back({ job.source.string(), duration / 1000.0, queueWait / 1000.0 });
+
+	if (!job.timeTraceFile.empty())
+		addTimeTrace(job);
+}
+
+void BuildTrace::addTimeTrace(const CompileJob& job)
+{
+	auto contents = core::FileSystem::readFile(job.timeTraceFile);
+	if (!contents.has_value())
+		return;
+
+	json trace = json::parse(contents.value(), nullptr, false);
+	if (trace.is_discarded() || !trace.contains("traceEvents") || !trace["traceEvents"].is_array())
+		return;
+
+	// Compiler timestamps are relative to its own process start, shift them onto the job's track
+	const double offset = toMicroseconds(job.started);
+	// Runs in the build task, so a foreign or damaged file must not throw: every field is checked
+	for (auto& event : trace["traceEvents"]) {
+		if (!event.is_object())
+			continue;
+		const auto phase = event.find("ph");
+		const auto start = event.find("ts");
+		const auto length = event.find("dur");
+		if (phase == event.end() || *phase != "X" || start == event.end() || !start->is_number()
+			|| length == event.end() || !length->is_number())
+			continue;
+
+		const double duration = length->get<double>();
+		const auto name = event.find("name");
+		const auto args = event.find("args");
+		if (name != event.end() && *name == "Source" && args != event.end() && args->is_object()) {
+			const auto detail = args->find("detail");
+			if (detail != args->end() && detail->is_string())
+				m_HeaderTimes[detail->get<std::string>()] += duration / 1000.0;
+		}
+
+		*start = start->get<double>() + offset;
+		event["pid"] = 1;
+		event["tid"] = job.worker + 1;
+		m_Events.push_back(std::move(event));
+	}
+}
+
+BuildSummary BuildTrace::finish(const fs::path& traceFile, std::size_t maxEntries)
+{
+	const Clock::time_point buildEnd = Clock::now();
+
+	BuildSummary summary;
+	summary.totalMilliseconds = std::chrono::duration<double, std::milli>(buildEnd - m_BuildStart).count();
+	summary.traceFile = traceFile;
+
+	m_Events.push_back({ { "name", "Build" }, { "cat", "build" }, { "ph", "X" }, { "ts", 0.0 },
+		{ "dur", toMicroseconds(buildEnd) }, { "pid", 1 }, { "tid", 0 } });
+	m_Events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", 0 },
+		{ "args", { { "name", "Build" } } } });
+	for (int worker = 0; worker < m_WorkerCount; ++worker) {
+		m_Events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", worker + 1 },
+			{ "args", { { "name", "Worker " + std::to_string(worker) } } } });
+	}
+
+	const json trace = { { "traceEvents", std::move(m_Events) }, { "displayTimeUnit", "ms" } };
+	if (!core::FileSystem::writeFile(traceFile, trace.dump()))
+		LOG("[BuildSystem]: Failed to write build trace {}", core::Log::LogLevel::Warn, traceFile);
+
+	auto slowestFirst = [](const BuildTimingEntry& a, const BuildTimingEntry& b) { return a.milliseconds > b.milliseconds; };
+
+	std::sort(m_Units.begin(), m_Units.end(), slowestFirst);
+	m_Units.resize(std::min(m_Units.size(), maxEntries));
+	summary.slowestUnits = std::move(m_Units);
+
+	for (auto& [header, milliseconds] : m_HeaderTimes)
+		summary.slowestHeaders.push_back({ header, milliseconds });
+	std::sort(summary.slowestHeaders.begin(), summary.slowestHeaders.end(), slowestFirst);
+	summary.slowestHeaders.resize(std::min(summary.slowestHeaders.size(), maxEntries));
+
+	return summary;
+}
@@ -0,0 +1,159 @@
+#include "CommandLineBuilder.hpp"
+
+namespace fs = std::filesystem;
+
+CommandLineBuilder::CommandLineBuilder(std::string defaultCompiler, std::vector<std::string> defaultFlags)
+	: m_DefaultCompiler(std::move(defaultCompiler)), m_DefaultFlags(std::move(defaultFlags))
+{
+}
+
+std::vector<std::string> CommandLineBuilder::GetProfileFlags(BuildProfile profile)
+{
+	switch (profile) {
+	case BuildProfile::Debug:   return { "-O0", "-g" };
+	case BuildProfile::Release: return { "-O2", "-DNDEBUG" };
+	case BuildProfile::ASan:    return { "-O1", "-g", "-fsanitize=address", "-fno-omit-frame-pointer" };
+	}
+	return {};
+}
+
+void CommandLineBuilder::sync(const Project& p_Project)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Revision == p_Project.getRevision() && !m_CompileArguments.empty())
+		return;
+
+	m_Revision = p_Project.getRevision();
+	m_Commands.clear();
+
+	m_LinkArguments.clear();
+	m_LinkArguments.push_back(p_Project.getCompiler().empty() ? m_DefaultCompiler : p_Project.getCompiler());
+
+	const auto profileFlags = GetProfileFlags(p_Project.getBuildProfile());
+	m_LinkArguments.insert(m_LinkArguments.end(), profileFlags.begin(), profileFlags.end());
+
+	const auto& projectFlags = p_Project.getCompilerFlags().empty() ? m_DefaultFlags : p_Project.getCompilerFlags();
+	m_LinkArguments.insert(m_LinkArguments.end(), projectFlags.begin(), projectFlags.end());
+
+	m_CompileArguments = m_LinkArguments;
+	for (const auto& includeDir : p_Project.getIncludeDirs()) {
+		const fs::path dir = includeDir.is_absolute() ? includeDir : p_Project.getRootDirectory() / includeDir;
+		m_CompileArguments.push_back("-I" + dir.string());
+	}
+}
+
+std::shared_ptr<const CompileCommand> CommandLineBuilder::getCompileCommand(const fs::path& source, const fs::path& object)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto& cached = m_Commands[source];
+	if (cached && cached->arguments.back() == object.string())
+		return cached;
+
+	auto command = std::make_shared<CompileCommand>();
+	command->arguments.reserve(m_CompileArguments.size() + 5);
+	command->arguments = m_CompileArguments;
+	command->arguments.insert(command->arguments.end(), { "-MMD", "-c", source.string(), "-o", object.string() });
+	command->hash = Hash(command->arguments);
+
+	cached = std::move(command);
+	return cached;
+}
+
+std::shared_ptr<const CompileCommand> CommandLineBuilder::getLinkCommand(const std::vector<fs::path>& objects, const fs::path& output) const
+{
+	auto command = std::make_shared<CompileCommand>();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		command->arguments = m_LinkArguments;
+	}
+	for (const auto& object : objects)
+		command->arguments.push_back(object.string());
+	command->arguments.push_back("-o");
+	command->arguments.push_back(output.string());
+	command->hash = Hash(command->arguments);
+	return command;
+}
+
+bool CommandLineBuilder::isClang() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return !m_LinkArguments.empty() && fs::path(m_LinkArguments.front()).filename().string().find("clang") != std::string::npos;
+}
+
+std::string CommandLineBuilder::Quote(const std::string& argument)
+{
+#ifdef _WIN32
+	constexpr std::string_view safe = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-+=/.,:@\\";
+#else
+	constexpr std::string_view safe = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-+=/.,:@%";
+#endif
+	if (!argument.empty() && argument.find_first_not_of(safe) == std::string::npos)
+		return argument;
+
+#ifdef _WIN32
+	// MSVC runtime argv rules: backslashes are literal unless a quote follows, so the ones in front of
+	// a quote and of the closing quote are doubled and the quote itself is escaped
+	std::string quoted = "\"";
+	std::size_t backslashes = 0;
+	for (char c : argument) {
+		if (c == '\\') {
+			++backslashes;
+			continue;
+		}
+		quoted.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+		backslashes = 0;
+		quoted += c;
+	}
+	quoted.append(backslashes * 2, '\\');
+	quoted += '"';
+
+	// cmd.exe reads the line first. An escaped quote would flip its quoting state, so every character
+	// it treats specially is escaped with ^ instead of relying on the quotes.
+	constexpr std::string_view special = "()%!^\"<>&|";
+	std::string escaped;
+	escaped.reserve(quoted.size() + 8);
+	for (char c : quoted) {
+		if (special.find(c) != std::string_view::npos)
+			escaped += '^';
+		escaped += c;
+	}
+	return escaped;
+#else
+	// sh expands nothing inside single quotes, a quote is closed, escaped and reopened
+	std::string quoted = "'";
+	for (char c : argument) {
+		if (c == '\'')
+			quoted += "'\\''";
+		else
+			quoted += c;
+	}
+	quoted += '\'';
+	return quoted;
+#endif
+}
+
+std::string CommandLineBuilder::Join(const std::vector<std::string>& arguments)
+{
+	std::string commandLine;
+	for (const auto& argument : arguments) {
+		if (!commandLine.empty())
+			commandLine += ' ';
+		commandLine += Quote(argument);
+	}
+	return commandLine;
+}
+
+std::uint64_t CommandLineBuilder::Hash(const std::vector<std::string>& arguments)
+{
+	// FNV-1a, stable across runs so hashes can be stored in the build directory
+	std::uint64_t hash = 14695981039346656037ull;
+	for (const auto& argument : arguments) {
+		for (unsigned char c : argument) {
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		hash ^= 0xff; // argument separator, {"a b"} and {"a", "b"} must differ
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
@@ -0,0 +1,44 @@
+#include "CompilationDatabase.hpp"
+#include "BuildSystem.hpp"
+
+#include <FileSystem.hpp>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+bool CompilationDatabase::update(const fs::path& file, const std::vector<CompileJob>& jobs)
+{
+	json entries = json::array();
+	for (const auto& job : jobs) {
+		entries.push_back({
+			{ "directory", job.directory.string() },
+			{ "file", job.source.string() },
+			{ "output", job.object.string() },
+			{ "arguments", job.command->arguments }
+		});
+	}
+
+	const std::string content = entries.dump(4);
+	const std::size_t contentHash = std::hash<std::string>{}(content);
+	if (file == m_File && contentHash == m_ContentHash)
+		return false;
+
+	m_File = file;
+	m_ContentHash = contentHash;
+
+	// A database left by a previous session may already be up to date
+	auto existing = core::FileSystem::readFile(file);
+	if (existing.has_value() && existing.value() == content)
+		return false;
+
+	// Replaced atomically, clangd never sees a half-written file
+	if (!core::FileSystem::writeFileAtomic(file, content)) {
+		LOG("[BuildSystem]: Failed to write {}", core::Log::LogLevel::Warn, file);
+		m_ContentHash = 0;
+		return false;
+	}
+
+	LOG("[BuildSystem]: Updated {}", core::Log::LogLevel::Tracer, file);
+	return true;
+}
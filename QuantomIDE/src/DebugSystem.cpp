@@ -26,7 +26,7 @@ int DebugSystem::loadExecutable(std::filesystem::path filePath)
 		return 1;
 	}
 	m_executablePath = filePath;
-	LOG(std::string("[DebugSystem]: Built GDB command: " + m_DebugTask).c_str(), core::Log::LogLevel::Tracer);
+	LOG("[DebugSystem]: Built GDB command: {}", core::Log::LogLevel::Tracer, m_DebugTask);
 	return 0;
 }
 void DebugSystem::run()
@@ -50,18 +50,18 @@ void DebugSystem::run()
 
 	std::string gdbCommand = cmd.str();
 
-	LOG(std::string("[DebugSystem]: Running GDB command: " + gdbCommand).c_str(), core::Log::LogLevel::Tracer);
+	LOG("[DebugSystem]: Running GDB command: {}", core::Log::LogLevel::Tracer, gdbCommand);
 
 	int result = std::system(gdbCommand.c_str());
 	if (result != 0)
 	{
-		LOG(std::string("[DebugSystem]: GDB exited with code " + std::to_string(result)).c_str(), core::Log::LogLevel::Warn);
+		LOG("[DebugSystem]: GDB exited with code {}", core::Log::LogLevel::Warn, result);
 	}
 	else
 	{
 		m_running = true;
 		m_paused = false;
-		LOG(std::string("[DebugSystem]: Debug session started.").c_str(), core::Log::LogLevel::Tracer);
+		LOG("[DebugSystem]: Debug session started.", core::Log::LogLevel::Tracer);
 	}
 }
 
@@ -100,11 +100,11 @@ void DebugSystem::removeBreakpoint(const std::string& file, int line)
 	if (it != m_breakpoints.end())
 	{
 		m_breakpoints.erase(it);
-		LOG(std::string("[DebugSystem]: Removed breakpoint at " + file + ":" + std::to_string(line)).c_str(), core::Log::LogLevel::Tracer);
+		LOG("[DebugSystem]: Removed breakpoint at {}:{}", core::Log::LogLevel::Tracer, file, line);
 	}
 	else
 	{
-		LOG(std::string("[DebugSystem]: No breakpoint found at " + file + ":" + std::to_string(line)).c_str(), core::Log::LogLevel::Warn);
+		LOG("[DebugSystem]: No breakpoint found at {}:{}", core::Log::LogLevel::Warn, file, line);
 	}
 }
 
@@ -1,321 +1,782 @@
-// EditorManager.cpp
-#include "EditorManager.hpp"
-#include "Core.hpp"
-#include "LSP.hpp"
-
-extern core::Core g_Core;
-extern LSPClient g_LSPClient;
-
-static std::string GenerateRandomID()
-{
-	static std::mt19937 rng(std::random_device{}());
-	static std::uniform_int_distribution<int> dist(0, 15);
-
-	std::stringstream ss;
-	ss << std::hex;
-	for (int i = 0; i < 8; ++i)
-	{
-		ss << dist(rng);
-	}
-	return ss.str(); // e.g., "a3f9b12e"
-}
-
-// -------- Document --------
-
-void Document::setText(const std::string &text)
-{
-	m_TextBuffer = text;
-	m_UndoStack.clear();
-	m_RedoStack.clear();
-	m_Dirty = true;
-}
-
-std::string &Document::getText()
-{
-	return m_TextBuffer;
-}
-
-void Document::undo()
-{
-	if (!m_UndoStack.empty())
-	{
-		m_RedoStack.push_back(m_TextBuffer);
-		m_TextBuffer = m_UndoStack.back();
-		m_UndoStack.pop_back();
-	}
-}
-
-void Document::redo()
-{
-	if (!m_RedoStack.empty())
-	{
-		m_UndoStack.push_back(m_TextBuffer);
-		m_TextBuffer = m_RedoStack.back();
-		m_RedoStack.pop_back();
-	}
-}
-
-void Document::setCursorPos(size_t pos) {
-	m_CursorPos = std::min(pos, m_TextBuffer.size());
-}
-
-std::pair<size_t, size_t> Document::getCursorPos() const {
-	int line = 0, col = 0;
-	for (size_t i = 0; i < m_CursorPos && i < m_TextBuffer.size(); i++) {
-		if (m_TextBuffer[i] == '\n') {
-			line++;
-			col = 0;
-		} else {
-			col++;
-		}
-	}
-	return {line, col};
-}
-
-// -------- SyntaxHighlighter --------
-SyntaxHighlighter::SyntaxHighlighter() = default;
-SyntaxHighlighter::~SyntaxHighlighter() = default;
-
-void SyntaxHighlighter::highlight(const Document & /*doc*/)
-{
-	// TODO: Implement syntax highlighting logic
-}
-
-// -------- EditorTab --------
-EditorTab::EditorTab(std::string name)
-	: m_TabName(name), m_Document(std::make_unique<Document>()), m_Path("")
-{
-}
-
-EditorTab::EditorTab(std::unique_ptr<Document> doc)
-	: m_Document(std::move(doc)), m_Path("")
-{
-}
-
-EditorTab::~EditorTab() = default;
-
-Document &EditorTab::getDocument()
-{
-	return *m_Document;
-}
-
-SyntaxHighlighter &EditorTab::getSyntaxHighlighter()
-{
-	return m_SyntaxHighlighter;
-}
-
-// -------- TabBar --------
-TabBar::TabBar() = default;
-TabBar::~TabBar() = default;
-
-void TabBar::addTab(std::unique_ptr<EditorTab> tab)
-{
-	std::string id;
-
-	do
-	{
-		id = GenerateRandomID();
-	} while (std::any_of(m_Tabs.begin(), m_Tabs.end(),
-						 [&](const std::unique_ptr<EditorTab> &existingTab)
-						 {
-							 return existingTab->getID() == id;
-						 }));
-
-	tab->setID(id);
-	m_Tabs.push_back(std::move(tab));
-}
-
-void TabBar::closeTab(int index)
-{
-	if (index >= 0 && index < static_cast<int>(m_Tabs.size()))
-	{
-		m_Tabs.erase(m_Tabs.begin() + index);
-		m_Tabs.shrink_to_fit();
-	}
-}
-
-EditorTab *TabBar::getTab(int index)
-{
-	if (index >= 0 && index < static_cast<int>(m_Tabs.size()))
-		return m_Tabs[index].get();
-	return nullptr;
-}
-
-int TabBar::getTabCount() const
-{
-	return static_cast<int>(m_Tabs.size());
-}
-
-int TabBar::getCurrentTabIndex() const
-{
-	return m_CurrentTabIndex;
-}
-
-EditorTab *TabBar::getCurrentTab()
-{
-	if (m_CurrentTabIndex >= 0 && m_CurrentTabIndex < static_cast<int>(m_Tabs.size()))
-		return m_Tabs[m_CurrentTabIndex].get();
-	return nullptr;
-}
-
-void TabBar::setCurrentTabIndex(int index)
-{
-	if (index >= 0 && index < static_cast<int>(m_Tabs.size()))
-		m_CurrentTabIndex = index;
-	else
-		m_CurrentTabIndex = -1;
-}
-
-// -------- EditorManager --------
-EditorManager::EditorManager() = default;
-EditorManager::~EditorManager() = default;
-
-void EditorManager::openFile(const std::string &filepath)
-{
-	std::ifstream file(filepath);
-	if (!file)
-	{
-		std::cerr << "Failed to open file: " << filepath << std::endl;
-		return;
-	}
-
-	std::stringstream buffer;
-	buffer << file.rdbuf();
-
-	auto doc = std::make_unique<Document>();
-	doc->setText(buffer.str());
-
-	auto tab = std::make_unique<EditorTab>(std::move(doc));
-	tab.get()->setTabName(std::filesystem::path(filepath).filename().string());
-	tab.get()->setFilePath(std::filesystem::path(filepath));
-	m_TabBar.addTab(std::move(tab));
-
-	m_TabBar.setCurrentTabIndex(m_TabBar.getTabCount() - 1);
-
-	std::string uri = "file://" + std::filesystem::absolute(filepath).string();
-	// check if file is .cpp or .h for languageId
-	std::string languageId = "plaintext";
-	if (filepath.ends_with(".cpp") || filepath.ends_with(".cxx") || filepath.ends_with(".h") || filepath.ends_with(".c") || filepath.ends_with(".hpp"))
-	{
-		languageId = "cpp";
-	}
-	std::string text = buffer.str();
-	g_LSPClient.textDocumentDidOpen(filepath, languageId, text);
-}
-
-void EditorManager::closeFile(int tabIndex)
-{
-	m_TabBar.closeTab(tabIndex);
-}
-
-TabBar &EditorManager::getTabBar()
-{
-	return m_TabBar;
-}
-void TabBar::saveAll()
-{
-	for (auto &tab : m_Tabs)
-	{
-		if (!tab)
-		{
-			LOG("Tab does not exist", core::Log::LogLevel::Warn);
-		}
-		else
-		{
-			auto path = tab->save();
-			if (!path.has_value())
-			{
-				LOG("Warning: File failed to save.", core::Log::LogLevel::Warn);
-				continue;
-			}
-			tab->setFilePath(path.value());
-			tab->setTabName(std::filesystem::path(path.value()).filename().string());
-			tab->getDocument().markClean();
-		}
-	}
-}
-std::optional<std::filesystem::path> EditorTab::save()
-{
-	auto buffer = m_Document.get()->getText();
-	const auto path = g_Core.getFileSystem()->saveFile(buffer, m_Path);
-	if (!path.has_value()) {
-		LOG("Warning: File save operation failed or was cancelled by user.", core::Log::LogLevel::Warn);
-		return std::nullopt;
-	}
-	setTabName(path.value().filename().string());
-	setFilePath(path.value());
-	m_Document.get()->markClean();
-
-	std::string uri = "file://" + std::filesystem::absolute(path.value()).string();
-	g_LSPClient.textDocumentDidChange(path.value(), buffer);
-	m_focusEditorNextFrame = true;
-	return std::optional<std::filesystem::path>(m_Path);
-}
-void TabBar::closeAll()
-{
-	m_Tabs.clear();
-	m_Tabs.shrink_to_fit();
-}
-
-void Document::insertText(size_t position, const std::string& text) {
-    if (position > m_TextBuffer.size()) {
-        position = m_TextBuffer.size();
-    }
-    
-    m_TextBuffer.insert(position, text);
-    m_Dirty = true;
-    
-    m_UndoStack.push_back(m_TextBuffer.substr(0, position) + 
-                         m_TextBuffer.substr(position + text.size()));
-    m_RedoStack.clear();
-}
-
-void Document::insertTextAtCursor(const std::string& text) {
-    insertText(m_CursorPos, text);
-    m_CursorPos += text.size();
-}
-
-void EditorTab::insertText(const std::string& text) {
-	m_Document->insertTextAtCursor(text);
-}
-
-void TabBar::insertText(const std::string& text) {
-	if (EditorTab* tab = getCurrentTab()) {
-		tab->insertText(text);
-	}
-}
-
-void EditorManager::insertText(const std::string& text) {
-    m_TabBar.insertText(text);
-    
-    if (EditorTab* tab = m_TabBar.getCurrentTab()) {
-        if (!tab->getFilePath().empty()) {
-            g_LSPClient.textDocumentDidChange(tab->getFilePath(), tab->getDocument().getText());
-        }
-    }
-    
-    LOG("Inserted text: %s", core::Log::Tracer, text.c_str());
-}
-
-void EditorManager::updateAutosave(float deltaTimeSeconds) {
-	if (!m_autoSaveEnabled) return;
-
-	m_autoSaveTimer += deltaTimeSeconds;
-	if (m_autoSaveTimer < m_autoSaveInterval) return;
-
-	m_autoSaveTimer = 0.0f;
-
-	EditorTab* tab = m_TabBar.getCurrentTab();
-	if (!tab) return;
-
-	Document& doc = tab->getDocument();
-	if (!doc.isDirty()) return;
-
-	auto savedPath = tab->save();
-	if (savedPath.has_value()) {
-		LOG("Autosaved: %s", core::Log::Tracer, savedPath->string().c_str());
-	}
-	else {
-		LOG("Autosave failed for current tab", core::Log::LogLevel::Warn);
-	}
-}
\ No newline at end of file
+// EditorManager.cpp
+#include "EditorManager.hpp"
+#include "AppEvents.hpp"
+#include "Core.hpp"
+
+extern core::Core g_Core;
+
+// The first piece of a file is read on its own so its first screen can be shown early
+static constexpr size_t kPreviewBytes = 1024 * 1024;
+// The rest is read in pieces, which moves the progress bar and lets a closed tab stop the read
+static constexpr size_t kLoadChunkBytes = 4 * 1024 * 1024;
+
+// First line of a recovery file, followed by the document's path, its tab name and the text
+static constexpr std::string_view kRecoveryHeader = "QuantomIDE recovery 1\n";
+
+// Holds one directory per session, see EditorManager::updateAutosave
+static std::filesystem::path RecoveryDirectory()
+{
+	return core::Platform::dataDirectory() / "recovery";
+}
+
+static constexpr std::string_view kSessionLockName = "session.lock";
+
+static std::string_view LanguageIdFor(const std::filesystem::path &path)
+{
+	// check if file is .cpp or .h for languageId
+	const std::string filepath = path.string();
+	if (filepath.ends_with(".cpp") || filepath.ends_with(".cxx") || filepath.ends_with(".h") || filepath.ends_with(".c") || filepath.ends_with(".hpp"))
+	{
+		return "cpp";
+	}
+	return "plaintext";
+}
+
+static std::string GenerateRandomID()
+{
+	static std::mt19937 rng(std::random_device{}());
+	static std::uniform_int_distribution<int> dist(0, 15);
+
+	std::stringstream ss;
+	ss << std::hex;
+	for (int i = 0; i < 8; ++i)
+	{
+		ss << dist(rng);
+	}
+	return ss.str(); // e.g., "a3f9b12e"
+}
+
+// -------- Document --------
+
+void Document::setText(const std::string &text)
+{
+	setText(std::string(text));
+}
+
+void Document::setText(std::string &&text)
+{
+	m_TextBuffer = std::move(text);
+	++m_Revision;
+	m_LineStarts.clear();
+	m_UndoStack.clear();
+	m_RedoStack.clear();
+	m_Dirty = true;
+}
+
+void Document::setLoadedText(std::string &&text, std::vector<size_t> lineStarts, core::TextEncoding encoding)
+{
+	setText(std::move(text));
+	m_LineStarts = std::move(lineStarts);
+	m_Encoding = encoding;
+	m_CursorPos = 0;
+	m_Dirty = false;
+}
+
+core::TextEncoding Document::getSaveEncoding()
+{
+	if (!core::CanEncode(m_TextBuffer, m_Encoding))
+	{
+		LOG("The text has characters {} cannot store, it is saved as UTF-8", core::Log::LogLevel::Warn, core::ToString(m_Encoding));
+		m_Encoding = core::TextEncoding::Utf8;
+	}
+	return m_Encoding;
+}
+
+std::string &Document::getText()
+{
+	return m_TextBuffer;
+}
+
+void Document::undo()
+{
+	if (!m_UndoStack.empty())
+	{
+		m_RedoStack.push_back(m_TextBuffer);
+		m_TextBuffer = m_UndoStack.back();
+		m_UndoStack.pop_back();
+		++m_Revision;
+		m_LineStarts.clear();
+	}
+}
+
+void Document::redo()
+{
+	if (!m_RedoStack.empty())
+	{
+		m_UndoStack.push_back(m_TextBuffer);
+		m_TextBuffer = m_RedoStack.back();
+		m_RedoStack.pop_back();
+		++m_Revision;
+		m_LineStarts.clear();
+	}
+}
+
+void Document::setCursorPos(size_t pos) {
+	m_CursorPos = std::min(pos, m_TextBuffer.size());
+}
+
+void Document::setCursorPos(size_t line, size_t column) {
+	size_t lineStart = 0;
+	if (!m_LineStarts.empty()) {
+		lineStart = line < m_LineStarts.size() ? m_LineStarts[line] : m_TextBuffer.size();
+	}
+	else {
+		for (size_t i = 0; i < line && lineStart < m_TextBuffer.size(); ++i) {
+			const size_t lineBreak = m_TextBuffer.find('\n', lineStart);
+			lineStart = lineBreak == std::string::npos ? m_TextBuffer.size() : lineBreak + 1;
+		}
+	}
+	const size_t lineEnd = std::min(m_TextBuffer.find('\n', lineStart), m_TextBuffer.size());
+	setCursorPos(std::min(lineStart + column, lineEnd));
+}
+
+std::pair<size_t, size_t> Document::getCursorPos() const {
+	if (!m_LineStarts.empty()) {
+		const auto next = std::upper_bound(m_LineStarts.begin(), m_LineStarts.end(), m_CursorPos);
+		const size_t line = static_cast<size_t>(next - m_LineStarts.begin()) - 1;
+		return {line, m_CursorPos - m_LineStarts[line]};
+	}
+
+	int line = 0, col = 0;
+	for (size_t i = 0; i < m_CursorPos && i < m_TextBuffer.size(); i++) {
+		if (m_TextBuffer[i] == '\n') {
+			line++;
+			col = 0;
+		} else {
+			col++;
+		}
+	}
+	return {line, col};
+}
+
+// -------- SyntaxHighlighter --------
+SyntaxHighlighter::SyntaxHighlighter() = default;
+SyntaxHighlighter::~SyntaxHighlighter() = default;
+
+void SyntaxHighlighter::highlight(const Document & /*doc*/)
+{
+	// TODO: Implement syntax highlighting logic
+}
+
+// -------- EditorTab --------
+EditorTab::EditorTab(std::string name)
+	: m_TabName(name), m_Document(std::make_unique<Document>()), m_Path("")
+{
+}
+
+EditorTab::EditorTab(std::unique_ptr<Document> doc)
+	: m_Document(std::move(doc)), m_Path("")
+{
+}
+
+EditorTab::~EditorTab()
+{
+	if (m_Load)
+		m_Load->token.cancel();
+}
+
+Document &EditorTab::getDocument()
+{
+	return *m_Document;
+}
+
+SyntaxHighlighter &EditorTab::getSyntaxHighlighter()
+{
+	return m_SyntaxHighlighter;
+}
+
+// -------- TabBar --------
+TabBar::TabBar() = default;
+TabBar::~TabBar() = default;
+
+void TabBar::addTab(std::unique_ptr<EditorTab> tab)
+{
+	std::string id;
+
+	do
+	{
+		id = GenerateRandomID();
+	} while (std::any_of(m_Tabs.begin(), m_Tabs.end(),
+						 [&](const std::unique_ptr<EditorTab> &existingTab)
+						 {
+							 return existingTab->getID() == id;
+						 }));
+
+	tab->setID(id);
+	m_Tabs.push_back(std::move(tab));
+}
+
+void TabBar::closeTab(int index)
+{
+	if (index >= 0 && index < static_cast<int>(m_Tabs.size()))
+	{
+		m_Tabs.erase(m_Tabs.begin() + index);
+		m_Tabs.shrink_to_fit();
+	}
+}
+
+EditorTab *TabBar::getTab(int index)
+{
+	if (index >= 0 && index < static_cast<int>(m_Tabs.size()))
+		return m_Tabs[index].get();
+	return nullptr;
+}
+
+EditorTab *TabBar::findTab(const std::string &id)
+{
+	for (auto &tab : m_Tabs)
+	{
+		if (tab->getID() == id)
+			return tab.get();
+	}
+	return nullptr;
+}
+
+int TabBar::getTabCount() const
+{
+	return static_cast<int>(m_Tabs.size());
+}
+
+int TabBar::getCurrentTabIndex() const
+{
+	return m_CurrentTabIndex;
+}
+
+EditorTab *TabBar::getCurrentTab()
+{
+	if (m_CurrentTabIndex >= 0 && m_CurrentTabIndex < static_cast<int>(m_Tabs.size()))
+		return m_Tabs[m_CurrentTabIndex].get();
+	return nullptr;
+}
+
+void TabBar::setCurrentTabIndex(int index)
+{
+	if (index >= 0 && index < static_cast<int>(m_Tabs.size()))
+		m_CurrentTabIndex = index;
+	else
+		m_CurrentTabIndex = -1;
+}
+
+// -------- FileLoad --------
+float FileLoad::getProgress() const
+{
+	const size_t total = size.load(std::memory_order_relaxed);
+	if (total == 0)
+		return 0.0f;
+	return static_cast<float>(bytesRead.load(std::memory_order_relaxed)) / static_cast<float>(total);
+}
+
+// Runs on the thread pool. Reads through a mapping straight into the future document buffer, then
+// decodes and indexes the text so the UI thread only has to take it over.
+static void LoadFile(const std::string &tabId, const std::filesystem::path &path, FileLoad &load)
+{
+	PROFILE_ZONE("EditorManager::LoadFile");
+	core::EventBus *events = g_Core.getEventBus();
+	DocumentLoaded loaded{ tabId, path, nullptr };
+
+	std::string text;
+	if (auto mapped = core::FileSystem::mapFile(path))
+	{
+		text.resize(mapped->size());
+		load.size.store(text.size(), std::memory_order_relaxed);
+
+		for (size_t offset = 0; offset < text.size();)
+		{
+			if (load.token.isCancelled())
+				return;
+
+			const size_t count = std::min(offset == 0 ? kPreviewBytes : kLoadChunkBytes, text.size() - offset);
+			if (!mapped->copy(offset, count, text.data() + offset))
+			{
+				LOG("File was truncated while it was read: {}", core::Log::LogLevel::Error, path.string());
+				events->post(std::move(loaded));
+				return;
+			}
+			offset += count;
+			load.bytesRead.store(offset, std::memory_order_relaxed);
+
+			if (offset == count && offset < text.size())
+			{
+				// Up to the last complete line, so the preview does not end in a split character
+				const size_t lineEnd = text.rfind('\n', offset - 1);
+				std::string preview(text, 0, lineEnd == std::string::npos ? offset : lineEnd + 1);
+				core::DecodeText(preview);
+				events->post(DocumentPreview{ tabId, std::move(preview) });
+			}
+		}
+	}
+	else if (auto contents = core::FileSystem::readFile(path))
+	{
+		// Not mappable, e.g. a pipe
+		text = std::move(*contents);
+	}
+	else
+	{
+		events->post(std::move(loaded));
+		return;
+	}
+
+	auto contents = std::make_unique<DocumentLoaded::Contents>();
+	contents->encoding = core::DecodeText(text);
+
+#ifdef _WIN32
+	// The text-mode stream this replaced turned CRLF into LF, saving turns it back
+	size_t kept = 0;
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		if (text[i] != '\r' || i + 1 == text.size() || text[i + 1] != '\n')
+			text[kept++] = text[i];
+	}
+	text.resize(kept);
+#endif
+
+	contents->lineStarts = core::IndexLines(text);
+	contents->text = std::move(text);
+	loaded.contents = std::move(contents);
+
+	if (!load.token.isCancelled())
+		events->post(std::move(loaded));
+}
+
+// -------- EditorManager --------
+EditorManager::EditorManager()
+{
+	core::EventBus *events = g_Core.getEventBus();
+	m_PreviewSubscription = events->subscribe<DocumentPreview>([this](const DocumentPreview &event) {
+		onPreview(event);
+	});
+	m_LoadedSubscription = events->subscribe<DocumentLoaded>([this](const DocumentLoaded &event) {
+		onLoaded(event);
+	});
+	m_SavedSubscription = events->subscribe<DocumentsSaved>([this](const DocumentsSaved &event) {
+		onSaved(event);
+	});
+
+	// Locked before recoverDocuments looks at the other sessions, so two instances starting together
+	// never take each other's session for an orphaned one
+	std::error_code ec;
+	const std::filesystem::path session = RecoveryDirectory() / std::to_string(core::Platform::processId());
+	std::filesystem::create_directories(session, ec);
+	if (auto lock = core::Platform::lockFile(session / kSessionLockName))
+	{
+		m_RecoverySession = session;
+		m_RecoveryLock = *lock;
+	}
+	else
+	{
+		LOG("Failed to lock recovery session {}, unsaved changes are not autosaved", core::Log::LogLevel::Warn, session.string());
+	}
+}
+
+EditorManager::~EditorManager()
+{
+	g_Core.getEventBus()->unsubscribe(m_PreviewSubscription);
+	g_Core.getEventBus()->unsubscribe(m_LoadedSubscription);
+	g_Core.getEventBus()->unsubscribe(m_SavedSubscription);
+
+	// Nothing to recover after a clean exit
+	if (m_AutosaveTask.valid())
+		m_AutosaveTask.wait();
+	if (m_RecoverySession.empty())
+		return;
+	core::Platform::unlockFile(m_RecoveryLock);
+	std::error_code ec;
+	std::filesystem::remove_all(m_RecoverySession, ec);
+}
+
+void EditorManager::openFile(const std::string &filepath)
+{
+	auto load = std::make_shared<FileLoad>();
+
+	auto tab = std::make_unique<EditorTab>(std::make_unique<Document>());
+	tab.get()->setTabName(std::filesystem::path(filepath).filename().string());
+	tab.get()->setFilePath(std::filesystem::path(filepath));
+	tab.get()->setLoad(load);
+	m_TabBar.addTab(std::move(tab));
+
+	m_TabBar.setCurrentTabIndex(m_TabBar.getTabCount() - 1);
+
+	// The task holds its own reference, the tab may close before it runs
+	g_Core.getThreadPool()->enqueue(core::TaskPriority::Interactive, load->token,
+		[tabId = m_TabBar.getCurrentTab()->getID(), path = std::filesystem::path(filepath), load]()
+		{
+			try
+			{
+				LoadFile(tabId, path, *load);
+			}
+			catch (const std::exception &e)
+			{
+				LOG("Failed to read {}: {}", core::Log::LogLevel::Error, path.string(), e.what());
+				g_Core.getEventBus()->post(DocumentLoaded{ tabId, path, nullptr });
+			}
+		});
+}
+
+void EditorManager::showLocation(const std::filesystem::path &path, size_t line, size_t column)
+{
+	int index = -1;
+	for (int i = 0; i < m_TabBar.getTabCount() && index < 0; ++i)
+	{
+		std::error_code ec;
+		const std::filesystem::path tabPath = m_TabBar.getTab(i)->getFilePath();
+		if (!tabPath.empty() && std::filesystem::equivalent(tabPath, path, ec))
+			index = i;
+	}
+	if (index < 0)
+	{
+		openFile(path.string());
+		index = m_TabBar.getTabCount() - 1;
+	}
+	m_TabBar.setCurrentTabIndex(index);
+
+	EditorTab *tab = m_TabBar.getTab(index);
+	tab->setFocusEditorNextFrame(true); // also brings the tab to the front
+	if (tab->isLoading())
+		tab->getLoad()->cursor = std::make_pair(line, column);
+	else
+		tab->getDocument().setCursorPos(line, column);
+}
+
+void EditorManager::onPreview(const DocumentPreview &event)
+{
+	EditorTab *tab = m_TabBar.findTab(event.tabId);
+	if (tab && tab->isLoading())
+		tab->getLoad()->preview = event.text;
+}
+
+void EditorManager::onLoaded(const DocumentLoaded &event)
+{
+	EditorTab *tab = m_TabBar.findTab(event.tabId);
+	if (!tab || !tab->isLoading())
+		return; // closed while loading
+	const auto cursor = tab->getLoad()->cursor;
+	tab->finishLoad();
+
+	if (!event.contents)
+	{
+		LOG("Failed to open file: {}", core::Log::LogLevel::Error, event.path.string());
+		for (int i = 0; i < m_TabBar.getTabCount(); ++i)
+		{
+			if (m_TabBar.getTab(i) == tab)
+			{
+				m_TabBar.closeTab(i);
+				break;
+			}
+		}
+		return;
+	}
+
+	Document &doc = tab->getDocument();
+	doc.setLoadedText(std::move(event.contents->text), std::move(event.contents->lineStarts), event.contents->encoding);
+	if (cursor)
+		doc.setCursorPos(cursor->first, cursor->second);
+	if (doc.getEncoding() != core::TextEncoding::Utf8)
+		LOG("{} was converted from {} to UTF-8, saving converts it back", core::Log::LogLevel::Tracer, event.path.string(), core::ToString(doc.getEncoding()));
+
+	g_Core.getEventBus()->publish(core::DocumentOpened{ event.path, LanguageIdFor(event.path), doc.getText() });
+}
+
+void EditorManager::onSaved(const DocumentsSaved &event)
+{
+	for (const auto &document : event.documents)
+	{
+		if (!document.saved)
+		{
+			LOG("Failed to save {}", core::Log::LogLevel::Warn, document.path.string());
+			continue;
+		}
+		// Still the saved text, or the user kept typing while it was written
+		EditorTab *tab = m_TabBar.findTab(document.tabId);
+		if (tab && tab->getDocument().getRevision() == document.revision)
+			tab->getDocument().markClean();
+	}
+}
+
+void EditorManager::closeFile(int tabIndex)
+{
+	m_TabBar.closeTab(tabIndex);
+}
+
+TabBar &EditorManager::getTabBar()
+{
+	return m_TabBar;
+}
+std::vector<PendingSave> TabBar::saveAll()
+{
+	// Filled in by the writes, each in its own slot, the last one to finish posts them
+	struct SaveBatch {
+		std::atomic<size_t> remaining{ 0 };
+		std::vector<DocumentsSaved::SavedDocument> documents;
+	};
+	auto batch = std::make_shared<SaveBatch>();
+
+	for (auto &tab : m_Tabs)
+	{
+		if (!tab)
+		{
+			LOG("Tab does not exist", core::Log::LogLevel::Warn);
+			continue;
+		}
+		// Untitled tabs would need a file dialog each, they are saved one by one from the menu
+		if (tab->isLoading() || !tab->getDocument().isDirty() || tab->getFilePath().empty())
+			continue;
+
+		Document &doc = tab->getDocument();
+		batch->documents.push_back({ tab->getID(), tab->getFilePath(), doc.getRevision(), std::make_shared<const std::string>(doc.getText()), doc.getSaveEncoding(), false });
+	}
+	if (batch->documents.empty())
+		return {};
+
+	batch->remaining.store(batch->documents.size(), std::memory_order_relaxed);
+	std::vector<PendingSave> pending;
+	pending.reserve(batch->documents.size());
+	for (size_t i = 0; i < batch->documents.size(); ++i)
+	{
+		pending.push_back({ batch->documents[i].path, g_Core.getThreadPool()->enqueue([batch, i]() {
+			DocumentsSaved::SavedDocument &document = batch->documents[i];
+			const bool saved = core::FileSystem::saveFile(*document.text, document.path, document.encoding).has_value();
+			document.saved = saved;
+			if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				g_Core.getEventBus()->post(DocumentsSaved{ std::move(batch->documents) });
+			return saved;
+		}).share() });
+	}
+	return pending;
+}
+std::optional<std::filesystem::path> EditorTab::save()
+{
+	if (isLoading()) {
+		LOG("Cannot save {} before it finished loading", core::Log::LogLevel::Warn, m_TabName);
+		return std::nullopt;
+	}
+	const std::string &buffer = m_Document.get()->getText();
+	const auto path = g_Core.getFileSystem()->saveFile(buffer, m_Path, m_Document->getSaveEncoding());
+	if (!path.has_value()) {
+		LOG("Warning: File save operation failed or was cancelled by user.", core::Log::LogLevel::Warn);
+		return std::nullopt;
+	}
+	setTabName(path.value().filename().string());
+	setFilePath(path.value());
+	m_Document.get()->markClean();
+
+	std::string uri = "file://" + std::filesystem::absolute(path.value()).string();
+	g_Core.getEventBus()->publish(core::DocumentChanged{ path.value(), buffer });
+	m_focusEditorNextFrame = true;
+	return std::optional<std::filesystem::path>(m_Path);
+}
+void TabBar::closeAll()
+{
+	m_Tabs.clear();
+	m_Tabs.shrink_to_fit();
+}
+
+void Document::insertText(size_t position, const std::string& text) {
+    if (position > m_TextBuffer.size()) {
+        position = m_TextBuffer.size();
+    }
+    
+    m_TextBuffer.insert(position, text);
+    ++m_Revision;
+    m_LineStarts.clear();
+    m_Dirty = true;
+    
+    m_UndoStack.push_back(m_TextBuffer.substr(0, position) + 
+                         m_TextBuffer.substr(position + text.size()));
+    m_RedoStack.clear();
+}
+
+void Document::insertTextAtCursor(const std::string& text) {
+    insertText(m_CursorPos, text);
+    m_CursorPos += text.size();
+}
+
+void EditorTab::insertText(const std::string& text) {
+	if (isLoading())
+		return;
+	m_Document->insertTextAtCursor(text);
+}
+
+void TabBar::insertText(const std::string& text) {
+	if (EditorTab* tab = getCurrentTab()) {
+		tab->insertText(text);
+	}
+}
+
+void EditorManager::insertText(const std::string& text) {
+    m_TabBar.insertText(text);
+    
+    if (EditorTab* tab = m_TabBar.getCurrentTab()) {
+        if (!tab->getFilePath().empty()) {
+            g_Core.getEventBus()->publish(core::DocumentChanged{ tab->getFilePath(), tab->getDocument().getText() });
+        }
+    }
+    
+    LOG("Inserted text: {}", core::Log::Tracer, text);
+}
+
+// What one autosave round writes, taken on the UI thread
+struct RecoverySnapshot {
+	std::filesystem::path file;
+	std::filesystem::path documentPath; // empty for a tab that was never saved
+	std::string tabName;
+	std::shared_ptr<const std::string> text; // null once the document is clean or closed, the file is removed
+};
+
+static void WriteRecoveryFiles(const std::vector<RecoverySnapshot> &snapshots)
+{
+	PROFILE_ZONE("EditorManager::WriteRecoveryFiles");
+	std::error_code ec;
+
+	for (const RecoverySnapshot &snapshot : snapshots)
+	{
+		if (!snapshot.text)
+		{
+			std::filesystem::remove(snapshot.file, ec);
+			continue;
+		}
+
+		const std::string documentPath = snapshot.documentPath.string();
+		std::string content;
+		content.reserve(kRecoveryHeader.size() + documentPath.size() + snapshot.tabName.size() + 2 + snapshot.text->size());
+		content += kRecoveryHeader;
+		content += documentPath;
+		content += '\n';
+		content += snapshot.tabName;
+		content += '\n';
+		content += *snapshot.text;
+
+		if (!core::FileSystem::writeFileAtomic(snapshot.file, content))
+			LOG("Failed to write recovery file {}", core::Log::LogLevel::Warn, snapshot.file.string());
+	}
+}
+
+void EditorManager::updateAutosave(float deltaTimeSeconds) {
+	if (!m_autoSaveEnabled || m_RecoverySession.empty()) return;
+
+	m_autoSaveTimer += deltaTimeSeconds;
+	if (m_autoSaveTimer < m_autoSaveInterval) return;
+
+	// The previous round is still writing, try again next frame
+	if (m_AutosaveTask.valid() && m_AutosaveTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+	m_autoSaveTimer = 0.0f;
+
+	std::vector<RecoverySnapshot> snapshots;
+	for (auto recovery = m_RecoveryFiles.begin(); recovery != m_RecoveryFiles.end();)
+	{
+		if (m_TabBar.findTab(recovery->first))
+		{
+			++recovery;
+			continue;
+		}
+		snapshots.push_back({ recovery->second.file, {}, {}, nullptr }); // tab was closed
+		recovery = m_RecoveryFiles.erase(recovery);
+	}
+
+	for (int i = 0; i < m_TabBar.getTabCount(); ++i)
+	{
+		EditorTab *tab = m_TabBar.getTab(i);
+		if (tab->isLoading())
+			continue;
+
+		Document &doc = tab->getDocument();
+		auto recovery = m_RecoveryFiles.find(tab->getID());
+		if (!doc.isDirty())
+		{
+			if (recovery != m_RecoveryFiles.end())
+			{
+				snapshots.push_back({ recovery->second.file, {}, {}, nullptr });
+				m_RecoveryFiles.erase(recovery);
+			}
+			continue;
+		}
+
+		if (recovery == m_RecoveryFiles.end())
+			recovery = m_RecoveryFiles.emplace(tab->getID(), RecoveryFile{ m_RecoverySession / (tab->getID() + ".txt") }).first;
+		if (recovery->second.revision == doc.getRevision())
+			continue; // unchanged since the last round
+
+		// The only work on the UI thread is this copy, formatting and writing happen on the pool
+		recovery->second.revision = doc.getRevision();
+		snapshots.push_back({ recovery->second.file, tab->getFilePath(), tab->getTabName(), std::make_shared<const std::string>(doc.getText()) });
+	}
+
+	if (snapshots.empty()) return;
+	m_AutosaveTask = g_Core.getThreadPool()->enqueue(core::TaskPriority::Background, [snapshots = std::move(snapshots)]() {
+		WriteRecoveryFiles(snapshots);
+	});
+}
+
+void EditorManager::recoverDocuments() {
+	if (m_RecoverySession.empty())
+		return;
+	const int firstRecovered = m_TabBar.getTabCount();
+
+	std::vector<std::filesystem::path> sessions;
+	std::error_code ec;
+	for (const auto &session : std::filesystem::directory_iterator(RecoveryDirectory(), ec))
+	{
+		// Our own session only holds files when a crashed process had the same pid, they are read below
+		if (session.is_directory(ec) && session.path() != m_RecoverySession)
+			sessions.push_back(session.path());
+	}
+
+	for (const std::filesystem::path &session : sessions)
+	{
+		// Still locked: a running instance is writing these, they are not ours to open or delete
+		auto lock = core::Platform::lockFile(session / kSessionLockName);
+		if (!lock)
+			continue;
+
+		// Adopted into our session, where they are kept up to date and removed on exit like our own
+		std::vector<std::filesystem::path> files;
+		for (const auto &entry : std::filesystem::directory_iterator(session, ec))
+		{
+			if (entry.path().filename() != kSessionLockName)
+				files.push_back(entry.path());
+		}
+		for (const std::filesystem::path &file : files)
+			std::filesystem::rename(file, m_RecoverySession / file.filename(), ec);
+
+		core::Platform::unlockFile(*lock);
+		std::filesystem::remove_all(session, ec);
+	}
+
+	for (const auto &entry : std::filesystem::directory_iterator(m_RecoverySession, ec))
+	{
+		if (entry.path().filename() == kSessionLockName)
+			continue;
+
+		auto content = core::FileSystem::readFile(entry.path());
+		if (!content || !content->starts_with(kRecoveryHeader))
+			continue;
+
+		const size_t pathEnd = content->find('\n', kRecoveryHeader.size());
+		const size_t nameEnd = pathEnd == std::string::npos ? std::string::npos : content->find('\n', pathEnd + 1);
+		if (nameEnd == std::string::npos)
+			continue;
+
+		const std::filesystem::path documentPath = content->substr(kRecoveryHeader.size(), pathEnd - kRecoveryHeader.size());
+		const std::string tabName = content->substr(pathEnd + 1, nameEnd - pathEnd - 1);
+		content->erase(0, nameEnd + 1);
+
+		auto tab = std::make_unique<EditorTab>(std::make_unique<Document>());
+		tab->setTabName(tabName);
+		tab->setFilePath(documentPath);
+		tab->getDocument().setText(std::move(*content)); // dirty, the file on disk lacks these changes
+		// Recovery files hold UTF-8, the document is saved in the encoding of the file it belongs to
+		if (auto original = documentPath.empty() ? std::nullopt : core::FileSystem::readFile(documentPath))
+			tab->getDocument().setEncoding(core::DecodeText(*original));
+		m_TabBar.addTab(std::move(tab));
+
+		// Keeps using the same file, so the changes survive another crash before the next round
+		EditorTab *recovered = m_TabBar.getTab(m_TabBar.getTabCount() - 1);
+		m_RecoveryFiles[recovered->getID()] = RecoveryFile{ entry.path(), recovered->getDocument().getRevision() };
+		LOG("Recovered unsaved changes of {}", core::Log::LogLevel::Warn, tabName);
+
+		if (!documentPath.empty())
+			g_Core.getEventBus()->publish(core::DocumentOpened{ documentPath, LanguageIdFor(documentPath), recovered->getDocument().getText() });
+	}
+
+	if (m_TabBar.getTabCount() > firstRecovered)
+		m_TabBar.setCurrentTabIndex(firstRecovered);
+}
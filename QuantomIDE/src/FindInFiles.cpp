@@ -0,0 +1,102 @@
+#include "FindInFiles.hpp"
+#include "AppEvents.hpp"
+
+#include <Core.hpp>
+
+extern core::Core g_Core;
+
+FindInFiles::FindInFiles()
+{
+	m_ResultsSubscription = g_Core.getEventBus()->subscribe<SearchResults>([this](const SearchResults& event) {
+		onResults(event);
+	});
+}
+
+FindInFiles::~FindInFiles()
+{
+	m_Search.reset();
+	g_Core.getEventBus()->unsubscribe(m_ResultsSubscription);
+}
+
+bool FindInFiles::start(const std::filesystem::path& root, const std::string& pattern, core::SearchOptions options)
+{
+	PROFILE_ZONE("FindInFiles::start");
+
+	// Cancelled, the previous search only finishes the files its tasks are in the middle of
+	cancel();
+	m_Search.reset();
+
+	m_Files.clear();
+	m_Rows.clear();
+	m_MatchCount = 0;
+	m_Truncated = false;
+	m_Error.clear();
+	m_Root = root;
+	++m_SearchId;
+
+	auto searcher = core::TextSearcher::create(pattern, options, &m_Error);
+	if (!searcher.has_value())
+		return false;
+
+	core::EventBus* events = g_Core.getEventBus();
+	const std::uint64_t searchId = m_SearchId;
+	m_Running = true;
+	m_StartTime = std::chrono::steady_clock::now();
+	m_Search = std::make_unique<core::FileSearch>(*g_Core.getThreadPool(), root, std::move(*searcher), core::ScanOptions{},
+		[events, searchId](core::FileSearch::FileResult&& file) {
+			events->post(SearchResults{ searchId, std::make_unique<core::FileSearch::FileResult>(std::move(file)) });
+		},
+		[events, searchId]() {
+			events->post(SearchResults{ searchId, nullptr });
+		});
+	return true;
+}
+
+void FindInFiles::cancel()
+{
+	if (m_Search)
+		m_Search->cancel();
+}
+
+std::size_t FindInFiles::getSearchedFileCount() const
+{
+	return m_Search ? m_Search->getFileCount() : 0;
+}
+
+std::size_t FindInFiles::getSearchedByteCount() const
+{
+	return m_Search ? m_Search->getByteCount() : 0;
+}
+
+double FindInFiles::getElapsedSeconds() const
+{
+	const auto elapsed = m_Running ? std::chrono::steady_clock::now() - m_StartTime : m_Elapsed;
+	return std::chrono::duration<double>(elapsed).count();
+}
+
+void FindInFiles::onResults(const SearchResults& event)
+{
+	if (event.searchId != m_SearchId)
+		return;
+
+	if (!event.file) {
+		m_Running = false;
+		m_Elapsed = std::chrono::steady_clock::now() - m_StartTime;
+		return;
+	}
+	if (m_Truncated)
+		return; // still arriving from tasks that were running when the search was stopped
+
+	const auto fileIndex = static_cast<std::uint32_t>(m_Files.size());
+	const std::size_t lineCount = event.file->lines.size();
+	m_Rows.push_back({ fileIndex, FileRow });
+	for (std::size_t i = 0; i < lineCount; ++i)
+		m_Rows.push_back({ fileIndex, static_cast<std::uint32_t>(i) });
+	m_Files.push_back(std::move(*event.file));
+
+	m_MatchCount += lineCount;
+	if (m_MatchCount >= MaxMatches) {
+		m_Truncated = true;
+		cancel();
+	}
+}
@@ -1,4 +1,5 @@
 #include "LSP.hpp"
+#include <Profiler.hpp>
 #include <iostream>
 #include <sstream>
 #include <filesystem>
@@ -18,6 +19,12 @@ static std::string utf8FromWString(const std::wstring& w);
 
 namespace fs = std::filesystem;
 
+// Content-Length framing of one JSON-RPC message
+static std::string Frame(const json& message) {
+    std::string body = message.dump();
+    return "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
 // ==================== PLATFORM IMPLEMENTATIONS ====================
 
 #ifdef _WIN32
@@ -46,14 +53,14 @@ public:
         if (!CreatePipe(&hChildStd_OUT_Rd, &hChildStd_OUT_Wr, &saAttr, 0)) return false;
         if (!SetHandleInformation(hChildStd_OUT_Rd, HANDLE_FLAG_INHERIT, 0)) {
 			DWORD err = GetLastError();
-			LOG("[spawnClangd]: SetHandleInformation failed: %lu", core::Log::Error, err);
+			LOG("[spawnClangd]: SetHandleInformation failed: {}", core::Log::Error, err);
             CloseHandle(hChildStd_OUT_Rd); CloseHandle(hChildStd_OUT_Wr); return false;
         }
 
         // Create stdin pipe
         if (!CreatePipe(&hChildStd_IN_Rd, &hChildStd_IN_Wr, &saAttr, 0)) {
 			DWORD err = GetLastError();
-			LOG("[spawnClangd]: CreatePipe failed: %lu", core::Log::Error, err);
+			LOG("[spawnClangd]: CreatePipe failed: {}", core::Log::Error, err);
             CloseHandle(hChildStd_OUT_Rd); CloseHandle(hChildStd_OUT_Wr); return false;
         }
         if (!SetHandleInformation(hChildStd_IN_Wr, HANDLE_FLAG_INHERIT, 0)) {
@@ -86,14 +93,14 @@ public:
         siStartInfo.hStdInput = hChildStd_IN_Rd;
         siStartInfo.dwFlags |= STARTF_USESTDHANDLES;
 
-        LOG("Spawning: %s %s", core::Log::Tracer, serverPath.c_str(), commandLine.c_str());
+        LOG("Spawning: {} {}", core::Log::Tracer, serverPath, commandLine);
 
         BOOL bSuccess = CreateProcessW(nullptr, wCommandLine.data(), nullptr, nullptr, TRUE,
                                      CREATE_NO_WINDOW, nullptr, nullptr, &siStartInfo, &piProcInfo);
 
         if (!bSuccess) {
             DWORD err = GetLastError();
-            LOG("[spawnClangd]: CreateProcessW failed: %lu", core::Log::Error, err);
+            LOG("[spawnClangd]: CreateProcessW failed: {}", core::Log::Error, err);
             CloseHandle(hChildStd_OUT_Rd); CloseHandle(hChildStd_OUT_Wr);
             CloseHandle(hChildStd_IN_Rd); CloseHandle(hChildStd_IN_Wr); 
             return false;
@@ -123,7 +130,7 @@ public:
 
         if (!bSuccess) {
             DWORD err = GetLastError();
-            LOG("[writeRaw]: WriteFile failed: %lu", core::Log::Error, err);
+            LOG("[writeRaw]: WriteFile failed: {}", core::Log::Error, err);
 		}
 
         return bSuccess && totalWritten == s.size();
@@ -261,6 +268,7 @@ LSPClient::~LSPClient() {
 
 int LSPClient::nextId() {
     std::lock_guard<std::mutex> lock(writeMutex);
+    pendingRequests.fetch_add(1, std::memory_order_relaxed); // every id belongs to a request awaiting its response
     return idCounter++;
 }
 
@@ -273,7 +281,9 @@ bool LSPClient::start() {
     }
 
     running = true;
+    writerStopping = false;
     readerThread = std::thread(&LSPClient::readerLoop, this);
+    writerThread = std::thread(&LSPClient::writerLoop, this);
 
     // Initialize LSP
     json initParams = {
@@ -297,28 +307,19 @@ bool LSPClient::start() {
         {"params", initParams}
     };
 
-    std::string initStr = initRequest.dump();
-    std::ostringstream header;
-    header << "Content-Length: " << initStr.size() << "\r\n\r\n" << initStr;
-    writeRaw(header.str());
-
     json initNotif = {
         {"jsonrpc", "2.0"},
         {"method", "initialized"},
         {"params", json::object()}
     };
 
-    std::string notifStr = initNotif.dump();
-    std::ostringstream notifHeader;
-    notifHeader << "Content-Length: " << notifStr.size() << "\r\n\r\n" << notifStr;
-    writeRaw(notifHeader.str());
+    send([message = Frame(initRequest) + Frame(initNotif)]() { return message; });
 
     return true;
 }
 
 void LSPClient::stop() {
     if (!running) return;
-    running = false;
 
     json shutdownRequest = {
         {"jsonrpc", "2.0"},
@@ -327,21 +328,16 @@ void LSPClient::stop() {
         {"params", json::object()}
     };
 
-    std::string shutdownStr = shutdownRequest.dump();
-    std::ostringstream header;
-    header << "Content-Length: " << shutdownStr.size() << "\r\n\r\n" << shutdownStr;
-    writeRaw(header.str());
-
     json exitNotif = {
         {"jsonrpc", "2.0"},
         {"method", "exit"},
         {"params", json::object()}
     };
 
-    std::string exitStr = exitNotif.dump();
-    std::ostringstream exitHeader;
-    exitHeader << "Content-Length: " << exitStr.size() << "\r\n\r\n" << exitStr;
-    writeRaw(exitHeader.str());
+    // Everything sent before goes out first
+    send([message = Frame(shutdownRequest) + Frame(exitNotif)]() { return message; });
+    stopWriter();
+    running = false;
 
     platform->closeHandles();
 
@@ -351,10 +347,53 @@ void LSPClient::stop() {
 }
 
 bool LSPClient::writeRaw(const std::string& s) {
+    // Only the writer thread writes, the lock keeps a message whole should that change
+    std::lock_guard<std::mutex> lock(writeMutex);
     return platform->writeRaw(s);
 }
 
+void LSPClient::send(Message message) {
+    if (!running) return; // clangd did not start or has been stopped
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        outgoing.push_back(std::move(message));
+    }
+    queueCondition.notify_one();
+}
+
+void LSPClient::stopWriter() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        writerStopping = true;
+    }
+    queueCondition.notify_one();
+    if (writerThread.joinable())
+        writerThread.join();
+}
+
+void LSPClient::writerLoop() {
+    core::Profiler::SetThreadName("LSP writer");
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCondition.wait(lock, [this] { return writerStopping || !outgoing.empty(); });
+        if (outgoing.empty())
+            return; // stopping, and everything was written
+
+        Message message = std::move(outgoing.front());
+        outgoing.pop_front();
+        lock.unlock();
+        {
+            PROFILE_ZONE("LSPClient::write");
+            const std::string bytes = message();
+            if (!bytes.empty() && !writeRaw(bytes))
+                LOG("[LSP Client] writing to clangd failed", core::Log::LogLevel::Warn);
+        }
+        lock.lock();
+    }
+}
+
 void LSPClient::readerLoop() {
+    core::Profiler::SetThreadName("LSP reader");
     std::string buffer;
     constexpr size_t bufSize = 8192;
     std::vector<char> readBuf(bufSize);
@@ -376,6 +415,7 @@ void LSPClient::readerLoop() {
         if (bytesRead <= 0) break;
 #endif
 
+        PROFILE_ZONE("LSPClient::read"); // framing and handling of what arrived, not the blocking read
         buffer.append(readBuf.data(), bytesRead);
 
         while (true) {
@@ -408,10 +448,15 @@ void LSPClient::readerLoop() {
 
             if (!content.empty()) {
                 try {
-                    json msg = json::parse(content);
+                    json msg;
+                    {
+                        PROFILE_ZONE("LSPClient::parse");
+                        msg = json::parse(content);
+                    }
+                    PROFILE_ZONE("LSPClient::handleJsonMessage");
                     handleJsonMessage(msg);
                 } catch (const std::exception& e) {
-                    if (logCB) LOG("Failed to parse JSON: %s", core::Log::LogLevel::Error, e.what());
+                    if (logCB) LOG("Failed to parse JSON: {}", core::Log::LogLevel::Error, e.what());
                 }
             }
         }
@@ -439,6 +484,9 @@ void LSPClient::handleJsonMessage(const json& msg) {
         try { id = msg["id"].get<int>(); } catch (...) { return; }
         if (id == -1) return;
 
+        if (pendingRequests.load(std::memory_order_relaxed) > 0)
+            pendingRequests.fetch_sub(1, std::memory_order_relaxed);
+
         if (msg.contains("result")) {
             const auto& res = msg["result"];
             std::vector<CompletionItem> items;
@@ -475,66 +523,73 @@ std::string LSPClient::toLspUri(const std::filesystem::path& path) const  {
 }
 
 int LSPClient::textDocumentCompletion(const fs::path& uri, int line, int character) {
+    // The id is handed out now, the request follows the didChanges sent before it
     int id = nextId();
-    json params = {
-        {"textDocument", {{"uri", toLspUri(uri)}}},
-        {"position", {{"line", line}, {"character", character}}},
-        {"context", {
-            {"triggerKind", 1}
-        }}
-    };
-    json request = {
-        {"jsonrpc", "2.0"},
-        {"id", id},
-        {"method", "textDocument/completion"},
-        {"params", params}
-    };
-    std::string reqStr = request.dump();
-    std::ostringstream header;
-    header << "Content-Length: " << reqStr.size() << "\r\n\r\n" << reqStr;
-    writeRaw(header.str());
+    send([this, id, uri, line, character]() {
+        json params = {
+            {"textDocument", {{"uri", toLspUri(uri)}}},
+            {"position", {{"line", line}, {"character", character}}},
+            {"context", {
+                {"triggerKind", 1}
+            }}
+        };
+        json request = {
+            {"jsonrpc", "2.0"},
+            {"id", id},
+            {"method", "textDocument/completion"},
+            {"params", params}
+        };
+        return Frame(request);
+    });
     return id;
 }
 
-void LSPClient::textDocumentDidOpen(const fs::path& uri, const std::string& languageId, const std::string& text) {
-    json params = {
-        {"textDocument", {
-            {"uri", toLspUri(uri)},
-            {"languageId", languageId},
-            {"version", 1},
-            {"text", text}
-        }}
-    };
-    json notif = {
-        {"jsonrpc", "2.0"},
-        {"method", "textDocument/didOpen"},
-        {"params", params}
-    };
-    std::string notifStr = notif.dump();
-    std::ostringstream header;
-    header << "Content-Length: " << notifStr.size() << "\r\n\r\n" << notifStr;
-    writeRaw(header.str());
+void LSPClient::textDocumentDidOpen(const fs::path& uri, std::string_view languageId, std::string_view text) {
+    // Copying the text is cheap next to serialising it, which happens on the writer thread
+    send([this, uri, languageId = std::string(languageId), text = std::string(text)]() {
+        json params = {
+            {"textDocument", {
+                {"uri", toLspUri(uri)},
+                {"languageId", languageId},
+                {"version", 1},
+                {"text", text}
+            }}
+        };
+        json notif = {
+            {"jsonrpc", "2.0"},
+            {"method", "textDocument/didOpen"},
+            {"params", params}
+        };
+        return Frame(notif);
+    });
 }
 
-void LSPClient::textDocumentDidChange(const fs::path& uri, const std::string& text) {
-    json params = {
-        {"textDocument", {
-            {"uri", toLspUri(uri)},
-            {"version", 2}
-        }},
-        {"contentChanges", json::array({
-            json::object({
-                {"text", text}
-            })
-        })}
-    };
-    json notif = {
-        {"jsonrpc", "2.0"},
-        {"method", "textDocument/didChange"},
-        {"params", params}
-    };
-    std::string notifStr = notif.dump();
-    std::ostringstream header;
-    header << "Content-Length: " << notifStr.size() << "\r\n\r\n" << notifStr;
-    writeRaw(header.str());
+void LSPClient::textDocumentDidChange(const fs::path& uri, std::string_view text) {
+    textDocumentsDidChange({ { uri, std::make_shared<const std::string>(text) } });
+}
+
+void LSPClient::textDocumentsDidChange(std::vector<std::pair<fs::path, std::shared_ptr<const std::string>>> documents) {
+    send([this, documents = std::move(documents)]() {
+        std::string messages;
+        for (const auto& [uri, text] : documents) {
+            json params = {
+                {"textDocument", {
+                    {"uri", toLspUri(uri)},
+                    {"version", 2}
+                }},
+                {"contentChanges", json::array({
+                    json::object({
+                        {"text", *text}
+                    })
+                })}
+            };
+            json notif = {
+                {"jsonrpc", "2.0"},
+                {"method", "textDocument/didChange"},
+                {"params", params}
+            };
+            messages += Frame(notif);
+        }
+        return messages;
+    });
 }
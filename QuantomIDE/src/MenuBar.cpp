@@ -1,9 +1,9 @@
-#include "MenuBar.hpp"
-
-MenuBar::MenuBar()
-{
-}
-
-MenuBar::~MenuBar()
-{
-}
+#include "MenuBar.hpp"
+
+MenuBar::MenuBar()
+{
+}
+
+MenuBar::~MenuBar()
+{
+}
@@ -0,0 +1,101 @@
+#include "PerformanceMonitor.hpp"
+
+#include <Core.hpp>
+
+#include <algorithm>
+#include <string_view>
+
+extern core::Core g_Core;
+
+// Zone names the monitor gives a meaning to, see the PROFILE_ZONE call sites
+static constexpr std::string_view kFrameZone = "Frame";
+static constexpr std::string_view kPoolTaskZone = "ThreadPool::runTask";
+
+static constexpr double kPublishSeconds = 0.5;
+static constexpr double kMaxCatchUpSeconds = 1.0; // after the window was hidden, older zones are skipped
+
+void PerformanceMonitor::update(std::size_t lspPendingRequests)
+{
+	const double ticksPerMillisecond = core::Profiler::TicksPerNanosecond() * 1e6;
+	const std::uint64_t now = core::Profiler::Now();
+	const auto catchUp = static_cast<std::uint64_t>(kMaxCatchUpSeconds * 1000.0 * ticksPerMillisecond);
+	const std::uint64_t oldest = now > catchUp ? now - catchUp : 0;
+	if (m_LastUpdate < oldest) {
+		// First update or the window was hidden, the interval restarts with the zones still worth showing
+		m_Interval.clear();
+		m_IntervalFrames = 0;
+		m_IntervalStart = oldest;
+	}
+	const std::uint64_t since = std::max(m_LastUpdate, oldest);
+
+	for (const auto& thread : core::Profiler::Collect(since)) {
+		for (const core::ProfileEvent& event : thread.events) {
+			const double milliseconds = static_cast<double>(event.end - event.begin) / ticksPerMillisecond;
+
+			ZoneTotal& total = m_Interval[event.site];
+			total.milliseconds += milliseconds;
+			total.maxMilliseconds = std::max(total.maxMilliseconds, milliseconds);
+			++total.calls;
+
+			if (event.site->name == kFrameZone) {
+				addFrame(static_cast<float>(milliseconds));
+				++m_IntervalFrames;
+			}
+		}
+	}
+	m_LastUpdate = now;
+
+	if (static_cast<double>(now - m_IntervalStart) >= kPublishSeconds * 1000.0 * ticksPerMillisecond)
+		publish(now, ticksPerMillisecond, lspPendingRequests);
+}
+
+void PerformanceMonitor::addFrame(float milliseconds)
+{
+	if (m_FrameTimes.size() == HistorySize)
+		m_FrameTimes.erase(m_FrameTimes.begin());
+	m_FrameTimes.push_back(milliseconds);
+}
+
+void PerformanceMonitor::publish(std::uint64_t now, double ticksPerMillisecond, std::size_t lspPendingRequests)
+{
+	const double intervalMilliseconds = static_cast<double>(now - m_IntervalStart) / ticksPerMillisecond;
+	const double frames = static_cast<double>(std::max<std::size_t>(m_IntervalFrames, 1));
+
+	Snapshot snapshot;
+	snapshot.poolThreads = g_Core.getThreadPool()->getThreadCount();
+	for (const auto& [site, total] : m_Interval) {
+		snapshot.zones.push_back({ site, total.milliseconds / frames, total.maxMilliseconds, total.calls });
+		if (site->name == kPoolTaskZone && snapshot.poolThreads > 0)
+			snapshot.poolUtilisation += total.milliseconds / (intervalMilliseconds * static_cast<double>(snapshot.poolThreads));
+	}
+	snapshot.poolUtilisation = std::min(snapshot.poolUtilisation, 1.0);
+	std::sort(snapshot.zones.begin(), snapshot.zones.end(), [](const ZoneTiming& a, const ZoneTiming& b) {
+		return a.millisecondsPerFrame > b.millisecondsPerFrame;
+	});
+
+	snapshot.lspPendingRequests = lspPendingRequests;
+	const core::FrameArena::Stats arena = g_Core.getFrameArena()->getLastFrameStats();
+	snapshot.frameAllocations = arena.allocations;
+	snapshot.frameBytes = arena.used;
+	snapshot.memoryPoolBlocksInUse = g_Core.getMemoryPool()->getStats().inUse;
+	m_Snapshot = std::move(snapshot);
+
+	// Percentiles and the distribution over the whole history
+	m_Sorted = m_FrameTimes;
+	std::sort(m_Sorted.begin(), m_Sorted.end());
+	auto percentile = [&](double p) {
+		if (m_Sorted.empty())
+			return 0.0f;
+		return m_Sorted[std::min(m_Sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(m_Sorted.size())))];
+	};
+	m_Percentiles = { percentile(0.50), percentile(0.95), percentile(0.99) };
+
+	const std::size_t buckets = std::clamp<std::size_t>(static_cast<std::size_t>(m_Percentiles.p99 * 1.5f) + 1, 20, 100);
+	m_Histogram.assign(buckets, 0.0f);
+	for (const float milliseconds : m_FrameTimes)
+		m_Histogram[std::min(buckets - 1, static_cast<std::size_t>(milliseconds))] += 1.0f;
+
+	m_Interval.clear();
+	m_IntervalFrames = 0;
+	m_IntervalStart = now;
+}
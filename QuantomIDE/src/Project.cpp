@@ -1,146 +1,205 @@
-#include "Project.hpp"
-
-using json = nlohmann::json;
-namespace fs = std::filesystem;
-
-// --- Project Loading ---
-
-bool Project::createNew(const std::filesystem::path& rootDir, const std::string& pName)
-{
-    rootDirectory = rootDir;
-
-    projectFilePath = rootDir / (pName + ".qum");
-
-    name = pName;
-    isopen = true;
-
-    return false;
-}
-
-bool Project::open(const fs::path& path) {
-    if (!fs::exists(path)) return false;
-
-    std::ifstream file(path);
-    if (!file.is_open()) return false;
-
-    json j;
-    try {
-        file >> j;
-    }
-    catch (const std::exception& e) {
-        return false; // Failed to parse JSON
-    }
-
-    // Parse basic fields
-    name = j.value("name", "");
-    projectFilePath = path;
-    rootDirectory = j.value("rootDirectory", path.parent_path().string());
-
-    // Parse vectors of paths
-    sourceFiles.clear();
-    if (j.contains("sourceFiles") && j["sourceFiles"].is_array()) {
-        for (const auto& s : j["sourceFiles"]) {
-            sourceFiles.emplace_back(s.get<std::string>());
-        }
-    }
-
-    includeDirs.clear();
-    if (j.contains("includeDirs") && j["includeDirs"].is_array()) {
-        for (const auto& d : j["includeDirs"]) {
-            includeDirs.emplace_back(d.get<std::string>());
-        }
-    }
-
-    compiler = j.value("compiler", "");
-    compilerFlags.clear();
-    if (j.contains("compilerFlags") && j["compilerFlags"].is_array()) {
-        for (const auto& flag : j["compilerFlags"]) {
-            compilerFlags.push_back(flag.get<std::string>());
-        }
-    }
-
-    openFiles.clear();
-    if (j.contains("openFiles") && j["openFiles"].is_array()) {
-        for (const auto& f : j["openFiles"]) {
-            openFiles.emplace(fs::path(f.get<std::string>()));
-        }
-    }
-
-    dirty = j.value("dirty", false);
-    
-    isopen = true;
-    return true;
-}
-
-bool Project::save()  { 
-    std::ofstream file(std::string(this->projectFilePath.string()));
-    if (!file.is_open()) return false;
-
-    dirty = false;
-    json j;
-    j["name"] = name;
-    j["projectFilePath"] = projectFilePath.string();
-    j["rootDirectory"] = rootDirectory.string();
-
-    // Serialize vectors
-    std::vector<std::string> srcFiles;
-    for (const auto& src : sourceFiles)
-        srcFiles.push_back(src.string());
-    j["sourceFiles"] = srcFiles;
-
-    std::vector<std::string> includes;
-    for (const auto& inc : includeDirs)
-        includes.push_back(inc.string());
-    j["includeDirs"] = includes;
-
-    j["compiler"] = compiler;
-    j["compilerFlags"] = compilerFlags;
-
-    std::vector<std::string> openFileStrings;
-    for (const auto& f : openFiles)
-        openFileStrings.push_back(f.string());
-    j["openFiles"] = openFileStrings;
-
-    j["dirty"] = dirty;
-
-    file << j.dump(4); // pretty print with indent of 4 spaces
-
-   
-    return true;
-}
-
-// --- File Management ---
-
-void Project::addSourceFile(const fs::path& file) {
-    if (std::find(sourceFiles.begin(), sourceFiles.end(), file) == sourceFiles.end()) {
-        sourceFiles.push_back(file);
-        fileToFilter.insert({ file, "Source Files" });
-        dirty = true;
-    }
-}
-
-void Project::removeFile(const fs::path& file) {
-    auto it = std::remove(sourceFiles.begin(), sourceFiles.end(), file);
-    if (it != sourceFiles.end()) {
-        sourceFiles.erase(it, sourceFiles.end());
-        dirty = true;
-    }
-}
-
-bool Project::containsFile(const fs::path& file) const {
-    return std::find(sourceFiles.begin(), sourceFiles.end(), file) != sourceFiles.end();
-}
-
-// --- Getters ---
-
-const std::vector<fs::path>& Project::getSourceFiles() const {
-    return sourceFiles;
-}
-
-const std::string& Project::getName() const {
-    return name;
-}
-
-const fs::path& Project::getProjectPath() const {
-    return projectFilePath;
-}
+#include "Project.hpp"
+
+#include <FileSystem.hpp>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+// Revisions are unique across Project instances, so replacing the project is noticed as well
+static std::uint64_t s_RevisionCounter = 0;
+
+const char* to_string(BuildProfile profile) {
+    switch (profile) {
+    case BuildProfile::Debug:   return "Debug";
+    case BuildProfile::Release: return "Release";
+    case BuildProfile::ASan:    return "ASan";
+    }
+    return "Debug";
+}
+
+static BuildProfile parseBuildProfile(const std::string& name) {
+    for (BuildProfile profile : { BuildProfile::Debug, BuildProfile::Release, BuildProfile::ASan }) {
+        if (name == to_string(profile))
+            return profile;
+    }
+    return BuildProfile::Debug;
+}
+
+void Project::markEdited() {
+    dirty = true;
+    revision = ++s_RevisionCounter;
+}
+
+// --- Project Loading ---
+
+bool Project::createNew(const std::filesystem::path& rootDir, const std::string& pName)
+{
+    rootDirectory = rootDir;
+
+    projectFilePath = rootDir / (pName + ".qum");
+
+    name = pName;
+    isopen = true;
+    revision = ++s_RevisionCounter;
+
+    return false;
+}
+
+bool Project::open(const fs::path& path) {
+    if (!fs::exists(path)) return false;
+
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    json j;
+    try {
+        file >> j;
+    }
+    catch (const std::exception& e) {
+        return false; // Failed to parse JSON
+    }
+
+    // Parse basic fields
+    name = j.value("name", "");
+    projectFilePath = path;
+    rootDirectory = j.value("rootDirectory", path.parent_path().string());
+
+    // Parse vectors of paths
+    sourceFiles.clear();
+    if (j.contains("sourceFiles") && j["sourceFiles"].is_array()) {
+        for (const auto& s : j["sourceFiles"]) {
+            sourceFiles.emplace_back(s.get<std::string>());
+        }
+    }
+
+    includeDirs.clear();
+    if (j.contains("includeDirs") && j["includeDirs"].is_array()) {
+        for (const auto& d : j["includeDirs"]) {
+            includeDirs.emplace_back(d.get<std::string>());
+        }
+    }
+
+    compiler = j.value("compiler", "");
+    compilerFlags.clear();
+    if (j.contains("compilerFlags") && j["compilerFlags"].is_array()) {
+        for (const auto& flag : j["compilerFlags"]) {
+            compilerFlags.push_back(flag.get<std::string>());
+        }
+    }
+
+    profile = parseBuildProfile(j.value("profile", "Debug"));
+
+    unityBuild = j.value("unityBuild", false);
+    unityBatchCount = std::max(0, j.value("unityBatches", 0));
+
+    openFiles.clear();
+    if (j.contains("openFiles") && j["openFiles"].is_array()) {
+        for (const auto& f : j["openFiles"]) {
+            openFiles.emplace(fs::path(f.get<std::string>()));
+        }
+    }
+
+    dirty = j.value("dirty", false);
+    
+    isopen = true;
+    revision = ++s_RevisionCounter;
+    return true;
+}
+
+bool Project::save()  { 
+    dirty = false;
+    json j;
+    j["name"] = name;
+    j["projectFilePath"] = projectFilePath.string();
+    j["rootDirectory"] = rootDirectory.string();
+
+    // Serialize vectors
+    std::vector<std::string> srcFiles;
+    for (const auto& src : sourceFiles)
+        srcFiles.push_back(src.string());
+    j["sourceFiles"] = srcFiles;
+
+    std::vector<std::string> includes;
+    for (const auto& inc : includeDirs)
+        includes.push_back(inc.string());
+    j["includeDirs"] = includes;
+
+    j["compiler"] = compiler;
+    j["compilerFlags"] = compilerFlags;
+    j["profile"] = to_string(profile);
+
+    j["unityBuild"] = unityBuild;
+    j["unityBatches"] = unityBatchCount;
+
+    std::vector<std::string> openFileStrings;
+    for (const auto& f : openFiles)
+        openFileStrings.push_back(f.string());
+    j["openFiles"] = openFileStrings;
+
+    j["dirty"] = dirty;
+
+    // pretty print with indent of 4 spaces, replaced atomically so a crash cannot leave half a project file
+    if (!core::FileSystem::writeFileAtomic(projectFilePath, j.dump(4))) {
+        dirty = true;
+        return false;
+    }
+    return true;
+}
+
+// --- File Management ---
+
+void Project::addSourceFile(const fs::path& file) {
+    if (std::find(sourceFiles.begin(), sourceFiles.end(), file) == sourceFiles.end()) {
+        sourceFiles.push_back(file);
+        fileToFilter.insert({ file, "Source Files" });
+        markEdited();
+    }
+}
+
+void Project::removeFile(const fs::path& file) {
+    auto it = std::remove(sourceFiles.begin(), sourceFiles.end(), file);
+    if (it != sourceFiles.end()) {
+        sourceFiles.erase(it, sourceFiles.end());
+        markEdited();
+    }
+}
+
+bool Project::containsFile(const fs::path& file) const {
+    return std::find(sourceFiles.begin(), sourceFiles.end(), file) != sourceFiles.end();
+}
+
+void Project::setUnityBuild(bool enabled) {
+    if (unityBuild != enabled) {
+        unityBuild = enabled;
+        markEdited();
+    }
+}
+
+void Project::setUnityBatchCount(int count) {
+    count = std::max(0, count);
+    if (unityBatchCount != count) {
+        unityBatchCount = count;
+        markEdited();
+    }
+}
+
+void Project::setBuildProfile(BuildProfile newProfile) {
+    if (profile != newProfile) {
+        profile = newProfile;
+        markEdited();
+    }
+}
+
+// --- Getters ---
+
+const std::vector<fs::path>& Project::getSourceFiles() const {
+    return sourceFiles;
+}
+
+const std::string& Project::getName() const {
+    return name;
+}
+
+const fs::path& Project::getProjectPath() const {
+    return projectFilePath;
+}
@@ -1,9 +1,281 @@
-#include "TreeView.hpp"
-
-TreeView::TreeView()
-{
-}
-
-TreeView::~TreeView()
-{
-}
+#include "TreeView.hpp"
+#include "Core.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+extern core::Core g_Core;
+
+// Children are kept in this order: directories first, then in natural order
+struct ChildKey {
+	bool isDirectory;
+	std::string_view sortKey;
+	std::string_view name;
+};
+
+static ChildKey KeyOf(const TreeNode& node)
+{
+	return { node.isDirectory, node.sortKey, node.name };
+}
+
+static bool ComesBefore(const ChildKey& a, const ChildKey& b)
+{
+	if (a.isDirectory != b.isDirectory)
+		return a.isDirectory;
+	if (a.sortKey != b.sortKey)
+		return a.sortKey < b.sortKey;
+	return a.name < b.name;
+}
+
+using Children = std::vector<std::unique_ptr<TreeNode>>;
+
+static Children::iterator LowerBound(Children& children, const ChildKey& key)
+{
+	return std::lower_bound(children.begin(), children.end(), key, [](const auto& child, const ChildKey& value) {
+		return ComesBefore(KeyOf(*child), value);
+	});
+}
+
+// Binary search for the child called name, which may be a directory or a file
+static Children::iterator FindChild(Children& children, const std::string& name, const std::string& sortKey)
+{
+	for (const bool isDirectory : { true, false }) {
+		auto it = LowerBound(children, { isDirectory, sortKey, name });
+		if (it != children.end() && (*it)->name == name)
+			return it;
+	}
+	return children.end();
+}
+
+TreeView::TreeView()
+{
+}
+
+TreeView::~TreeView()
+{
+	if (m_Root)
+		g_Core.getFileWatcher()->unwatch(m_Root->path);
+}
+
+void TreeView::setRoot(const fs::path& root)
+{
+	auto* watcher = g_Core.getFileWatcher();
+	if (m_Root)
+		watcher->unwatch(m_Root->path);
+
+	m_Root = std::make_unique<TreeNode>();
+	m_Root->path = fs::absolute(root).lexically_normal();
+	if (!m_Root->path.has_filename() && m_Root->path.has_relative_path())
+		m_Root->path = m_Root->path.parent_path();
+	m_Root->name = m_Root->path.filename().string();
+	m_Root->sortKey = MakeSortKey(m_Root->name);
+	m_Root->isDirectory = true;
+	m_Root->expanded = true;
+	m_RowsDirty = true;
+
+	watcher->watch(m_Root->path, [this](const std::vector<core::FileChange>& changes) {
+		applyChanges(changes);
+	});
+}
+
+void TreeView::expand(TreeNode& node)
+{
+	if (node.isDirectory && !node.loaded)
+		loadChildren(node);
+}
+
+void TreeView::setExpanded(TreeNode& node, bool expanded)
+{
+	if (node.expanded == expanded)
+		return;
+
+	node.expanded = expanded;
+	if (expanded)
+		expand(node);
+	m_RowsDirty = true;
+}
+
+const std::vector<TreeRow>& TreeView::getVisibleRows()
+{
+	if (m_RowsDirty)
+		rebuildRows();
+	return m_Rows;
+}
+
+void TreeView::rebuildRows()
+{
+	m_Rows.clear();
+	m_RowsDirty = false;
+	if (!m_Root)
+		return;
+
+	expand(*m_Root);
+
+	// Depth-first walk of the expanded directories, the root itself is not shown
+	std::vector<TreeRow> stack;
+	for (auto it = m_Root->children.rbegin(); it != m_Root->children.rend(); ++it)
+		stack.push_back({ it->get(), 0 });
+
+	while (!stack.empty()) {
+		const TreeRow row = stack.back();
+		stack.pop_back();
+		m_Rows.push_back(row);
+
+		if (row.node->isDirectory && row.node->expanded) {
+			for (auto it = row.node->children.rbegin(); it != row.node->children.rend(); ++it)
+				stack.push_back({ it->get(), row.depth + 1 });
+		}
+	}
+}
+
+// Reads the directory again, children that still exist keep their loaded subtrees
+void TreeView::loadChildren(TreeNode& node)
+{
+	std::unordered_map<std::string, std::unique_ptr<TreeNode>> previous;
+	for (auto& child : node.children)
+		previous.emplace(child->name, std::move(child));
+	node.children.clear();
+	node.loaded = true;
+	m_RowsDirty = true;
+
+	std::error_code ec;
+	for (fs::directory_iterator it(node.path, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+		std::error_code typeEc;
+		const bool isDirectory = it->is_directory(typeEc);
+		if (!isDirectory && !it->is_regular_file(typeEc))
+			continue;
+
+		std::string name = it->path().filename().string();
+		auto existing = previous.find(name);
+		if (existing != previous.end() && existing->second->isDirectory == isDirectory) {
+			node.children.push_back(std::move(existing->second));
+			continue;
+		}
+
+		auto child = std::make_unique<TreeNode>();
+		child->path = it->path();
+		child->sortKey = MakeSortKey(name);
+		child->name = std::move(name);
+		child->isDirectory = isDirectory;
+		child->parent = &node;
+		node.children.push_back(std::move(child));
+	}
+
+	if (ec)
+		LOG("[TreeView]: Failed to read {}: {}", core::Log::LogLevel::Warn, node.path, ec.message());
+
+	sortChildren(node);
+}
+
+void TreeView::applyChanges(const std::vector<core::FileChange>& changes)
+{
+	if (!m_Root)
+		return;
+
+	for (const auto& change : changes) {
+		// Only directories that were already read are kept in sync, the rest are read on expand
+		if (change.type == core::FileChangeType::Modified) {
+			TreeNode* node = findNode(change.path);
+			if (node && node->isDirectory && node->loaded)
+				loadChildren(*node); // polling fallback and queue overflows report changed directories
+			continue;
+		}
+
+		TreeNode* parent = findNode(change.path.parent_path());
+		if (!parent || !parent->loaded)
+			continue;
+
+		const std::string name = change.path.filename().string();
+		const std::string sortKey = MakeSortKey(name);
+		auto existing = FindChild(parent->children, name, sortKey);
+
+		if (change.type == core::FileChangeType::Removed) {
+			if (existing != parent->children.end()) {
+				parent->children.erase(existing);
+				m_RowsDirty = true;
+			}
+			continue;
+		}
+
+		std::error_code ec;
+		const bool isDirectory = fs::is_directory(change.path, ec);
+		if (!isDirectory && !fs::is_regular_file(change.path, ec))
+			continue;
+
+		if (existing != parent->children.end()) {
+			if ((*existing)->isDirectory == isDirectory)
+				continue;
+			parent->children.erase(existing);
+		}
+
+		auto child = std::make_unique<TreeNode>();
+		child->path = change.path;
+		child->name = name;
+		child->sortKey = sortKey;
+		child->isDirectory = isDirectory;
+		child->parent = parent;
+		auto position = LowerBound(parent->children, KeyOf(*child));
+		parent->children.insert(position, std::move(child));
+		m_RowsDirty = true;
+	}
+}
+
+// Walks the loaded part of the tree, nullptr if the path is outside the root or not loaded yet
+TreeNode* TreeView::findNode(const fs::path& path)
+{
+	auto pathIt = path.begin();
+	for (const auto& component : m_Root->path) {
+		if (pathIt == path.end() || *pathIt != component)
+			return nullptr;
+		++pathIt;
+	}
+
+	TreeNode* node = m_Root.get();
+	for (; pathIt != path.end() && node; ++pathIt) {
+		const std::string name = pathIt->string();
+		auto child = FindChild(node->children, name, MakeSortKey(name));
+		node = child != node->children.end() ? child->get() : nullptr;
+	}
+	return node;
+}
+
+void TreeView::sortChildren(TreeNode& node)
+{
+	std::sort(node.children.begin(), node.children.end(), [](const auto& a, const auto& b) {
+		return ComesBefore(KeyOf(*a), KeyOf(*b));
+	});
+}
+
+// Letters are lowercased. A run of digits becomes '0', the length of the run without leading
+// zeros and the digits, so shorter numbers sort first and equal lengths compare digit by digit.
+std::string TreeView::MakeSortKey(const std::string& name)
+{
+	std::string key;
+	key.reserve(name.size() + 4);
+
+	for (std::size_t i = 0; i < name.size();) {
+		const char c = name[i];
+		if (c < '0' || c > '9') {
+			key += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+			++i;
+			continue;
+		}
+
+		std::size_t end = i;
+		while (end < name.size() && name[end] >= '0' && name[end] <= '9')
+			++end;
+
+		std::size_t start = i;
+		while (start + 1 < end && name[start] == '0')
+			++start;
+
+		key += '0';
+		key += static_cast<char>(std::min<std::size_t>(end - start, 0x7f));
+		key.append(name, start, end - start);
+		i = end;
+	}
+	return key;
+}
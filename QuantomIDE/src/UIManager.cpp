@@ -1,609 +1,945 @@
-﻿#include "imgui.h"
-#include <imgui_internal.h>
-
-#include <Core.hpp>
-#include "UIManager.hpp"
-#include "BuildSystem.hpp"
-// For strncpy
-static bool showPopup = false;
-static bool projectOpen = false;
-static std::string boilerPlate =
-"#include <iostream>\n"
-"\n"
-"int main()\n"
-"{\n"
-"    std::cout << \"Hello world!\\n\";\n"
-"    return 0;\n"
-"}\n";
-
-
-static inline void DrawEditorTabs(EditorManager& editor, Project& p_Project) {
-	auto& tabBar = editor.getTabBar();
-	int tabCount = tabBar.getTabCount();
-
-	if (tabCount == 0) {
-		ImGui::Text("No files open.");
-		return;
-	}
-	ImGuiIO& io = ImGui::GetIO();
-	io.ConfigFlags &= ~ImGuiConfigFlags_NavEnableKeyboard; // temporarily disable keyboard navigation
-
-	if (ImGui::BeginTabBar("##EditorTabs", ImGuiTabBarFlags_Reorderable | ImGuiInputTextFlags_CallbackCharFilter)) {
-		for (int i = 0; i < tabCount; ++i) {
-			auto tab = tabBar.getTab(i);
-			if (!tab)
-				continue;
-
-			std::string tabLabel = tab->getTabName(); // Visible part
-			if (tab->getDocument().isDirty())
-				tabLabel += "*";
-
-			// Append unique ID (invisible) to avoid ImGui ID collisions
-			tabLabel += "##" + tab->getID();
-
-			if (ImGui::BeginTabItem(tabLabel.c_str())) {
-				auto& docText = tab->getDocument().getText();
-
-				static std::vector<char> buffer(1024 * 16, 0);
-				strncpy(buffer.data(), docText.c_str(), buffer.size() - 1);
-				buffer[buffer.size() - 1] = '\0';
-
-				if (tab->getFocusEditorNextFrame()) {
-					ImGui::SetKeyboardFocusHere();
-					tab->setFocusEditorNextFrame(false);
-				}
-
-				// Fill the remaining vertical space in the Editor window
-				ImVec2 availableSpace = ImGui::GetContentRegionAvail();
-
-
-				ImGuiInputTextFlags flags = ImGuiInputTextFlags_CallbackAlways;
-
-				std::string editorLabel = "##editor" + tab->getID();
-
-				if (ImGui::InputTextMultiline(editorLabel.c_str(), buffer.data(), buffer.size(),
-					availableSpace, flags,
-					[](ImGuiInputTextCallbackData* data) -> int {
-						Document* doc = static_cast<Document*>(data->UserData);
-						if (!doc) return 0;
-						ImGuiIO& io = ImGui::GetIO();
-						if (ImGui::IsKeyPressed(ImGuiKey_LeftBracket) && io.KeyShift)
-						{
-							const char ch = '}'; // character to insert
-							size_t pos = data->CursorPos;
-
-							// Shift buffer to make space for the char
-							if (data->BufTextLen + 1 < data->BufSize)
-							{
-								memmove(data->Buf + pos + 1, data->Buf + pos, strlen(data->Buf + pos) + 1);
-								data->Buf[pos] = ch;
-								data->CursorPos++;
-								data->BufTextLen++;
-								data->BufDirty = true;
-
-								// Optionally update your Document
-								Document* doc = static_cast<Document*>(data->UserData);
-								if (doc) doc->setText(std::string(data->Buf));
-
-								data->CursorPos -= 1;
-
-								return 1; // handled
-							}
-						}
-						if (ImGui::IsKeyPressed(ImGuiKey_9) && io.KeyShift)
-						{
-							const char ch = ')'; // character to insert
-							size_t pos = data->CursorPos;
-
-							// Shift buffer to make space for the char
-							if (data->BufTextLen + 1 < data->BufSize)
-							{
-								memmove(data->Buf + pos + 1, data->Buf + pos, strlen(data->Buf + pos) + 1);
-								data->Buf[pos] = ch;
-								data->CursorPos++;
-								data->BufTextLen++;
-								data->BufDirty = true;
-
-								// Optionally update your Document
-								Document* doc = static_cast<Document*>(data->UserData);
-								if (doc) doc->setText(std::string(data->Buf));
-
-								data->CursorPos -= 1;
-
-								return 1; // handled
-							}
-						}
-						// Check for TAB key pressed
-						if (data->EventFlag == ImGuiInputTextFlags_CallbackAlways &&
-							ImGui::IsKeyPressed(ImGuiKey_Tab))
-						{
-							const char tab[] = "    "; // 4 spaces
-							size_t pos = data->CursorPos;
-
-							// Insert tab into buffer
-							data->BufTextLen += 4; // increase text length
-							data->BufDirty = true;
-
-							// Shift buffer contents to make space for tab
-							if (data->BufTextLen < data->BufSize)
-							{
-								memmove(data->Buf + pos + 4, data->Buf + pos, strlen(data->Buf + pos) + 1);
-								memcpy(data->Buf + pos, tab, 4);
-								data->CursorPos += 4;
-							}
-
-							// Update Document
-							doc->setText(std::string(data->Buf));
-							doc->setCursorPos(data->CursorPos);
-
-							return 1; // event handled
-						}
-
-						// Always sync cursor position
-						doc->setCursorPos(data->CursorPos);
-
-						return 0;
-					}, &tab->getDocument()))
-				{
-					// If text changed normally (not TAB)
-					tab->getDocument().setText(std::string(buffer.data()));
-				}
-
-
-
-
-				ImGui::EndTabItem();
-			}
-
-			if (ImGui::IsItemHovered()) {
-				if (!tab->getFilePath().empty()) {
-					std::string filePath = tab->getFilePath().string();
-					ImGui::SetTooltip("File location: %s", filePath.c_str());
-				}
-			}
-
-			if (ImGui::IsItemClicked()) {
-				editor.getTabBar().setCurrentTabIndex(i);
-				LOG("%s", core::Log::LogLevel::Tracer, ("Tab " + std::to_string(i) + " has been clicked!").c_str());
-			}
-			if (ImGui::IsItemClicked(ImGuiMouseButton_Middle)) {
-				editor.getTabBar().closeTab(i);
-				std::cout << "Tab " << i << " (MMB) is clicked!\n";
-			}
-
-			if (ImGui::BeginPopupContextItem("customID_1")) {
-				if (ImGui::MenuItem("Add file to project")) {
-					if (p_Project.isOpen()) {
-						p_Project.addSourceFile(editor.getTabBar().getCurrentTab()->getFilePath());
-					}
-					else
-					{
-						std::cout << "No project is open\n";
-					}
-				}
-				if (ImGui::MenuItem("Compile")) {
-					// Handle compile
-				}
-				ImGui::EndPopup();
-			}
-		}
-		ImGui::EndTabBar();
-	}
-}
-
-
-static void DrawEditorDockspace(EditorManager& editor, Project& p_Project) {
-	ImGuiID dockspace_id = ImGui::GetID("MainEditorDockspace");
-
-	ImVec2 dockspace_size = ImGui::GetContentRegionAvail();
-	ImGui::DockSpace(dockspace_id, dockspace_size, ImGuiDockNodeFlags_None);
-
-	static bool initialized = false;
-	if (!initialized) {
-		initialized = true;
-
-		ImGui::DockBuilderRemoveNode(dockspace_id);
-		ImGui::DockBuilderAddNode(dockspace_id, ImGuiDockNodeFlags_DockSpace);
-		ImGui::DockBuilderSetNodeSize(dockspace_id, dockspace_size);
-
-		// Split into top (editor), bottom (console/output)
-		ImGuiID dock_main = ImGui::DockBuilderSplitNode(dockspace_id, ImGuiDir_Up, 0.7f, nullptr, &dockspace_id);
-		ImGuiID dock_bottom = ImGui::DockBuilderSplitNode(dockspace_id, ImGuiDir_Down, 0.3f, nullptr, &dockspace_id);
-
-		ImGui::DockBuilderDockWindow("Editor", dock_main);
-		ImGui::DockBuilderDockWindow("Console", dock_bottom);
-		ImGui::DockBuilderDockWindow("Output", dock_bottom);
-
-		ImGui::DockBuilderFinish(dockspace_id);
-	}
-
-
-	// Console window
-	ImGui::Begin("Console");
-
-	ImGui::Text("Console output here...");
-	ImGui::End();
-
-	// Output window
-	ImGui::Begin("Output");
-	ImGui::Text("Build output here...");
-	ImGui::End();
-
-	// Editor window
-	ImGui::Begin("Editor");
-	DrawEditorTabs(editor, p_Project);
-	ImGui::End();
-}
-
-void UIManager::drawEditor(EditorManager& editor, Project& p_Project) {
-	ImGuiID rootDockspaceID = ImGui::GetID("MyDockSpace"); // Must match Application::ShowMainDockSpace()
-
-	static bool initialized = false;
-	if (!initialized) {
-		initialized = true;
-
-		// Clean up any existing layout
-		ImGui::DockBuilderRemoveNode(rootDockspaceID);
-		ImGui::DockBuilderAddNode(rootDockspaceID, ImGuiDockNodeFlags_DockSpace);
-
-		// Set size (usually viewport size for fullscreen)
-		ImGui::DockBuilderSetNodeSize(rootDockspaceID, ImGui::GetMainViewport()->WorkSize);
-
-		// 1. Split into LEFT and RIGHT (left = 16% width)
-		ImGuiID dock_left = 0;
-		ImGuiID dock_right = 0;
-		ImGui::DockBuilderSplitNode(rootDockspaceID, ImGuiDir_Left, 0.16f, &dock_left, &dock_right);
-
-		ImGuiID dock_main = 0;
-		ImGuiID dock_status = 0;
-		ImGui::DockBuilderSplitNode(dock_right, ImGuiDir_Down, 0.07f, &dock_status, &dock_main);
-
-		// 2. Dock File Explorer and Project into LEFT dock (tabbed together)
-		ImGui::DockBuilderDockWindow("File Explorer", dock_left);
-		ImGui::DockBuilderDockWindow("Project", dock_left);
-
-		// 3. Dock Editor, Console, Output all into RIGHT dock (tabbed together)
-		ImGui::DockBuilderDockWindow("Editor", dock_main);
-		ImGui::DockBuilderDockWindow("Console", dock_main);
-		ImGui::DockBuilderDockWindow("Output", dock_main);
-		ImGui::DockBuilderDockWindow("Status", dock_status);
-
-		ImGui::DockBuilderFinish(rootDockspaceID);
-	}
-
-	// 🧱 Create docked windows
-	ImGui::Begin("Editor");
-	DrawEditorTabs(editor, p_Project);
-	ImGui::End();
-
-	ImGui::Begin("Console"); {
-		// Option 1: Read-only multiline with wrapping (better for logs)
-		ImGui::TextWrapped("%s", BuildSystem::s_ConsoleOutput.c_str());
-
-		// Option 2: Editable multiline text box (if you want it editable)
-		static std::string buffer;
-		buffer = BuildSystem::s_ConsoleOutput; // update buffer with latest output
-
-		// Create a char buffer (InputTextMultiline needs char*), static so it persists
-		static std::vector<char> charBuffer(1024 * 16, 0);
-		strncpy(charBuffer.data(), buffer.c_str(), charBuffer.size() - 1);
-		charBuffer[charBuffer.size() - 1] = '\0';
-
-		ImGui::End();
-	}
-
-	ImGui::Begin("Output");
-
-	// Option 1: Read-only multiline with wrapping (better for logs)
-	ImGui::TextWrapped("%s", BuildSystem::s_BuildOutput.c_str());
-
-	// Option 2: Editable multiline text box (if you want it editable)
-	static std::string buffer;
-	buffer = BuildSystem::s_BuildOutput; // update buffer with latest output
-
-	// Create a char buffer (InputTextMultiline needs char*), static so it persists
-	static std::vector<char> charBuffer(1024 * 16, 0);
-	strncpy(charBuffer.data(), buffer.c_str(), charBuffer.size() - 1);
-	charBuffer[charBuffer.size() - 1] = '\0';
-
-
-	ImGui::End();
-
-
-	ImGui::Begin("File Explorer");
-	ImGui::End();
-
-	ImGui::Begin("Project");
-	ImGui::End();
-}
-
-
-void UIManager::drawTreeView(TreeView& p_TreeView, Project& p_Project) {
-	ImGuiID dock_id = ImGui::GetID("MyDockSpace");
-	ImGui::SetNextWindowDockID(dock_id, ImGuiCond_FirstUseEver);
-
-	namespace fs = std::filesystem;
-	fs::path currentDir = fs::current_path();
-
-	ImGui::Begin("File Explorer");
-
-	// Recursive helper function defined inside the method
-	std::function<void(const fs::path&)> drawDirectory = [&](const fs::path& dirPath) {
-		for (const auto& entry : fs::directory_iterator(dirPath)) {
-			if (entry.is_directory()) {
-				if (ImGui::TreeNode(entry.path().filename().string().c_str())) {
-					drawDirectory(entry.path()); // recursive call
-					ImGui::TreePop();
-				}
-			}
-			else if (entry.is_regular_file()) {
-				const std::string filename = entry.path().filename().string();
-
-				if (ImGui::Selectable(filename.c_str())) {
-					// File was clicked — call your load file function here
-					//loadFile(entry.path());
-					//TODO load file into editor
-				}
-			}
-		}
-		};
-
-	drawDirectory(currentDir);
-
-	ImGui::End();
-
-	auto rootDir = p_Project.getRootDirectory();
-	const auto& sourceFiles = p_Project.getSourceFiles(); // relative paths
-	const auto& fileToFilter = p_Project.getFileFilters(); // path -> filter
-
-	std::unordered_map<std::string, std::vector<std::filesystem::path> > filesByFilter;
-	for (const auto& file : sourceFiles) {
-		auto it = fileToFilter.find(file);
-		std::string filter = (it != fileToFilter.end()) ? it->second : "Uncategorized";
-		filesByFilter[filter].push_back(file);
-	}
-
-	ImGui::SetNextWindowDockID(dock_id, ImGuiCond_FirstUseEver);
-	ImGui::Begin("Project");
-
-	for (const auto& filterName : { "sourceFiles", "Source Files", "Resource Files" }) {
-		ImGui::PushID(filterName);
-
-		bool open = ImGui::TreeNodeEx(filterName, ImGuiTreeNodeFlags_DefaultOpen);
-
-		ImGui::SameLine();
-
-
-		if (ImGui::Selectable("+", false, ImGuiSelectableFlags_DontClosePopups | ImGuiSelectableFlags_SpanAllColumns)) {
-			if (!(p_Project.isOpen())) {
-				projectOpen = true;
-			}
-			else {
-				extern core::Core g_Core;
-
-				if (g_Core.getFileSystem()->openFile().has_value() && !g_Core.getFileSystem()->openFile().value().empty()) {
-
-					std::filesystem::path selected = g_Core.getFileSystem()->openFile().value();
-					auto relPath = std::filesystem::relative(selected, rootDir);
-
-					if (filterName == std::string("Header Files"))
-						p_Project.addHeaderFile(selected);
-					else if (filterName == std::string("Source Files"))
-						p_Project.addSourceFile(selected);
-					else if (filterName == std::string("Resource Files"))
-						p_Project.addResourceFile(selected);
-				}
-			}
-		}
-
-		if (open) {
-			const std::vector<std::filesystem::path>& files = filesByFilter[filterName];
-			for (const auto& file : files) {
-				std::string filename = file.filename().string();
-				if (ImGui::Selectable(filename.c_str())) {
-					auto absPath = rootDir / file;
-					// loadFile(absPath);
-				}
-			}
-
-			ImGui::TreePop();
-		}
-
-		ImGui::PopID();
-	}
-
-	ImGui::End();
-
-
-	ImGui::End(); // end dockspace
-}
-
-void UIManager::drawMenuBar(MenuBar& menuBar, EditorManager& p_Editor, Project& p_Project) {
-	extern core::Core g_Core;
-
-	if (ImGui::BeginMainMenuBar()) {
-		// FILE MENU
-		if (ImGui::BeginMenu("File")) {
-			if (ImGui::MenuItem("New")) {
-				p_Editor.getTabBar().addTab(std::make_unique<EditorTab>(
-					std::string("Not saved " + std::to_string(p_Editor.getTabBar().getTabCount()))));
-				p_Editor.getTabBar().setCurrentTabIndex(p_Editor.getTabBar().getTabCount() - 1);
-			}
-
-			if (ImGui::MenuItem("Open")) {
-				auto selectedFile = g_Core.getFileSystem()->openFile(
-					"Text Files\0*.txt\0C++ Files\0*.cpp;*.h\0All Files\0*.*\0");
-				if (selectedFile.has_value()) {
-					std::fstream fileData(selectedFile.value(), std::ios::in);
-					std::string buffer;
-					fileData >> buffer;
-
-					if (!selectedFile.value().empty()) {
-						p_Editor.openFile(selectedFile.value().string());
-					}
-				}
-				else {
-					LOG("Warning: File open operation failed or was cancelled by user.", core::Log::LogLevel::Warn);
-				}
-			}
-
-			if (ImGui::MenuItem("Save")) {
-				const auto& tab = p_Editor.getTabBar().getCurrentTab();
-
-				if (!tab) {
-					std::cerr << "[Warning] Cannot save: No tab is open.\n";
-				}
-				else {
-					auto path = tab->save();
-					if (path.has_value()) {
-						tab->setFilePath(path.value());
-						tab->getDocument().markClean();
-					}
-					else {
-						LOG("Warning: File failed to save.", core::Log::LogLevel::Warn);
-					}
-				}
-			}
-
-			if (ImGui::MenuItem("Save As")) {
-				const auto& tab = p_Editor.getTabBar().getCurrentTab();
-				auto filePath = g_Core.getFileSystem()->saveFile(tab->getDocument().getText()).value();
-
-				if (!filePath.empty()) {
-					tab->setFilePath(filePath);
-					tab->setTabName(std::filesystem::path(filePath).filename().string());
-					g_Core.getFileSystem()->saveFile(tab->getDocument().getText(), tab->getFilePath());
-				}
-			}
-
-			ImGui::EndMenu(); // <-- closes File menu properly
-		}
-
-		// EDIT MENU
-		if (ImGui::BeginMenu("Edit")) {
-			if (ImGui::MenuItem("Undo")) {
-			}
-			if (ImGui::MenuItem("Redo")) {
-			}
-			ImGui::EndMenu();
-		}
-
-		// VIEW MENU
-		if (ImGui::BeginMenu("View")) {
-			//	ImGui::MenuItem("Show Console", NULL, &show_console_window);
-			//	ImGui::MenuItem("Show Inspector", NULL, &show_inspector_window);
-			ImGui::EndMenu();
-		}
-
-		// PROJECT MENU
-		if (ImGui::BeginMenu("Project")) {
-			if (ImGui::MenuItem("New")) {
-				showPopup = true; // will trigger popup next frame
-			}
-
-			if (ImGui::MenuItem("Open")) {
-				auto filePath = g_Core.getFileSystem()->openFile("Project Files\0*.qprj\0All Files\0*.*\0");
-
-				if (filePath.has_value()) {
-					if (p_Project.open(filePath.value())) {
-						p_Editor.getTabBar().closeAll();
-						for (auto& file : p_Project.getSourceFiles())
-							p_Editor.openFile(file.string());
-					}
-					else {
-						ImGui::OpenPopup("Error##ProjectOpen");
-					}
-				}
-				else {
-					LOG("Warning: Project Open operation failed or was cancelled by user.", core::Log::LogLevel::Warn);
-				}
-			}
-
-			if (ImGui::MenuItem("Save")) {
-				p_Project.save();
-			}
-
-			if (ImGui::MenuItem("Open Folder")) {
-				std::filesystem::path path = p_Project.getRootDirectory();
-				if (std::filesystem::exists(path)) {
-					std::string command = "explorer \"" + path.string() + "\"";
-					system(command.c_str());
-				}
-			}
-
-			ImGui::EndMenu();
-		}
-
-		ImGui::EndMainMenuBar();
-	}
-
-	if (projectOpen) {
-		ImGui::OpenPopup("Open a project to create a file");
-		projectOpen = false;
-	}
-
-	if (ImGui::BeginPopupModal("Open a project to create a file", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-		ImGui::Text("No project is opened.");
-		if (ImGui::Button("OK"))
-			ImGui::CloseCurrentPopup();
-
-		ImGui::EndPopup();
-	}
-
-	if (showPopup) {
-		ImGui::OpenPopup("New Project");
-		showPopup = false;
-	}
-
-	if (ImGui::BeginPopupModal("New Project", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-		static char projectName[128] = "";
-
-		ImGui::InputText("Project Name", projectName, IM_ARRAYSIZE(projectName));
-
-		if (ImGui::Button("OK", ImVec2(120, 0))) {
-			std::filesystem::path basePath = g_Core.getFileSystem()->openFolder().value();
-			if (!basePath.empty()) {
-				std::filesystem::path projectDir = basePath / projectName;
-				std::filesystem::create_directory(projectDir);
-				p_Editor.getTabBar().closeAll();
-				p_Project = Project{}; // Clear current
-				p_Project.createNew(projectDir, projectName);
-				p_Project.save();
-
-				// Create main.cpp inside project directory
-				std::filesystem::path mainFilePath = projectDir / (std::string(projectName) + ".cpp");
-				std::ofstream main(mainFilePath);
-				main << boilerPlate;
-				main.close();
-
-				p_Project.addSourceFile(mainFilePath);
-				p_Editor.openFile(mainFilePath.string());
-			}
-
-			ImGui::CloseCurrentPopup();
-			projectName[0] = '\0'; // Reset input
-		}
-
-
-		ImGui::SameLine();
-		if (ImGui::Button("Cancel", ImVec2(120, 0))) {
-			ImGui::CloseCurrentPopup();
-			projectName[0] = '\0'; // Reset input
-		}
-
-		ImGui::EndPopup();
-	}
-}
-
-void UIManager::drawStatusBar(StatusBar& statusBar, EditorManager& editor, Project& m_Project) {
-	ImGui::Begin("Status");
-	auto* tab = editor.getTabBar().getCurrentTab();
-	if (tab) {
-		auto [line, col] = tab->getDocument().getCursorPos();
-		ImGui::Text("Ln %d, Col %d | %s", static_cast<int>(line) + 1, static_cast<int>(col) + 1, tab->getTabName().c_str());
-	}
-	else {
-		ImGui::Text("No file open.");
-	}
-	ImGui::End();
-}
+﻿#include "imgui.h"
+#include <imgui_internal.h>
+
+#include <Core.hpp>
+#include "UIManager.hpp"
+#include "BuildSystem.hpp"
+#include "AppEvents.hpp"
+
+#include <cfloat>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+extern core::Core g_Core;
+// For strncpy
+static bool showPopup = false;
+static bool projectOpen = false;
+static std::string boilerPlate =
+"#include <iostream>\n"
+"\n"
+"int main()\n"
+"{\n"
+"    std::cout << \"Hello world!\\n\";\n"
+"    return 0;\n"
+"}\n";
+
+
+// File name of a path as a per-frame string. On POSIX the native string is already narrow and only the
+// name is copied into the frame arena, elsewhere it has to go through a converted temporary.
+static core::FrameString FrameFilename(const std::filesystem::path& path) {
+	if constexpr (std::is_same_v<std::filesystem::path::value_type, char>) {
+		std::string_view native = path.native();
+		const std::size_t separator = native.find_last_of('/');
+		if (separator != std::string_view::npos)
+			native.remove_prefix(separator + 1);
+		return core::FrameString(native, g_Core.getFrameArena());
+	}
+	else {
+		return core::FrameString(path.filename().string(), g_Core.getFrameArena());
+	}
+}
+
+// Path of a search result below the searched root as a per-frame string, like FrameFilename
+static core::FrameString FrameRelativePath(const std::filesystem::path& path, const std::filesystem::path& root) {
+	if constexpr (std::is_same_v<std::filesystem::path::value_type, char>) {
+		std::string_view native = path.native();
+		const std::string_view prefix = root.native();
+		if (!prefix.empty() && native.starts_with(prefix)) {
+			native.remove_prefix(prefix.size());
+			while (!native.empty() && native.front() == '/')
+				native.remove_prefix(1);
+		}
+		return core::FrameString(native, g_Core.getFrameArena());
+	}
+	else {
+		return core::FrameString(path.lexically_relative(root).string(), g_Core.getFrameArena());
+	}
+}
+
+// A tab whose file is still read on the thread pool, the first screen shows as soon as it arrives
+static void DrawFileLoad(const FileLoad& load) {
+	ImGui::ProgressBar(load.getProgress());
+	if (load.preview.empty()) {
+		ImGui::TextDisabled("Loading...");
+		return;
+	}
+	ImGui::BeginChild("##preview");
+	ImGui::TextUnformatted(load.preview.data(), load.preview.data() + load.preview.size());
+	ImGui::EndChild();
+}
+
+static inline void DrawEditorTabs(EditorManager& editor, Project& p_Project) {
+	auto& tabBar = editor.getTabBar();
+	int tabCount = tabBar.getTabCount();
+
+	if (tabCount == 0) {
+		ImGui::Text("No files open.");
+		return;
+	}
+	ImGuiIO& io = ImGui::GetIO();
+	io.ConfigFlags &= ~ImGuiConfigFlags_NavEnableKeyboard; // temporarily disable keyboard navigation
+
+	if (ImGui::BeginTabBar("##EditorTabs", ImGuiTabBarFlags_Reorderable | ImGuiInputTextFlags_CallbackCharFilter)) {
+		for (int i = 0; i < tabCount; ++i) {
+			auto tab = tabBar.getTab(i);
+			if (!tab)
+				continue;
+
+			core::FrameString tabLabel(tab->getTabName(), g_Core.getFrameArena()); // Visible part
+			if (tab->getDocument().isDirty())
+				tabLabel += "*";
+
+			// Append unique ID (invisible) to avoid ImGui ID collisions
+			tabLabel += "##";
+			tabLabel += tab->getID();
+
+			// A tab that wants the keyboard, e.g. one showing a search result, is brought to the front as well
+			const ImGuiTabItemFlags tabFlags = tab->getFocusEditorNextFrame() ? ImGuiTabItemFlags_SetSelected : ImGuiTabItemFlags_None;
+			const bool selected = ImGui::BeginTabItem(tabLabel.c_str(), nullptr, tabFlags);
+			if (selected && tab->isLoading()) {
+				DrawFileLoad(*tab->getLoad());
+				ImGui::EndTabItem();
+			}
+			else if (selected) {
+				auto& docText = tab->getDocument().getText();
+
+				static std::vector<char> buffer(1024 * 16, 0);
+				strncpy(buffer.data(), docText.c_str(), buffer.size() - 1);
+				buffer[buffer.size() - 1] = '\0';
+
+				if (tab->getFocusEditorNextFrame()) {
+					ImGui::SetKeyboardFocusHere();
+					tab->setFocusEditorNextFrame(false);
+				}
+
+				// Fill the remaining vertical space in the Editor window
+				ImVec2 availableSpace = ImGui::GetContentRegionAvail();
+
+
+				ImGuiInputTextFlags flags = ImGuiInputTextFlags_CallbackAlways;
+
+				core::FrameString editorLabel("##editor", g_Core.getFrameArena());
+				editorLabel += tab->getID();
+
+				if (ImGui::InputTextMultiline(editorLabel.c_str(), buffer.data(), buffer.size(),
+					availableSpace, flags,
+					[](ImGuiInputTextCallbackData* data) -> int {
+						Document* doc = static_cast<Document*>(data->UserData);
+						if (!doc) return 0;
+						ImGuiIO& io = ImGui::GetIO();
+						if (ImGui::IsKeyPressed(ImGuiKey_LeftBracket) && io.KeyShift)
+						{
+							const char ch = '}'; // character to insert
+							size_t pos = data->CursorPos;
+
+							// Shift buffer to make space for the char
+							if (data->BufTextLen + 1 < data->BufSize)
+							{
+								memmove(data->Buf + pos + 1, data->Buf + pos, strlen(data->Buf + pos) + 1);
+								data->Buf[pos] = ch;
+								data->CursorPos++;
+								data->BufTextLen++;
+								data->BufDirty = true;
+
+								// Optionally update your Document
+								Document* doc = static_cast<Document*>(data->UserData);
+								if (doc) doc->setText(std::string(data->Buf));
+
+								data->CursorPos -= 1;
+
+								return 1; // handled
+							}
+						}
+						if (ImGui::IsKeyPressed(ImGuiKey_9) && io.KeyShift)
+						{
+							const char ch = ')'; // character to insert
+							size_t pos = data->CursorPos;
+
+							// Shift buffer to make space for the char
+							if (data->BufTextLen + 1 < data->BufSize)
+							{
+								memmove(data->Buf + pos + 1, data->Buf + pos, strlen(data->Buf + pos) + 1);
+								data->Buf[pos] = ch;
+								data->CursorPos++;
+								data->BufTextLen++;
+								data->BufDirty = true;
+
+								// Optionally update your Document
+								Document* doc = static_cast<Document*>(data->UserData);
+								if (doc) doc->setText(std::string(data->Buf));
+
+								data->CursorPos -= 1;
+
+								return 1; // handled
+							}
+						}
+						// Check for TAB key pressed
+						if (data->EventFlag == ImGuiInputTextFlags_CallbackAlways &&
+							ImGui::IsKeyPressed(ImGuiKey_Tab))
+						{
+							const char tab[] = "    "; // 4 spaces
+							size_t pos = data->CursorPos;
+
+							// Insert tab into buffer
+							data->BufTextLen += 4; // increase text length
+							data->BufDirty = true;
+
+							// Shift buffer contents to make space for tab
+							if (data->BufTextLen < data->BufSize)
+							{
+								memmove(data->Buf + pos + 4, data->Buf + pos, strlen(data->Buf + pos) + 1);
+								memcpy(data->Buf + pos, tab, 4);
+								data->CursorPos += 4;
+							}
+
+							// Update Document
+							doc->setText(std::string(data->Buf));
+							doc->setCursorPos(data->CursorPos);
+
+							return 1; // event handled
+						}
+
+						// Always sync cursor position
+						doc->setCursorPos(data->CursorPos);
+
+						return 0;
+					}, &tab->getDocument()))
+				{
+					// If text changed normally (not TAB)
+					tab->getDocument().setText(std::string(buffer.data()));
+				}
+
+
+
+
+				ImGui::EndTabItem();
+			}
+
+			if (ImGui::IsItemHovered()) {
+				if (!tab->getFilePath().empty()) {
+					std::string filePath = tab->getFilePath().string();
+					ImGui::SetTooltip("File location: %s", filePath.c_str());
+				}
+			}
+
+			if (ImGui::IsItemClicked()) {
+				editor.getTabBar().setCurrentTabIndex(i);
+				LOG("Tab {} has been clicked!", core::Log::LogLevel::Tracer, i);
+			}
+			if (ImGui::IsItemClicked(ImGuiMouseButton_Middle)) {
+				editor.getTabBar().closeTab(i);
+				std::cout << "Tab " << i << " (MMB) is clicked!\n";
+			}
+
+			if (ImGui::BeginPopupContextItem("customID_1")) {
+				if (ImGui::MenuItem("Add file to project")) {
+					if (p_Project.isOpen()) {
+						p_Project.addSourceFile(editor.getTabBar().getCurrentTab()->getFilePath());
+					}
+					else
+					{
+						std::cout << "No project is open\n";
+					}
+				}
+				if (ImGui::MenuItem("Compile")) {
+					// Handle compile
+				}
+				ImGui::EndPopup();
+			}
+		}
+		ImGui::EndTabBar();
+	}
+}
+
+
+static void DrawTimingTable(const char* id, const char* label, const std::vector<BuildTimingEntry>& entries, bool showQueueWait) {
+	ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable;
+	if (!ImGui::BeginTable(id, showQueueWait ? 3 : 2, flags))
+		return;
+
+	ImGui::TableSetupColumn(label, ImGuiTableColumnFlags_WidthStretch);
+	ImGui::TableSetupColumn("Time (ms)", ImGuiTableColumnFlags_WidthFixed);
+	if (showQueueWait)
+		ImGui::TableSetupColumn("Queued (ms)", ImGuiTableColumnFlags_WidthFixed);
+	ImGui::TableHeadersRow();
+
+	for (const auto& entry : entries) {
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(entry.name.c_str());
+		ImGui::TableNextColumn();
+		ImGui::Text("%.1f", entry.milliseconds);
+		if (showQueueWait) {
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", entry.queueMilliseconds);
+		}
+	}
+	ImGui::EndTable();
+}
+
+static void DrawBuildTimings(const BuildSummary* summary) {
+	if (!summary) {
+		ImGui::Text("No build timings yet.");
+		return;
+	}
+
+	ImGui::Text("Last build: %.1f ms", summary->totalMilliseconds);
+	ImGui::TextWrapped("Trace: %s", summary->traceFile.string().c_str());
+	ImGui::Separator();
+
+	ImGui::Text("Slowest translation units");
+	DrawTimingTable("##SlowestUnits", "Translation unit", summary->slowestUnits, true);
+
+	ImGui::Spacing();
+	ImGui::Text("Slowest headers");
+	if (summary->slowestHeaders.empty())
+		ImGui::TextWrapped("No header timings, they are only available when building with clang (-ftime-trace).");
+	else
+		DrawTimingTable("##SlowestHeaders", "Header", summary->slowestHeaders, false);
+}
+
+static void DrawEditorDockspace(EditorManager& editor, Project& p_Project) {
+	ImGuiID dockspace_id = ImGui::GetID("MainEditorDockspace");
+
+	ImVec2 dockspace_size = ImGui::GetContentRegionAvail();
+	ImGui::DockSpace(dockspace_id, dockspace_size, ImGuiDockNodeFlags_None);
+
+	static bool initialized = false;
+	if (!initialized) {
+		initialized = true;
+
+		ImGui::DockBuilderRemoveNode(dockspace_id);
+		ImGui::DockBuilderAddNode(dockspace_id, ImGuiDockNodeFlags_DockSpace);
+		ImGui::DockBuilderSetNodeSize(dockspace_id, dockspace_size);
+
+		// Split into top (editor), bottom (console/output)
+		ImGuiID dock_main = ImGui::DockBuilderSplitNode(dockspace_id, ImGuiDir_Up, 0.7f, nullptr, &dockspace_id);
+		ImGuiID dock_bottom = ImGui::DockBuilderSplitNode(dockspace_id, ImGuiDir_Down, 0.3f, nullptr, &dockspace_id);
+
+		ImGui::DockBuilderDockWindow("Editor", dock_main);
+		ImGui::DockBuilderDockWindow("Console", dock_bottom);
+		ImGui::DockBuilderDockWindow("Output", dock_bottom);
+
+		ImGui::DockBuilderFinish(dockspace_id);
+	}
+
+
+	// Console window
+	ImGui::Begin("Console");
+
+	ImGui::Text("Console output here...");
+	ImGui::End();
+
+	// Output window
+	ImGui::Begin("Output");
+	ImGui::Text("Build output here...");
+	ImGui::End();
+
+	// Editor window
+	ImGui::Begin("Editor");
+	DrawEditorTabs(editor, p_Project);
+	ImGui::End();
+}
+
+UIManager::UIManager()
+{
+	m_BuildFinishedSubscription = g_Core.getEventBus()->subscribe<BuildFinished>([this](const BuildFinished& event) {
+		m_BuildOutput = event.output;
+		m_LastBuildSummary = event.summary;
+	});
+	m_TraceCapturedSubscription = g_Core.getEventBus()->subscribe<TraceCaptured>([this](const TraceCaptured& event) {
+		m_TraceNotice = (event.written ? "Trace written to " : "Failed to write trace ") + event.file.string();
+		m_TraceNoticeUntil = ImGui::GetTime() + 10.0;
+	});
+}
+
+UIManager::~UIManager()
+{
+	g_Core.getEventBus()->unsubscribe(m_BuildFinishedSubscription);
+	g_Core.getEventBus()->unsubscribe(m_TraceCapturedSubscription);
+}
+
+void UIManager::drawEditor(EditorManager& editor, Project& p_Project) {
+	PROFILE_ZONE("UIManager::drawEditor");
+	ImGuiID rootDockspaceID = ImGui::GetID("MyDockSpace"); // Must match Application::ShowMainDockSpace()
+
+	static bool initialized = false;
+	if (!initialized) {
+		initialized = true;
+
+		// Clean up any existing layout
+		ImGui::DockBuilderRemoveNode(rootDockspaceID);
+		ImGui::DockBuilderAddNode(rootDockspaceID, ImGuiDockNodeFlags_DockSpace);
+
+		// Set size (usually viewport size for fullscreen)
+		ImGui::DockBuilderSetNodeSize(rootDockspaceID, ImGui::GetMainViewport()->WorkSize);
+
+		// 1. Split into LEFT and RIGHT (left = 16% width)
+		ImGuiID dock_left = 0;
+		ImGuiID dock_right = 0;
+		ImGui::DockBuilderSplitNode(rootDockspaceID, ImGuiDir_Left, 0.16f, &dock_left, &dock_right);
+
+		ImGuiID dock_main = 0;
+		ImGuiID dock_status = 0;
+		ImGui::DockBuilderSplitNode(dock_right, ImGuiDir_Down, 0.07f, &dock_status, &dock_main);
+
+		// 2. Dock File Explorer and Project into LEFT dock (tabbed together)
+		ImGui::DockBuilderDockWindow("File Explorer", dock_left);
+		ImGui::DockBuilderDockWindow("Project", dock_left);
+
+		// 3. Dock Editor, Console, Output all into RIGHT dock (tabbed together)
+		ImGui::DockBuilderDockWindow("Editor", dock_main);
+		ImGui::DockBuilderDockWindow("Console", dock_main);
+		ImGui::DockBuilderDockWindow("Output", dock_main);
+		ImGui::DockBuilderDockWindow("Build Timings", dock_main);
+		ImGui::DockBuilderDockWindow("Performance", dock_main);
+		ImGui::DockBuilderDockWindow("Status", dock_status);
+
+		ImGui::DockBuilderFinish(rootDockspaceID);
+	}
+
+	// 🧱 Create docked windows
+	ImGui::Begin("Editor");
+	DrawEditorTabs(editor, p_Project);
+	ImGui::End();
+
+	ImGui::Begin("Console"); {
+		// Option 1: Read-only multiline with wrapping (better for logs)
+		ImGui::TextWrapped("%s", BuildSystem::s_ConsoleOutput.c_str());
+
+		// Option 2: Editable multiline text box (if you want it editable)
+		static std::string buffer;
+		buffer = BuildSystem::s_ConsoleOutput; // update buffer with latest output
+
+		// Create a char buffer (InputTextMultiline needs char*), static so it persists
+		static std::vector<char> charBuffer(1024 * 16, 0);
+		strncpy(charBuffer.data(), buffer.c_str(), charBuffer.size() - 1);
+		charBuffer[charBuffer.size() - 1] = '\0';
+
+		ImGui::End();
+	}
+
+	ImGui::Begin("Output");
+
+	// Option 1: Read-only multiline with wrapping (better for logs)
+	ImGui::TextWrapped("%s", m_BuildOutput.c_str());
+
+	// Option 2: Editable multiline text box (if you want it editable)
+	static std::string buffer;
+	buffer = m_BuildOutput; // update buffer with latest output
+
+	// Create a char buffer (InputTextMultiline needs char*), static so it persists
+	static std::vector<char> charBuffer(1024 * 16, 0);
+	strncpy(charBuffer.data(), buffer.c_str(), charBuffer.size() - 1);
+	charBuffer[charBuffer.size() - 1] = '\0';
+
+
+	ImGui::End();
+
+	ImGui::Begin("Build Timings");
+	DrawBuildTimings(m_LastBuildSummary.get());
+	ImGui::End();
+
+	ImGui::Begin("File Explorer");
+	ImGui::End();
+
+	ImGui::Begin("Project");
+	ImGui::End();
+}
+
+
+void UIManager::drawTreeView(TreeView& p_TreeView, Project& p_Project) {
+	PROFILE_ZONE("UIManager::drawTreeView");
+	ImGuiID dock_id = ImGui::GetID("MyDockSpace");
+	ImGui::SetNextWindowDockID(dock_id, ImGuiCond_FirstUseEver);
+
+	if (!p_TreeView.getRootNode())
+		p_TreeView.setRoot(std::filesystem::current_path());
+
+	ImGui::Begin("File Explorer");
+
+	// Only the rows on screen are submitted, the flattened list changes on expand/collapse only
+	const auto& rows = p_TreeView.getVisibleRows();
+	const float indent = ImGui::GetTreeNodeToLabelSpacing();
+
+	ImGuiListClipper clipper;
+	clipper.Begin(static_cast<int>(rows.size()));
+	while (clipper.Step()) {
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+			TreeNode& node = *rows[i].node;
+			if (rows[i].depth > 0)
+				ImGui::Indent(rows[i].depth * indent);
+
+			if (node.isDirectory) {
+				ImGui::SetNextItemOpen(node.expanded);
+				ImGui::TreeNodeEx(&node, ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth, "%s", node.name.c_str());
+				if (ImGui::IsItemToggledOpen())
+					p_TreeView.setExpanded(node, !node.expanded); // rows are rebuilt next frame
+			}
+			else {
+				ImGui::TreeNodeEx(&node, ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth, "%s", node.name.c_str());
+				if (ImGui::IsItemClicked()) {
+					// File was clicked — call your load file function here
+					//loadFile(node.path);
+					//TODO load file into editor
+				}
+			}
+
+			if (rows[i].depth > 0)
+				ImGui::Unindent(rows[i].depth * indent);
+		}
+	}
+	clipper.End();
+
+	ImGui::End();
+
+	auto rootDir = p_Project.getRootDirectory();
+	const auto& sourceFiles = p_Project.getSourceFiles(); // relative paths
+	const auto& fileToFilter = p_Project.getFileFilters(); // path -> filter
+
+	// Rebuilt every frame, so it lives in the frame arena and only points into the project
+	std::pmr::unordered_map<std::string_view, core::FrameVector<const std::filesystem::path*> > filesByFilter(g_Core.getFrameArena());
+	for (const auto& file : sourceFiles) {
+		auto it = fileToFilter.find(file);
+		std::string_view filter = (it != fileToFilter.end()) ? std::string_view(it->second) : std::string_view("Uncategorized");
+		filesByFilter.try_emplace(filter).first->second.push_back(&file);
+	}
+
+	ImGui::SetNextWindowDockID(dock_id, ImGuiCond_FirstUseEver);
+	ImGui::Begin("Project");
+
+	// Added after the loop: adding to the project may move the paths filesByFilter points to
+	std::string_view addToFilter;
+	std::filesystem::path fileToAdd;
+
+	for (const auto& filterName : { "sourceFiles", "Source Files", "Resource Files" }) {
+		ImGui::PushID(filterName);
+
+		bool open = ImGui::TreeNodeEx(filterName, ImGuiTreeNodeFlags_DefaultOpen);
+
+		ImGui::SameLine();
+
+
+		if (ImGui::Selectable("+", false, ImGuiSelectableFlags_DontClosePopups | ImGuiSelectableFlags_SpanAllColumns)) {
+			if (!(p_Project.isOpen())) {
+				projectOpen = true;
+			}
+			else {
+				extern core::Core g_Core;
+
+				if (g_Core.getFileSystem()->openFile().has_value() && !g_Core.getFileSystem()->openFile().value().empty()) {
+
+					addToFilter = filterName;
+					fileToAdd = g_Core.getFileSystem()->openFile().value();
+				}
+			}
+		}
+
+		if (open) {
+			const auto& files = filesByFilter[filterName];
+			for (const std::filesystem::path* file : files) {
+				core::FrameString filename = FrameFilename(*file);
+				if (ImGui::Selectable(filename.c_str())) {
+					auto absPath = rootDir / *file;
+					// loadFile(absPath);
+				}
+			}
+
+			ImGui::TreePop();
+		}
+
+		ImGui::PopID();
+	}
+
+	if (!fileToAdd.empty()) {
+		if (addToFilter == "Header Files")
+			p_Project.addHeaderFile(fileToAdd);
+		else if (addToFilter == "Source Files")
+			p_Project.addSourceFile(fileToAdd);
+		else if (addToFilter == "Resource Files")
+			p_Project.addResourceFile(fileToAdd);
+	}
+
+	ImGui::End();
+
+
+	ImGui::End(); // end dockspace
+}
+
+void UIManager::drawMenuBar(MenuBar& menuBar, EditorManager& p_Editor, Project& p_Project) {
+	PROFILE_ZONE("UIManager::drawMenuBar");
+	extern core::Core g_Core;
+
+	if (ImGui::BeginMainMenuBar()) {
+		// FILE MENU
+		if (ImGui::BeginMenu("File")) {
+			if (ImGui::MenuItem("New")) {
+				p_Editor.getTabBar().addTab(std::make_unique<EditorTab>(
+					std::string("Not saved " + std::to_string(p_Editor.getTabBar().getTabCount()))));
+				p_Editor.getTabBar().setCurrentTabIndex(p_Editor.getTabBar().getTabCount() - 1);
+			}
+
+			if (ImGui::MenuItem("Open")) {
+				auto selectedFile = g_Core.getFileSystem()->openFile(
+					"Text Files\0*.txt\0C++ Files\0*.cpp;*.h\0All Files\0*.*\0");
+				if (selectedFile.has_value()) {
+					if (!selectedFile.value().empty()) {
+						p_Editor.openFile(selectedFile.value().string());
+					}
+				}
+				else {
+					LOG("Warning: File open operation failed or was cancelled by user.", core::Log::LogLevel::Warn);
+				}
+			}
+
+			if (ImGui::MenuItem("Save")) {
+				const auto& tab = p_Editor.getTabBar().getCurrentTab();
+
+				if (!tab) {
+					std::cerr << "[Warning] Cannot save: No tab is open.\n";
+				}
+				else {
+					auto path = tab->save();
+					if (path.has_value()) {
+						tab->setFilePath(path.value());
+						tab->getDocument().markClean();
+					}
+					else {
+						LOG("Warning: File failed to save.", core::Log::LogLevel::Warn);
+					}
+				}
+			}
+
+			if (ImGui::MenuItem("Save As")) {
+				const auto& tab = p_Editor.getTabBar().getCurrentTab();
+				auto filePath = g_Core.getFileSystem()->saveFile(tab->getDocument().getText(), {}, tab->getDocument().getSaveEncoding()).value();
+
+				if (!filePath.empty()) {
+					tab->setFilePath(filePath);
+					tab->setTabName(std::filesystem::path(filePath).filename().string());
+					g_Core.getFileSystem()->saveFile(tab->getDocument().getText(), tab->getFilePath(), tab->getDocument().getSaveEncoding());
+				}
+			}
+
+			ImGui::EndMenu(); // <-- closes File menu properly
+		}
+
+		// EDIT MENU
+		if (ImGui::BeginMenu("Edit")) {
+			if (ImGui::MenuItem("Undo")) {
+			}
+			if (ImGui::MenuItem("Redo")) {
+			}
+			ImGui::EndMenu();
+		}
+
+		// VIEW MENU
+		if (ImGui::BeginMenu("View")) {
+			//	ImGui::MenuItem("Show Console", NULL, &show_console_window);
+			//	ImGui::MenuItem("Show Inspector", NULL, &show_inspector_window);
+			ImGui::MenuItem("Performance", nullptr, &m_ShowPerformance);
+			if (ImGui::MenuItem("Find in Files", "Ctrl+Shift+F"))
+				showFindInFiles();
+			ImGui::EndMenu();
+		}
+
+		// PROJECT MENU
+		if (ImGui::BeginMenu("Project")) {
+			if (ImGui::MenuItem("New")) {
+				showPopup = true; // will trigger popup next frame
+			}
+
+			if (ImGui::MenuItem("Open")) {
+				auto filePath = g_Core.getFileSystem()->openFile("Project Files\0*.qprj\0All Files\0*.*\0");
+
+				if (filePath.has_value()) {
+					if (p_Project.open(filePath.value())) {
+						p_Editor.getTabBar().closeAll();
+						for (auto& file : p_Project.getSourceFiles())
+							p_Editor.openFile(file.string());
+					}
+					else {
+						ImGui::OpenPopup("Error##ProjectOpen");
+					}
+				}
+				else {
+					LOG("Warning: Project Open operation failed or was cancelled by user.", core::Log::LogLevel::Warn);
+				}
+			}
+
+			if (ImGui::MenuItem("Save")) {
+				p_Project.save();
+			}
+
+			bool unityBuild = p_Project.isUnityBuild();
+			if (ImGui::MenuItem("Unity Build", nullptr, &unityBuild, p_Project.isOpen())) {
+				p_Project.setUnityBuild(unityBuild);
+			}
+
+			// 0 batches is one per hardware thread
+			if (ImGui::BeginMenu("Unity Batches", p_Project.isOpen() && p_Project.isUnityBuild())) {
+				if (ImGui::MenuItem("One per hardware thread", nullptr, p_Project.getUnityBatchCount() == 0))
+					p_Project.setUnityBatchCount(0);
+				int batchCount = p_Project.getUnityBatchCount();
+				if (ImGui::InputInt("Batches", &batchCount))
+					p_Project.setUnityBatchCount(batchCount);
+				ImGui::EndMenu();
+			}
+
+			if (ImGui::BeginMenu("Profile", p_Project.isOpen())) {
+				for (BuildProfile profile : { BuildProfile::Debug, BuildProfile::Release, BuildProfile::ASan }) {
+					if (ImGui::MenuItem(to_string(profile), nullptr, p_Project.getBuildProfile() == profile))
+						p_Project.setBuildProfile(profile);
+				}
+				ImGui::EndMenu();
+			}
+
+			if (ImGui::MenuItem("Open Folder")) {
+				std::filesystem::path path = p_Project.getRootDirectory();
+				if (std::filesystem::exists(path)) {
+					std::string command = "explorer \"" + path.string() + "\"";
+					system(command.c_str());
+				}
+			}
+
+			ImGui::EndMenu();
+		}
+
+		ImGui::EndMainMenuBar();
+	}
+
+	if (projectOpen) {
+		ImGui::OpenPopup("Open a project to create a file");
+		projectOpen = false;
+	}
+
+	if (ImGui::BeginPopupModal("Open a project to create a file", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+		ImGui::Text("No project is opened.");
+		if (ImGui::Button("OK"))
+			ImGui::CloseCurrentPopup();
+
+		ImGui::EndPopup();
+	}
+
+	if (showPopup) {
+		ImGui::OpenPopup("New Project");
+		showPopup = false;
+	}
+
+	if (ImGui::BeginPopupModal("New Project", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+		static char projectName[128] = "";
+
+		ImGui::InputText("Project Name", projectName, IM_ARRAYSIZE(projectName));
+
+		if (ImGui::Button("OK", ImVec2(120, 0))) {
+			std::filesystem::path basePath = g_Core.getFileSystem()->openFolder().value();
+			if (!basePath.empty()) {
+				std::filesystem::path projectDir = basePath / projectName;
+				std::filesystem::create_directory(projectDir);
+				p_Editor.getTabBar().closeAll();
+				p_Project = Project{}; // Clear current
+				p_Project.createNew(projectDir, projectName);
+				p_Project.save();
+
+				// Create main.cpp inside project directory
+				std::filesystem::path mainFilePath = projectDir / (std::string(projectName) + ".cpp");
+				std::ofstream main(mainFilePath);
+				main << boilerPlate;
+				main.close();
+
+				p_Project.addSourceFile(mainFilePath);
+				p_Editor.openFile(mainFilePath.string());
+			}
+
+			ImGui::CloseCurrentPopup();
+			projectName[0] = '\0'; // Reset input
+		}
+
+
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+			ImGui::CloseCurrentPopup();
+			projectName[0] = '\0'; // Reset input
+		}
+
+		ImGui::EndPopup();
+	}
+}
+
+void UIManager::drawStatusBar(StatusBar& statusBar, EditorManager& editor, Project& m_Project) {
+	PROFILE_ZONE("UIManager::drawStatusBar");
+	ImGui::Begin("Status");
+	auto* tab = editor.getTabBar().getCurrentTab();
+	if (tab) {
+		auto [line, col] = tab->getDocument().getCursorPos();
+		ImGui::Text("Ln %d, Col %d | %s", static_cast<int>(line) + 1, static_cast<int>(col) + 1, tab->getTabName().c_str());
+	}
+	else {
+		ImGui::Text("No file open.");
+	}
+	if (!m_TraceNotice.empty() && ImGui::GetTime() < m_TraceNoticeUntil) {
+		ImGui::SameLine();
+		ImGui::TextDisabled("| %s", m_TraceNotice.c_str());
+	}
+	ImGui::End();
+}
+
+void UIManager::drawPerformance(PerformanceMonitor& monitor, const LSPClient& lsp) {
+	if (!m_ShowPerformance)
+		return;
+
+	// Begin is false while the window is a hidden tab or collapsed, then the profiler is not read at all
+	if (!ImGui::Begin("Performance", &m_ShowPerformance)) {
+		ImGui::End();
+		return;
+	}
+	PROFILE_ZONE("UIManager::drawPerformance");
+	monitor.update(lsp.getPendingRequestCount());
+
+	const std::vector<float>& frames = monitor.getFrameTimes();
+	const PerformanceMonitor::Percentiles& percentiles = monitor.getFramePercentiles();
+	const float last = frames.empty() ? 0.0f : frames.back();
+
+	ImGui::Text("Frame %.2f ms (%.0f FPS)", last, last > 0.0f ? 1000.0f / last : 0.0f);
+	ImGui::SameLine();
+	ImGui::TextDisabled("p50 %.2f  p95 %.2f  p99 %.2f ms", percentiles.p50, percentiles.p95, percentiles.p99);
+	ImGui::PlotLines("##FrameTimes", frames.data(), static_cast<int>(frames.size()), 0, "frame time (ms)",
+		0.0f, std::max(33.4f, percentiles.p99 * 1.2f), ImVec2(-1.0f, 60.0f));
+
+	const std::vector<float>& histogram = monitor.getFrameHistogram();
+	ImGui::PlotHistogram("##FrameHistogram", histogram.data(), static_cast<int>(histogram.size()), 0,
+		"frames per 1 ms bucket", 0.0f, FLT_MAX, ImVec2(-1.0f, 60.0f));
+
+	const PerformanceMonitor::Snapshot& snapshot = monitor.getSnapshot();
+	ImGui::Separator();
+	ImGui::Text("Thread pool: %.0f%% of %zu workers busy", snapshot.poolUtilisation * 100.0, snapshot.poolThreads);
+	ImGui::Text("LSP requests pending: %zu", snapshot.lspPendingRequests);
+	ImGui::Text("Frame arena: %zu allocations, %.1f KB last frame", snapshot.frameAllocations, static_cast<double>(snapshot.frameBytes) / 1024.0);
+	ImGui::Text("Memory pool: %zu blocks in use", snapshot.memoryPoolBlocksInUse);
+
+	ImGui::Separator();
+	if (ImGui::BeginTable("##Zones", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable)) {
+		ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("ms / frame", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableSetupColumn("Max (ms)", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed);
+		ImGui::TableHeadersRow();
+
+		for (const auto& zone : snapshot.zones) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(zone.site->name);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", zone.millisecondsPerFrame);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", zone.maxMilliseconds);
+			ImGui::TableNextColumn();
+			ImGui::Text("%zu", zone.calls);
+		}
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+}
+
+void UIManager::showFindInFiles() {
+	m_ShowFindInFiles = true;
+	m_FocusFindPattern = true;
+}
+
+// Only the rows in view are drawn, so a search with a hundred thousand matches costs what a screenful does
+void UIManager::drawFindInFiles(FindInFiles& search, EditorManager& editor, Project& project) {
+	if (!m_ShowFindInFiles)
+		return;
+
+	if (m_FocusFindPattern)
+		ImGui::SetNextWindowFocus();
+	if (!ImGui::Begin("Find in Files", &m_ShowFindInFiles)) {
+		ImGui::End();
+		return;
+	}
+	PROFILE_ZONE("UIManager::drawFindInFiles");
+
+	if (m_FocusFindPattern) {
+		ImGui::SetKeyboardFocusHere();
+		m_FocusFindPattern = false;
+	}
+	bool submit = ImGui::InputText("##FindPattern", m_FindPattern, sizeof(m_FindPattern), ImGuiInputTextFlags_EnterReturnsTrue);
+	ImGui::SameLine();
+	ImGui::Checkbox("Regex", &m_FindRegex);
+	ImGui::SameLine();
+	ImGui::Checkbox("Match case", &m_FindCaseSensitive);
+	ImGui::SameLine();
+	if (search.isRunning()) {
+		if (ImGui::Button("Cancel"))
+			search.cancel();
+	}
+	else {
+		submit |= ImGui::Button("Search");
+	}
+
+	if (submit && m_FindPattern[0] != '\0') {
+		const std::filesystem::path root = project.isOpen() ? project.getRootDirectory() : std::filesystem::current_path();
+		search.start(root, m_FindPattern, core::SearchOptions{ m_FindRegex, m_FindCaseSensitive });
+	}
+
+	if (!search.getError().empty()) {
+		ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", search.getError().c_str());
+	}
+	else if (search.isRunning() || !search.getRows().empty() || search.getSearchedFileCount() > 0) {
+		ImGui::Text("%zu matches in %zu files", search.getMatchCount(), search.getFiles().size());
+		ImGui::SameLine();
+		ImGui::TextDisabled("%zu files, %.1f MB searched in %.2f s%s", search.getSearchedFileCount(),
+			static_cast<double>(search.getSearchedByteCount()) / (1024.0 * 1024.0), search.getElapsedSeconds(),
+			search.isRunning() ? "..." : search.isTruncated() ? ", stopped at the match limit" : "");
+	}
+
+	ImGui::Separator();
+	ImGui::BeginChild("##FindResults");
+
+	const ImVec4 pathColor(0.55f, 0.75f, 1.0f, 1.0f);
+	const ImVec4 matchColor(1.0f, 0.8f, 0.3f, 1.0f);
+	const std::vector<FindInFiles::Row>& rows = search.getRows();
+	const std::vector<core::FileSearch::FileResult>& files = search.getFiles();
+
+	ImGuiListClipper clipper;
+	clipper.Begin(static_cast<int>(rows.size()));
+	while (clipper.Step()) {
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+			const FindInFiles::Row& row = rows[static_cast<std::size_t>(i)];
+			const core::FileSearch::FileResult& file = files[row.file];
+
+			if (row.line == FindInFiles::FileRow) {
+				const core::FrameString path = FrameRelativePath(file.path, search.getRoot());
+				ImGui::TextColored(pathColor, "%s", path.c_str());
+				ImGui::SameLine();
+				ImGui::TextDisabled("%zu%s", file.lines.size(), file.truncated ? "+" : "");
+				continue;
+			}
+
+			// Line number, then the line with its match highlighted
+			const core::FileSearch::LineResult& line = file.lines[row.line];
+			const std::string& preview = line.preview;
+			const std::size_t matchBegin = std::min(line.previewColumn, preview.size());
+			const std::size_t matchEnd = std::min(matchBegin + line.length, preview.size());
+
+			ImGui::BeginGroup();
+			ImGui::TextDisabled("%6zu", line.line + 1);
+			ImGui::SameLine();
+			ImGui::TextUnformatted(preview.data(), preview.data() + matchBegin);
+			ImGui::SameLine(0.0f, 0.0f);
+			ImGui::TextColored(matchColor, "%.*s", static_cast<int>(matchEnd - matchBegin), preview.data() + matchBegin);
+			ImGui::SameLine(0.0f, 0.0f);
+			ImGui::TextUnformatted(preview.data() + matchEnd, preview.data() + preview.size());
+			ImGui::EndGroup();
+
+			if (ImGui::IsItemClicked())
+				editor.showLocation(file.path, line.line, line.column);
+		}
+	}
+	clipper.End();
+
+	ImGui::EndChild();
+	ImGui::End();
+}
@@ -1,8 +1,8 @@
-#include "Application.hpp"
-
-int main(int argc, char** argv)
-{
-	Application app("Quantom IDE", 1280, 720);
-	app.Run();
-	return 0;
-}
+#include "Application.hpp"
+
+int main(int argc, char** argv)
+{
+	Application app("Quantom IDE", 1280, 720);
+	app.Run();
+	return 0;
+}
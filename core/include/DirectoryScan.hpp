@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "PathMatcher.hpp"
+
+namespace core {
+
+    class ThreadPool;
+
+    struct ScanOptions {
+        std::vector<std::string> excludeGlobs; // gitignore syntax, relative to the scanned root
+        bool useGitignore = true;              // honour .gitignore files found while walking
+    };
+
+    // Recursive directory walk on the thread pool. Every subdirectory is spawned as a nested task, so it
+    // lands on the current worker's deque and idle workers steal whole subtrees. Files are handed to the
+    // callback in batches from the pool's threads while the walk runs.
+    class DirectoryScan {
+    public:
+        using Callback = std::function<void(std::vector<std::filesystem::path>&& files)>;
+        using FinishedCallback = std::function<void()>;
+
+        // onFinished runs on the pool after the last batch was delivered, also when the scan was cancelled
+        DirectoryScan(ThreadPool& pool, const std::filesystem::path& root, ScanOptions options, Callback callback, FinishedCallback onFinished = {});
+        ~DirectoryScan(); // cancels and waits
+
+        DirectoryScan(const DirectoryScan&) = delete;
+        DirectoryScan& operator=(const DirectoryScan&) = delete;
+
+        void cancel();
+        void wait();
+
+        bool isFinished() const noexcept { return m_Finished.load(std::memory_order_acquire); }
+        std::size_t getFileCount() const noexcept { return m_FileCount.load(std::memory_order_relaxed); }
+
+    private:
+        struct IgnoreChain {
+            PathMatcher matcher;
+            std::size_t baseLength; // length of the directory's root-relative path including the '/'
+            std::shared_ptr<const IgnoreChain> parent;
+        };
+
+        struct Task {
+            std::filesystem::path directory;
+            std::string relative; // root-relative, '/' separated, empty for the root
+            std::shared_ptr<const IgnoreChain> ignore;
+        };
+
+        void spawn(Task task);
+        void process(const Task& task);
+        void deliver(std::vector<std::filesystem::path>& files, bool final);
+        bool isIgnored(const IgnoreChain* chain, const std::string& relative, bool isDirectory) const;
+
+        ThreadPool& m_Pool;
+        PathMatcher m_Exclude;
+        ScanOptions m_Options;
+        Callback m_Callback;
+        FinishedCallback m_OnFinished;
+
+        std::mutex m_BatchMutex;
+        std::vector<std::filesystem::path> m_Batch; // small directories are merged before delivery
+
+        std::atomic<std::size_t> m_Outstanding{ 0 }; // spawned directory tasks not finished yet
+        std::atomic<std::size_t> m_FileCount{ 0 };
+        std::atomic<bool> m_Cancelled{ false };
+        std::atomic<bool> m_Finished{ false };
+        std::shared_ptr<std::promise<void>> m_Done; // shared so it outlives the scan while being set
+        std::future<void> m_DoneFuture;
+    };
+
+} // namespace core
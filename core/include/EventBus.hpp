@@ -1,24 +1,151 @@
-#pragma once
-
-#include <unordered_map>
-#include <functional>
-#include <vector>
-#include <typeindex>
-#include <memory>
-
-namespace core {
-
-    class EventBus {
-    public:
-        template<typename EventType>
-        void subscribe(std::function<void(const EventType&)> handler);
-
-        template<typename EventType>
-        void publish(const EventType& event) const;
-
-    private:
-        using HandlerBase = std::function<void(const void*)>;
-        std::unordered_map<std::type_index, std::vector<HandlerBase>> m_handlers;
-    };
-
-} // namespace core
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Events.hpp"
+
+namespace core {
+
+    // Publish/subscribe between subsystems. Handlers are kept per compile-time EventId, so finding them
+    // is an array lookup. publish() runs the handlers on the calling thread. post() may be called from
+    // any thread: it pushes onto a lock-free MPSC queue that dispatchQueued() drains on the UI thread,
+    // grouped by event type so every handler list is walked once per batch.
+    // Everything except post() belongs to the UI thread.
+    class EventBus {
+    public:
+        using SubscriptionId = std::uint64_t;
+
+        explicit EventBus(std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
+        ~EventBus(); // queued events that were never dispatched are dropped
+
+        EventBus(const EventBus&) = delete;
+        EventBus& operator=(const EventBus&) = delete;
+
+        template<Event E>
+        SubscriptionId subscribe(std::function<void(const E&)> handler);
+
+        // Safe from inside a handler, the handler is skipped from then on
+        void unsubscribe(SubscriptionId id);
+
+        template<Event E>
+        void publish(const E& event);
+
+        template<Event E>
+        void post(E event);
+
+        // Called on the posting thread after every post(), e.g. glfwPostEmptyEvent so a UI loop that
+        // blocks while idle picks the event up right away. Must be thread safe.
+        void setWakeHandler(void (*handler)()) noexcept { m_wakeHandler.store(handler, std::memory_order_release); }
+
+        // Delivers the events posted so far in post order within each type, returns how many
+        std::size_t dispatchQueued();
+
+        std::size_t getQueuedCount() const noexcept { return m_queued.load(std::memory_order_relaxed); }
+
+    private:
+        using Handler = std::function<void(const void*)>;
+
+        struct Subscription {
+            SubscriptionId id;
+            bool active;
+            Handler handler;
+        };
+
+        struct Node {
+            std::atomic<Node*> next{ nullptr };
+            EventId id{};
+            const void* event = nullptr;
+            void (*destroy)(Node*, std::pmr::memory_resource*) = nullptr;
+        };
+
+        template<typename E>
+        struct EventNode : Node {
+            explicit EventNode(E&& value) : payload(std::move(value))
+            {
+                id = E::Id;
+                event = &payload;
+                destroy = [](Node* node, std::pmr::memory_resource* resource) {
+                    auto* self = static_cast<EventNode*>(node);
+                    self->~EventNode();
+                    resource->deallocate(self, sizeof(EventNode), alignof(EventNode));
+                };
+            }
+
+            E payload;
+        };
+
+        // Raises the dispatch depth for its lifetime, so a throwing handler cannot leave it raised
+        // and every later unsubscribe deferred
+        class DispatchScope {
+        public:
+            explicit DispatchScope(EventBus& bus) : m_bus(bus) { ++m_bus.m_dispatchDepth; }
+            ~DispatchScope() { m_bus.endDispatch(); }
+
+            DispatchScope(const DispatchScope&) = delete;
+            DispatchScope& operator=(const DispatchScope&) = delete;
+
+        private:
+            EventBus& m_bus;
+        };
+
+        SubscriptionId add(EventId id, Handler handler);
+        void dispatch(EventId id, const void* event);
+        void push(Node* node);
+        Node* pop();
+        void endDispatch();
+
+        std::pmr::memory_resource* m_resource;
+
+        std::array<std::vector<Subscription>, EventCount> m_handlers;
+        std::vector<std::pair<EventId, Subscription>> m_added; // subscribed during dispatch, added afterwards
+        SubscriptionId m_nextId = 1;
+        int m_dispatchDepth = 0;
+        bool m_needsCompaction = false;
+
+        // Vyukov intrusive MPSC queue, producers exchange m_head, the UI thread consumes from m_tail
+        alignas(64) std::atomic<Node*> m_head;
+        alignas(64) Node* m_tail;
+        Node m_stub;
+        std::atomic<std::size_t> m_queued{ 0 };
+        std::atomic<void (*)()> m_wakeHandler{ nullptr };
+
+        std::array<std::vector<Node*>, EventCount> m_batches; // reused by dispatchQueued
+    };
+
+    template<Event E>
+    EventBus::SubscriptionId EventBus::subscribe(std::function<void(const E&)> handler)
+    {
+        return add(E::Id, [handler = std::move(handler)](const void* event) {
+            handler(*static_cast<const E*>(event));
+        });
+    }
+
+    template<Event E>
+    void EventBus::publish(const E& event)
+    {
+        DispatchScope scope(*this);
+        dispatch(E::Id, &event);
+    }
+
+    template<Event E>
+    void EventBus::post(E event)
+    {
+        static_assert(!PublishOnlyEvent<E>, "the event points into the publisher's data and would dangle in the queue, publish() it");
+        static_assert(static_cast<std::size_t>(E::Id) < EventCount, "event id out of range");
+        void* memory = m_resource->allocate(sizeof(EventNode<E>), alignof(EventNode<E>));
+        Node* node = new (memory) EventNode<E>(std::move(event));
+        m_queued.fetch_add(1, std::memory_order_relaxed);
+        push(node);
+
+        if (auto wake = m_wakeHandler.load(std::memory_order_acquire))
+            wake();
+    }
+
+} // namespace core
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace core {
+
+    // Every event type has a fixed slot, the EventBus keeps its handlers in an array indexed by it.
+    // Core's own events are listed here, the slots from AppFirst on are numbered by the application
+    // with AppEventId, so its events never have to be added to core.
+    enum class EventId : std::uint16_t {
+        // Editor
+        DocumentOpened,
+        DocumentChanged,
+
+        AppFirst,
+        Count = AppFirst + 32
+    };
+
+    inline constexpr std::size_t EventCount = static_cast<std::size_t>(EventId::Count);
+    inline constexpr std::size_t AppEventCount = EventCount - static_cast<std::size_t>(EventId::AppFirst);
+
+    // Slot of the application's index-th event type
+    constexpr EventId AppEventId(std::size_t index)
+    {
+        return static_cast<EventId>(static_cast<std::size_t>(EventId::AppFirst) + index);
+    }
+
+    // An event is any type naming its slot as `static constexpr core::EventId Id`
+    template<typename T>
+    concept Event = requires { { T::Id } -> std::convertible_to<EventId>; };
+
+    // Events that point into the publisher's data, e.g. through a string_view, declare
+    // `static constexpr bool PublishOnly = true`. They would dangle in the queue, EventBus::post rejects them.
+    template<typename T>
+    concept PublishOnlyEvent = Event<T> && requires { requires T::PublishOnly; };
+
+    // Editor events are published synchronously, text points into the document and is only valid during dispatch
+    struct DocumentOpened {
+        static constexpr EventId Id = EventId::DocumentOpened;
+        static constexpr bool PublishOnly = true;
+
+        std::filesystem::path path;
+        std::string_view languageId;
+        std::string_view text;
+    };
+
+    struct DocumentChanged {
+        static constexpr EventId Id = EventId::DocumentChanged;
+        static constexpr bool PublishOnly = true;
+
+        std::filesystem::path path;
+        std::string_view text;
+    };
+
+} // namespace core
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DirectoryScan.hpp"
+#include "TextSearch.hpp"
+
+namespace core {
+
+    class ThreadPool;
+
+    // Find in files on the thread pool. The files come from a DirectoryScan, so .gitignore is honoured,
+    // and every batch the walk delivers becomes one search task. Files are read through a mapping in
+    // chunks of whole lines, binary files are skipped. Results are handed to the callback file by file
+    // from the pool's threads while the search runs.
+    class FileSearch {
+    public:
+        static constexpr std::size_t MaxLinesPerFile = 1000;
+        static constexpr std::size_t MaxPreviewLength = 240; // bytes of a line kept for display
+
+        struct LineResult {
+            std::size_t line;          // 0-based
+            std::size_t column;        // byte offset of the match in the line
+            std::size_t length;
+            std::string preview;       // the line, cut around the match when it is long
+            std::size_t previewColumn; // of the match in preview
+        };
+
+        struct FileResult {
+            std::filesystem::path path;
+            std::vector<LineResult> lines;
+            bool truncated = false; // more than MaxLinesPerFile lines matched
+        };
+
+        using Callback = std::function<void(FileResult&& result)>;
+        using FinishedCallback = std::function<void()>;
+
+        // onFinished runs on the pool once every file was searched or the search was cancelled
+        FileSearch(ThreadPool& pool, const std::filesystem::path& root, TextSearcher searcher, ScanOptions options,
+            Callback callback, FinishedCallback onFinished = {});
+        ~FileSearch(); // cancels and waits
+
+        FileSearch(const FileSearch&) = delete;
+        FileSearch& operator=(const FileSearch&) = delete;
+
+        void cancel();
+        void wait();
+
+        bool isFinished() const noexcept { return m_Finished.load(std::memory_order_acquire); }
+        bool isCancelled() const noexcept { return m_Cancelled.load(std::memory_order_relaxed); }
+        std::size_t getFileCount() const noexcept { return m_FileCount.load(std::memory_order_relaxed); }
+        std::size_t getByteCount() const noexcept { return m_ByteCount.load(std::memory_order_relaxed); }
+        std::size_t getMatchCount() const noexcept { return m_MatchCount.load(std::memory_order_relaxed); }
+
+    private:
+        void searchFiles(const std::vector<std::filesystem::path>& files);
+        void searchFile(const std::filesystem::path& path, TextSearcher& searcher);
+        void finishTask();
+
+        ThreadPool& m_Pool;
+        TextSearcher m_Searcher; // copied into every task
+        Callback m_Callback;
+        FinishedCallback m_OnFinished;
+
+        std::atomic<std::size_t> m_Outstanding{ 1 }; // search tasks not finished yet, plus the walk
+        std::atomic<std::size_t> m_FileCount{ 0 };
+        std::atomic<std::size_t> m_ByteCount{ 0 };
+        std::atomic<std::size_t> m_MatchCount{ 0 };
+        std::atomic<bool> m_Cancelled{ false };
+        std::atomic<bool> m_Finished{ false };
+        std::shared_ptr<std::promise<void>> m_Done; // shared so it outlives the search while being set
+        std::future<void> m_DoneFuture;
+
+        std::unique_ptr<DirectoryScan> m_Scan;
+    };
+
+} // namespace core
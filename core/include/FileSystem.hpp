@@ -1,30 +1,100 @@
-#pragma once
-
-#include <filesystem>
-#include <string>
-#include <vector>
-#include <optional>
-
-namespace core {
-    class Platform;
-}
-
-
-namespace core {
-
-    class FileSystem {
-    public:
-        static bool exists(const std::filesystem::path& path);
-        static bool createDirectory(const std::filesystem::path& path);
-        static bool remove(const std::filesystem::path& path);
-
-        static std::optional<std::string> readFile(const std::filesystem::path& filePath);
-        static bool writeFile(const std::filesystem::path& filePath, std::string_view content);
-
-        static std::vector<std::filesystem::path> listFiles(const std::filesystem::path& directory, bool recursive = false);
-        static std::optional<std::filesystem::path> openFile(std::filesystem::path = std::filesystem::path());
-        static std::optional<std::filesystem::path> saveFile(std::string& buffer, std::filesystem::path path = std::filesystem::path());
-        static std::optional<std::filesystem::path> openFolder(std::filesystem::path = std::filesystem::path());
-    };
-
-} // namespace core
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <memory>
+#include <type_traits>
+
+#include "DirectoryScan.hpp"
+#include "TextEncoding.hpp"
+
+namespace core {
+    class Platform;
+}
+
+
+namespace core {
+
+    // Read-only memory mapping of a whole file. The pages are shared with the OS cache, so mapping a
+    // large file costs address space rather than memory. Another process may truncate the file while
+    // it is mapped: on POSIX, touching pages past the new end through data() then raises SIGBUS, so
+    // read through copy() or view(), which report that as a failure instead. Windows refuses to truncate
+    // a mapped file, both still catch in-page errors of removable or network drives there.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const noexcept { return static_cast<const char*>(m_data); }
+        std::size_t size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        // Copies count bytes at offset into out. False if the range is out of bounds or the file
+        // shrank underneath the mapping, out is then partially written.
+        bool copy(std::size_t offset, std::size_t count, char* out) const noexcept;
+
+        // Calls visit(std::string_view) with count bytes at offset, read in place on POSIX. False if the
+        // range is out of bounds or the file shrank underneath the mapping: pages past the new end then
+        // read as zeros, so whatever visit made of the view must be thrown away, and the mapping no
+        // longer shows the file. Windows cannot leave an in-page error without skipping destructors,
+        // there visit gets a guarded copy.
+        template<typename Visit>
+        bool view(std::size_t offset, std::size_t count, Visit&& visit) const
+        {
+            return viewGuarded(offset, count, [](void* context, std::string_view bytes) {
+                (*static_cast<std::remove_reference_t<Visit>*>(context))(bytes);
+            }, &visit);
+        }
+
+    private:
+        friend class FileSystem;
+
+        void release() noexcept;
+        bool viewGuarded(std::size_t offset, std::size_t count, void (*visit)(void*, std::string_view), void* context) const;
+
+        void* m_data = nullptr;
+        std::size_t m_size = 0;
+#ifdef _WIN32
+        void* m_mapping = nullptr; // HANDLE of the file mapping object
+#endif
+    };
+
+    class FileSystem {
+    public:
+        static bool exists(const std::filesystem::path& path);
+        static bool createDirectory(const std::filesystem::path& path);
+        static bool remove(const std::filesystem::path& path);
+
+        // Whole file into a string, read through a mapping so the contents are copied only once
+        static std::optional<std::string> readFile(const std::filesystem::path& filePath);
+        // Maps a regular file, an empty file gives an empty mapping
+        static std::optional<MappedFile> mapFile(const std::filesystem::path& filePath);
+        static bool writeFile(const std::filesystem::path& filePath, std::string_view content);
+        // Crash-safe replacement of filePath. The content goes to a temporary file in the same directory,
+        // which is flushed to disk and renamed over the target, so a reader or a crash only ever sees the
+        // old or the new file. An existing file keeps its permissions, a symlink keeps pointing at it.
+        static bool writeFileAtomic(const std::filesystem::path& filePath, std::string_view content);
+
+        static std::vector<std::filesystem::path> listFiles(const std::filesystem::path& directory, bool recursive = false);
+
+        // Starts a parallel, .gitignore aware walk of directory on pool. Batches of files are passed to callback from
+        // the pool's threads as they are found, onFinished once the walk is over. Destroying the returned scan cancels it.
+        static std::unique_ptr<DirectoryScan> scan(ThreadPool& pool, const std::filesystem::path& directory, ScanOptions options,
+            DirectoryScan::Callback callback, DirectoryScan::FinishedCallback onFinished = {});
+        static std::optional<std::filesystem::path> openFile(std::filesystem::path = std::filesystem::path());
+        // Writes buffer, UTF-8 text, back in the encoding its file was read in
+        static std::optional<std::filesystem::path> saveFile(const std::string& buffer, std::filesystem::path path = std::filesystem::path(),
+            TextEncoding encoding = TextEncoding::Utf8);
+        static std::optional<std::filesystem::path> openFolder(std::filesystem::path = std::filesystem::path());
+    };
+
+} // namespace core
@@ -1,32 +1,107 @@
-#pragma once
-
-#include <string>
-#include <functional>
-#include <filesystem>
-#include <chrono>
-#include <unordered_map>
-
-namespace core {
-
-    class FileWatcher {
-    public:
-        using Callback = std::function<void(const std::filesystem::path&)>;
-
-        FileWatcher() = default;
-        ~FileWatcher();
-
-        // Add path to watch, call callback on change
-        void watch(const std::filesystem::path& path, Callback callback);
-
-        // Remove path from watching
-        void unwatch(const std::filesystem::path& path);
-
-        // Poll for changes, should be called periodically (e.g. each frame or on a timer)
-        void pollChanges();
-
-    private:
-        std::unordered_map<std::filesystem::path, std::filesystem::file_time_type> m_paths;
-        std::unordered_map<std::filesystem::path, Callback> m_callbacks;
-    };
-
-} // namespace core
+#pragma once
+
+#include <string>
+#include <functional>
+#include <filesystem>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace core {
+
+    enum class FileChangeType {
+        Created,
+        Modified,
+        Removed
+    };
+
+    struct FileChange {
+        std::filesystem::path path;
+        FileChangeType type;
+    };
+
+    // Watches files and directory trees on a background thread. Uses inotify on Linux and falls back
+    // to mtime polling elsewhere. Bursts of events are coalesced until the tree has been quiet for the
+    // debounce window and then delivered as one change set per watched path.
+    class FileWatcher {
+    public:
+        using Callback = std::function<void(const std::vector<FileChange>&)>;
+
+        explicit FileWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // Add path to watch, call callback with the changes below it. Directories are watched recursively:
+        // the path itself right away, the tree below it is walked on the watcher thread, so changes in
+        // subdirectories are reported once the walk has reached them.
+        void watch(const std::filesystem::path& path, Callback callback);
+
+        // Remove path from watching
+        void unwatch(const std::filesystem::path& path);
+
+        // Deliver finished change sets on the calling thread (e.g. each frame), cheap when nothing changed.
+        // Returns whether there were changes.
+        bool pollChanges();
+
+        // Called on the watcher thread whenever a change set becomes ready, e.g. to wake a UI loop
+        // that blocks while idle. Set it before changes can arrive, it must be thread safe.
+        void setWakeHandler(void (*handler)()) noexcept { m_wakeHandler.store(handler, std::memory_order_release); }
+
+        // False when running on the polling fallback
+        bool isNative() const noexcept { return m_inotifyFd >= 0; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void run();
+        void wake();
+        void record(const std::filesystem::path& path, FileChangeType type);
+        void flushPending();
+        void registerWatches();
+        bool isNeeded(const std::filesystem::path& directory) const;
+
+        struct Watch {
+            Callback callback;
+            bool recursive; // directory tree, otherwise a single file
+        };
+
+        // inotify backend
+        int addDescriptor(const std::filesystem::path& directory);
+        void addWatch(const std::filesystem::path& directory, bool reportContents);
+        void removeWatches(const std::filesystem::path& directory);
+        void readEvents();
+
+        // Polling fallback
+        void scan(const std::filesystem::path& root, bool recursive, std::unordered_map<std::filesystem::path, std::filesystem::file_time_type>& snapshot) const;
+        void pollSnapshots();
+
+        std::chrono::milliseconds m_debounce;
+
+        std::mutex m_mutex; // guards everything below that is shared with the watcher thread
+        std::unordered_map<std::filesystem::path, Watch> m_watches;
+        std::unordered_map<int, std::filesystem::path> m_watchDescriptors;
+        std::unordered_map<std::filesystem::path, std::unordered_map<std::filesystem::path, std::filesystem::file_time_type>> m_snapshots;
+        std::vector<std::filesystem::path> m_registrations; // roots whose walk watch() left to the watcher thread
+        std::vector<FileChange> m_ready;
+        std::atomic<bool> m_hasReady{ false };
+        std::atomic<void (*)()> m_wakeHandler{ nullptr };
+
+        // Owned by the watcher thread
+        std::unordered_map<std::filesystem::path, FileChangeType> m_pending;
+        Clock::time_point m_firstPending;
+        Clock::time_point m_lastPending;
+        bool m_watchLimitReported = false;
+
+        int m_inotifyFd = -1;
+        int m_wakeFd = -1;
+        std::atomic<bool> m_stop{ false };
+        std::thread m_thread;
+    };
+
+} // namespace core
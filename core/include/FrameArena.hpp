@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace core {
+
+    // Bump allocator for data that lives for one UI frame. reset() at the start of a frame rewinds
+    // the arena, deallocate is a no-op. If a frame needed more than the first chunk, the next reset
+    // replaces the chunks with one big enough for that frame, so steady-state frames never touch the heap.
+    // Not thread safe, the arena belongs to the UI thread.
+    class FrameArena : public std::pmr::memory_resource {
+    public:
+        struct Stats {
+            std::size_t used;      // bytes handed out this frame
+            std::size_t capacity;  // bytes in all chunks
+            std::size_t peak;      // highest per-frame usage seen
+            std::size_t overflows; // allocations this frame that needed a new chunk
+            std::size_t allocations; // allocations this frame
+        };
+
+        explicit FrameArena(std::size_t capacity = 256 * 1024);
+        ~FrameArena() override;
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void reset();
+
+        Stats getStats() const noexcept;
+        // Stats of the frame before the last reset(), i.e. of a complete frame
+        Stats getLastFrameStats() const noexcept { return m_lastFrame; }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    private:
+        struct Chunk {
+            std::unique_ptr<std::byte[]> memory;
+            std::size_t size;
+        };
+
+        void addChunk(std::size_t minimum);
+
+        std::vector<Chunk> m_chunks;
+        std::byte* m_current = nullptr;
+        std::byte* m_end = nullptr;
+        std::size_t m_used = 0;      // bytes in chunks before the current one plus the current offset
+        std::size_t m_peak = 0;
+        std::size_t m_overflows = 0;
+        std::size_t m_allocations = 0;
+        Stats m_lastFrame{};
+    };
+
+    // Per-frame temporaries for the UI, construct them with g_Core.getFrameArena()
+    using FrameString = std::pmr::string;
+    template<typename T>
+    using FrameVector = std::pmr::vector<T>;
+
+} // namespace core
@@ -1,28 +1,317 @@
 #pragma once
 
 #include <iostream>
+#include <atomic>
+#include <charconv>
 #include <chrono>
 #include <string>
+#include <string_view>
 #include <ctime>
-#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iomanip>
+#include <memory>
 #include <sstream>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
+// LOG("Opened {} in {} ms", core::Log::Tracer, path, ms). The format string is checked against the
+// arguments at compile time, and the arguments are only evaluated when the level is enabled.
+#define LOG(fmt, level, ...) \
+	do { if (core::Log::IsEnabled(level)) core::Log::Write(level, fmt __VA_OPT__(,) __VA_ARGS__); } while (0)
+
 #ifdef _DEBUG
-#define LOG(fmt, level, ...) core::Log::lOG(fmt, level, __VA_ARGS__)
 #define TIMER(x) ScopedTimer timer(x)
 #else
-#define LOG(fmt, level, ...)
 #define TIMER(x)
 #endif
 namespace core
 {
 
+	// One message in the logger's ring: the format string, the arguments packed by value and the
+	// function that turns them into text on the sink thread. Fits a single 256 byte ring cell.
+	struct LogRecord
+	{
+		static constexpr std::size_t Capacity = 192; // bytes for packed arguments
+
+		using Formatter = void (*)(const LogRecord& record, std::string& out);
+
+		std::int64_t timestamp;   // system_clock nanoseconds
+		std::string_view format;  // string literal of the call site, not copied
+		Formatter formatter;
+		int level;
+		alignas(8) std::byte args[Capacity];
+	};
+
+	namespace detail
+	{
+		void LogFormatError(const char* reason); // never defined, calling it in a consteval context fails the build
+
+		// Format string checked at compile time: "{}" per argument, "{{" and "}}" for literal braces
+		template<typename... Args>
+		struct BasicLogFormat
+		{
+			template<typename S>
+				requires std::convertible_to<const S&, std::string_view>
+			consteval BasicLogFormat(const S& format) : text(format)
+			{
+				std::size_t placeholders = 0;
+				for (std::size_t i = 0; i < text.size(); ++i) {
+					if (text[i] == '{') {
+						if (i + 1 < text.size() && text[i + 1] == '{')
+							++i;
+						else if (i + 1 < text.size() && text[i + 1] == '}') {
+							++placeholders;
+							++i;
+						}
+						else
+							LogFormatError("log format: '{' must start \"{}\" or be written as \"{{\"");
+					}
+					else if (text[i] == '}') {
+						if (i + 1 < text.size() && text[i + 1] == '}')
+							++i;
+						else
+							LogFormatError("log format: unmatched '}', write \"}}\"");
+					}
+				}
+				if (placeholders != sizeof...(Args))
+					LogFormatError("log format: number of {} does not match the number of arguments");
+			}
+
+			std::string_view text;
+		};
+
+		// Text argument as stored in a record. Short text is copied into the record, text that does not
+		// fit goes to the heap and is freed once the sink has formatted it.
+		struct LogText
+		{
+			std::string_view text;
+			std::unique_ptr<char[]> owned;
+		};
+
+		// How a caller's argument type is stored: numbers as themselves, every kind of string as LogText
+		template<typename T, typename = void>
+		struct LogStorage
+		{
+			static_assert(sizeof(T) == 0, "unsupported log argument type");
+		};
+
+		template<typename T>
+		struct LogStorage<T, std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>>>
+		{
+			using Type = T;
+			static Type convert(T value) { return value; }
+		};
+
+		template<typename T>
+		struct LogStorage<T, std::enable_if_t<std::is_enum_v<T>>>
+		{
+			using Type = std::underlying_type_t<T>;
+			static Type convert(T value) { return static_cast<Type>(value); }
+		};
+
+		template<typename T>
+		struct LogStorage<T, std::enable_if_t<std::is_pointer_v<T> && !std::is_convertible_v<T, const char*>>>
+		{
+			using Type = const void*;
+			static Type convert(T value) { return value; }
+		};
+
+		template<typename T>
+		struct LogStorage<T, std::enable_if_t<std::is_convertible_v<const T&, std::string_view>>>
+		{
+			using Type = LogText;
+			static std::string_view convert(const T& value)
+			{
+				if constexpr (std::is_convertible_v<const T&, const char*>) {
+					const char* text = value;
+					return text ? std::string_view(text) : std::string_view("(null)");
+				}
+				else {
+					return std::string_view(value);
+				}
+			}
+		};
+
+		template<>
+		struct LogStorage<std::filesystem::path>
+		{
+			using Type = LogText;
+			static auto convert(const std::filesystem::path& value)
+			{
+				// Narrow native paths are borrowed, elsewhere the path has to be converted
+				if constexpr (std::is_same_v<std::filesystem::path::value_type, char>)
+					return std::string_view(value.native());
+				else
+					return value.string();
+			}
+		};
+
+		// decay of const T& turns string literals into const char*
+		template<typename T>
+		using LogStorageFor = LogStorage<std::decay_t<const T&>>;
+
+		template<typename T>
+		using LogStored = typename LogStorageFor<T>::Type;
+
+		// Packing of one stored argument
+		template<typename T>
+		struct LogArgument
+		{
+			static constexpr std::size_t FixedSize = sizeof(T);
+
+			static std::byte* encode(std::byte* out, std::size_t, T value)
+			{
+				std::memcpy(out, &value, sizeof(T));
+				return out + sizeof(T);
+			}
+
+			static T decode(const std::byte*& in)
+			{
+				T value;
+				std::memcpy(&value, in, sizeof(T));
+				in += sizeof(T);
+				return value;
+			}
+		};
+
+		template<>
+		struct LogArgument<LogText>
+		{
+			static constexpr std::uint16_t OnHeap = 0xFFFF;
+			static constexpr std::size_t FixedSize = sizeof(std::uint16_t) + sizeof(char*) + sizeof(std::size_t); // enough for the heap form
+
+			static std::byte* encode(std::byte* out, std::size_t budget, std::string_view value)
+			{
+				if (value.size() <= budget + FixedSize - sizeof(std::uint16_t) && value.size() < OnHeap) {
+					const auto stored = static_cast<std::uint16_t>(value.size());
+					std::memcpy(out, &stored, sizeof(stored));
+					std::memcpy(out + sizeof(stored), value.data(), value.size());
+					return out + sizeof(stored) + value.size();
+				}
+
+				const std::size_t size = value.size();
+				char* copy = new char[size];
+				std::memcpy(copy, value.data(), size);
+				std::memcpy(out, &OnHeap, sizeof(OnHeap));
+				std::memcpy(out + sizeof(OnHeap), &copy, sizeof(copy));
+				std::memcpy(out + sizeof(OnHeap) + sizeof(copy), &size, sizeof(size));
+				return out + FixedSize;
+			}
+
+			static LogText decode(const std::byte*& in)
+			{
+				std::uint16_t length;
+				std::memcpy(&length, in, sizeof(length));
+				in += sizeof(length);
+
+				if (length == OnHeap) {
+					char* copy;
+					std::size_t size;
+					std::memcpy(&copy, in, sizeof(copy));
+					std::memcpy(&size, in + sizeof(copy), sizeof(size));
+					in += sizeof(copy) + sizeof(size);
+					return { std::string_view(copy, size), std::unique_ptr<char[]>(copy) };
+				}
+
+				const std::string_view text(reinterpret_cast<const char*>(in), length);
+				in += length;
+				return { text, nullptr };
+			}
+		};
+
+		template<typename... Stored, typename... Values>
+		void PackLogArguments(LogRecord& record, const Values&... values)
+		{
+			constexpr std::size_t fixed = (std::size_t{ 0 } + ... + LogArgument<Stored>::FixedSize);
+			static_assert(fixed <= LogRecord::Capacity, "too many log arguments for one record");
+
+			// Text shares whatever the fixed size arguments leave over
+			if constexpr (sizeof...(Stored) > 0) {
+				std::byte* out = record.args;
+				std::size_t budget = LogRecord::Capacity - fixed;
+				((out = [&] {
+					std::byte* next = LogArgument<Stored>::encode(out, budget, values);
+					budget = budget + LogArgument<Stored>::FixedSize - static_cast<std::size_t>(next - out);
+					return next;
+				}()), ...);
+			}
+		}
+
+		template<typename T>
+		void AppendLogValue(std::string& out, const T& value)
+		{
+			if constexpr (std::is_same_v<T, LogText>) {
+				out += value.text;
+			}
+			else if constexpr (std::is_same_v<T, bool>) {
+				out += value ? "true" : "false";
+			}
+			else if constexpr (std::is_same_v<T, char>) {
+				out += value;
+			}
+			else if constexpr (std::is_same_v<T, const void*>) {
+				char buffer[2 + 2 * sizeof(void*)] = { '0', 'x' };
+				const auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), reinterpret_cast<std::uintptr_t>(value), 16);
+				out.append(buffer, result.ptr);
+			}
+			else {
+				char buffer[64];
+				const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+				out.append(buffer, result.ptr);
+			}
+		}
+
+		// Copies the literal text up to the next placeholder, or to the end, and skips the placeholder
+		inline void AppendLogLiteral(std::string& out, std::string_view& format)
+		{
+			std::size_t i = 0;
+			while (i < format.size()) {
+				const char c = format[i];
+				if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+					out += c;
+					i += 2;
+				}
+				else if (c == '{') {
+					format.remove_prefix(i + 2);
+					return;
+				}
+				else {
+					out += c;
+					++i;
+				}
+			}
+			format = {};
+		}
+
+		template<typename... Stored>
+		void FormatLogRecord(const LogRecord& record, std::string& out)
+		{
+			const std::byte* in = record.args;
+			// Braced initialisation decodes the arguments left to right
+			std::tuple<decltype(LogArgument<Stored>::decode(in))...> values{ LogArgument<Stored>::decode(in)... };
+
+			std::string_view format = record.format;
+			std::apply([&](const auto&... args) {
+				((AppendLogLiteral(out, format), AppendLogValue(out, args)), ...);
+			}, values);
+			AppendLogLiteral(out, format);
+		}
+	}
+
+	template<typename... Args>
+	using LogFormat = detail::BasicLogFormat<std::type_identity_t<Args>...>;
+
+	// Asynchronous logger. Callers only copy a compact record into a lock-free MPSC ring, a sink thread
+	// formats the records and writes them out in batches. Active in every build configuration.
 	class Log
 	{
 	public:
@@ -32,24 +321,57 @@ namespace core
 			Tracer = 2
 		};
 
+		// What a logging thread does when the ring is full
+		enum class OverflowPolicy {
+			Drop,  // discard the message, the sink reports how many were lost
+			Block  // wait until the sink has made room
+		};
+
 	private:
-		inline static int m_LogLevel = Tracer;
+#ifdef _DEBUG
+		inline static std::atomic<int> m_LogLevel{ Tracer };
+#else
+		inline static std::atomic<int> m_LogLevel{ Warn };
+#endif
+
+		static bool Push(LogLevel level, std::string_view format, LogRecord::Formatter formatter, const void* context,
+			void (*pack)(LogRecord& record, const void* context));
 
 	public:
+		static bool IsEnabled(LogLevel level) noexcept {
+			return level <= m_LogLevel.load(std::memory_order_relaxed);
+		}
+
+		// Use the LOG macro, it skips evaluating the arguments of disabled levels
 		template<typename... Args>
-		static void lOG(const char* fmt, LogLevel level, Args... args)
+		static void Write(LogLevel level, LogFormat<Args...> format, const Args&... args)
 		{
-			char buffer[1024];
-			snprintf(buffer, sizeof(buffer), fmt, args...);
-			LoG(buffer, level);
+			if (!IsEnabled(level))
+				return;
+
+			// Strings stay views of the caller's arguments until Push copies them into the record
+			const auto converted = std::make_tuple(detail::LogStorageFor<Args>::convert(args)...);
+			using Converted = decltype(converted);
+
+			Push(level, format.text, &detail::FormatLogRecord<detail::LogStored<Args>...>, &converted, [](LogRecord& record, const void* context) {
+				std::apply([&](const auto&... values) {
+					detail::PackLogArguments<detail::LogStored<Args>...>(record, values...);
+				}, *static_cast<const Converted*>(context));
+			});
 		}
 
 		static void LoG(const char* formattedMsg, LogLevel severity);
 
-
 		static void SetLogLevel(LogLevel level) {
-			m_LogLevel = level;
+			m_LogLevel.store(level, std::memory_order_relaxed);
 		}
+
+		static void SetOverflowPolicy(OverflowPolicy policy);
+
+		// Blocks until everything logged before the call has been written
+		static void Flush();
+
+		static std::size_t GetDroppedCount();
 	};
 
-}
\ No newline at end of file
+}
@@ -1,24 +1,64 @@
-#pragma once
-
-#include <vector>
-#include <cstddef>
-
-namespace core {
-
-    class MemoryPool {
-    public:
-        MemoryPool() {}
-        explicit MemoryPool(std::size_t blockSize, std::size_t blockCount);
-        ~MemoryPool();
-
-        void* allocate();
-        void deallocate(void* ptr);
-
-    private:
-        std::vector<std::byte> m_memory;
-        void* m_freeList = nullptr;
-        std::size_t m_blockSize;
-        std::size_t m_blockCount;
-    };
-
-} // namespace core
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+namespace core {
+
+    // Fixed-size block allocator. Free blocks form an intrusive singly linked list, and the pool grows
+    // by whole chunks of blockCount blocks. Each thread keeps a small magazine of free blocks, so
+    // allocate/deallocate only take the pool's lock when a magazine runs empty or overflows.
+    // Chunks come from the upstream resource, and as a std::pmr::memory_resource requests larger than
+    // a block go there too.
+    class MemoryPool : public std::pmr::memory_resource {
+    public:
+        struct Stats {
+            std::size_t blockSize;
+            std::size_t chunks;
+            std::size_t capacity; // blocks in all chunks
+            std::size_t inUse;    // blocks handed out and not returned
+        };
+
+        explicit MemoryPool(std::size_t blockSize, std::size_t blockCount, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~MemoryPool();
+
+        MemoryPool(const MemoryPool&) = delete;
+        MemoryPool& operator=(const MemoryPool&) = delete;
+
+        void* allocate();
+        void deallocate(void* ptr);
+
+        std::size_t getBlockSize() const noexcept { return m_blockSize; }
+        Stats getStats() const;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        struct Block {
+            Block* next;
+        };
+        struct Magazine;
+        struct MagazineCache;
+
+        Magazine* getMagazine();
+        void refill(Magazine& magazine);
+        void drain(Magazine& magazine, std::size_t keep);
+        void grow(); // m_mutex held
+
+        std::pmr::memory_resource* m_upstream;
+        std::size_t m_blockSize;
+        std::size_t m_blockCount;
+
+        mutable std::mutex m_mutex;
+        Block* m_freeList = nullptr;
+        std::size_t m_freeCount = 0;
+        std::vector<std::byte*> m_chunks; // from m_upstream, m_blockSize * m_blockCount bytes each
+        std::vector<Magazine*> m_magazines; // guarded by the global magazine registry lock
+    };
+
+} // namespace core
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace core {
+
+    // Compiled set of .gitignore style patterns ("build/", "*.o", "/docs/**/*.md", "!keep.o").
+    // Plain names and "*.ext" patterns are looked up in hash sets, only real globs are matched
+    // character by character.
+    class PathMatcher {
+    public:
+        enum class Result {
+            None,    // no pattern matched
+            Ignored,
+            Included // matched by a negated pattern
+        };
+
+        PathMatcher() = default;
+        explicit PathMatcher(const std::vector<std::string>& patterns);
+
+        // Parses the content of a .gitignore file, comments and blank lines are skipped
+        static PathMatcher fromGitignore(std::string_view content);
+
+        void add(std::string_view pattern);
+
+        // relativePath uses '/' separators and is relative to the directory the patterns belong to
+        Result match(std::string_view relativePath, bool isDirectory) const;
+        bool isIgnored(std::string_view relativePath, bool isDirectory) const { return match(relativePath, isDirectory) == Result::Ignored; }
+
+        bool empty() const noexcept { return m_Rules.empty(); }
+
+        static bool MatchGlob(std::string_view pattern, std::string_view text);
+
+    private:
+        struct Rule {
+            enum class Kind { Literal, Suffix, Glob };
+
+            std::string pattern;
+            Kind kind;
+            bool negated;
+            bool directoryOnly;
+            bool anchored; // contains a '/', matched against the whole relative path instead of the name
+        };
+
+        bool matches(const Rule& rule, std::string_view relativePath, std::string_view name, bool isDirectory) const;
+
+        std::vector<Rule> m_Rules;
+
+        // Fast path while no negated rule exists and rule order does not matter
+        bool m_HasNegation = false;
+        std::unordered_set<std::string> m_Names;          // "build", ".git"
+        std::unordered_set<std::string> m_DirectoryNames; // "build/"
+        std::unordered_set<std::string> m_Extensions;     // "*.o" stored as ".o"
+        std::vector<std::size_t> m_GlobRules;
+    };
+
+} // namespace core
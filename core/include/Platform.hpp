@@ -1,49 +1,64 @@
-#pragma once
-
-#include <optional>
-#include <filesystem>
-#include <string>
-
-#ifdef _WIN32
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <commdlg.h>
-#include <ShlObj.h>
-#elif defined(__linux__)
-#include <gtk/gtk.h>
-#else
-#error Platform not supported
-#endif
-
-namespace core
-{
-	enum class Color {
-		Default,
-		Red,
-		Green,
-		Blue,
-		Yellow,
-		Magenta,
-		Cyan,
-		White
-	};
-
-	class Platform {
-	public:
-		Platform() = delete;
-		Platform(const Platform&) = delete;
-		Platform& operator=(const Platform&) = delete;
-		static std::optional<std::filesystem::path> openFileDialog(const char* filters = nullptr);
-		static std::optional<std::filesystem::path> saveFileDialog(const char* filters = nullptr);
-		static std::optional<std::filesystem::path> folderDialog();
-
-		// Console color functions
-		static void enableConsoleColors();
-		static std::string getAnsiCode(Color color);
-		static void printConsoleColor(const std::string& text, Color color = Color::Default, bool newLine = true);
-		static void printConsoleColor(const std::string& tag, const std::string& text, Color tagColor = Color::Cyan, Color messageColor = Color::Default, bool newLine = true);
-		static void setConsoleColor(Color color);
-		static void resetConsoleColor();
-	};
-
+#pragma once
+
+#include <optional>
+#include <filesystem>
+#include <string>
+#include <cstdint>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <commdlg.h>
+#include <ShlObj.h>
+#elif defined(__linux__)
+#include <gtk/gtk.h>
+#else
+#error Platform not supported
+#endif
+
+namespace core
+{
+	enum class Color {
+		Default,
+		Red,
+		Green,
+		Blue,
+		Yellow,
+		Magenta,
+		Cyan,
+		White
+	};
+
+	class Platform {
+	public:
+		Platform() = delete;
+		Platform(const Platform&) = delete;
+		Platform& operator=(const Platform&) = delete;
+		static std::optional<std::filesystem::path> openFileDialog(const char* filters = nullptr);
+		static std::optional<std::filesystem::path> saveFileDialog(const char* filters = nullptr);
+		static std::optional<std::filesystem::path> folderDialog();
+
+		// Per-user directory for state that must outlive the process, e.g. crash recovery.
+		// %LOCALAPPDATA%\QuantomIDE on Windows, $XDG_STATE_HOME/QuantomIDE or ~/.local/state/QuantomIDE
+		// elsewhere, the temp directory if neither is known. Not created.
+		static std::filesystem::path dataDirectory();
+
+		// Exclusive lock on path, the file is created if missing. Held until unlockFile or until the
+		// process ends, however it ends, so a lock that can be taken names a dead owner. Returns nullopt
+		// while another process (or another lockFile call) holds it.
+		using FileLock = std::intptr_t;
+		static std::optional<FileLock> lockFile(const std::filesystem::path& path);
+		static void unlockFile(FileLock lock);
+
+		static unsigned long processId();
+
+		// Console color functions
+		static void enableConsoleColors();
+		static std::string getAnsiCode(Color color);
+		static void printConsoleColor(const std::string& text, Color color = Color::Default, bool newLine = true);
+		static void printConsoleColor(const std::string& tag, const std::string& text, Color tagColor = Color::Cyan, Color messageColor = Color::Default, bool newLine = true);
+		static void setConsoleColor(Color color);
+		static void resetConsoleColor();
+	};
+
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define QUANTOM_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define QUANTOM_PROFILER_RDTSC 1
+#endif
+
+#define QUANTOM_PROFILE_CONCAT_(a, b) a##b
+#define QUANTOM_PROFILE_CONCAT(a, b) QUANTOM_PROFILE_CONCAT_(a, b)
+
+// PROFILE_ZONE("UIManager::drawEditor") times the enclosing scope. The name is interned at compile
+// time: every call site owns one static ZoneSite and events only store its address.
+#define PROFILE_ZONE(name) QUANTOM_PROFILE_ZONE_(name, __COUNTER__)
+#define QUANTOM_PROFILE_ZONE_(name, id) \
+    static constexpr ::core::ZoneSite QUANTOM_PROFILE_CONCAT(profileSite_, id){ name, __FILE__, __LINE__ }; \
+    ::core::ProfileScope QUANTOM_PROFILE_CONCAT(profileScope_, id)(QUANTOM_PROFILE_CONCAT(profileSite_, id))
+
+namespace core {
+
+    struct ZoneSite {
+        const char* name;
+        const char* file;
+        std::uint32_t line;
+    };
+
+    // One completed zone, begin and end in profiler ticks
+    struct ProfileEvent {
+        const ZoneSite* site;
+        std::uint64_t begin;
+        std::uint64_t end;
+    };
+
+    // In-process hierarchical profiler. Each thread records completed zones into its own ring of
+    // BufferCapacity events, so recording never takes a lock; the oldest events are overwritten.
+    // Nesting follows from the begin/end intervals of a thread. Recording can be switched on and
+    // off at runtime in every build configuration.
+    class Profiler {
+    public:
+        static constexpr std::size_t BufferCapacity = std::size_t{ 1 } << 15; // events per thread, a power of two
+
+        struct ThreadEvents {
+            std::uint32_t threadId;   // registration order, stable for the life of the process
+            std::string name;
+            std::vector<ProfileEvent> events; // in completion order
+        };
+
+        static bool IsEnabled() noexcept { return s_Enabled.load(std::memory_order_relaxed); }
+        static void SetEnabled(bool enabled) noexcept { s_Enabled.store(enabled, std::memory_order_relaxed); }
+
+        // rdtsc where available, steady_clock nanoseconds elsewhere
+        static std::uint64_t Now() noexcept
+        {
+#ifdef QUANTOM_PROFILER_RDTSC
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        // Converts ticks to nanoseconds since the profiler started. The rdtsc rate is calibrated
+        // against steady_clock and gets more precise the longer the process runs.
+        static double ToNanoseconds(std::uint64_t ticks);
+        static double TicksPerNanosecond();
+
+        static void Record(const ZoneSite* site, std::uint64_t begin, std::uint64_t end) noexcept;
+
+        // Name shown for the calling thread, e.g. "Main" or "Worker 3"
+        static void SetThreadName(std::string name);
+
+        // Copies the events of every thread that has recorded, keeping those that ended at or after since.
+        // Only the matching tail of each ring is copied, so polling with the last call's time is cheap.
+        // Safe while other threads keep recording: events overwritten during the copy are left out.
+        static std::vector<ThreadEvents> Collect(std::uint64_t since = 0);
+
+        // Chrome/Perfetto trace-event JSON of the zones that ended in the windowSeconds up to end (a Now()
+        // value, e.g. taken when the user asked for the trace), one track per thread. Loads in
+        // ui.perfetto.dev and chrome://tracing.
+        static std::string ExportTrace(double windowSeconds, std::uint64_t end);
+        static std::string ExportTrace(double windowSeconds) { return ExportTrace(windowSeconds, Now()); }
+
+    private:
+        inline static std::atomic<bool> s_Enabled{ true };
+    };
+
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const ZoneSite& site) noexcept
+            : m_site(&site), m_begin(Profiler::IsEnabled() ? Profiler::Now() : 0)
+        {
+        }
+
+        ~ProfileScope()
+        {
+            if (m_begin != 0)
+                Profiler::Record(m_site, m_begin, Profiler::Now());
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const ZoneSite* m_site;
+        std::uint64_t m_begin;
+    };
+
+} // namespace core
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core {
+
+    // Encoding a file was stored in, the editor always works on UTF-8
+    enum class TextEncoding {
+        Utf8,
+        Utf8Bom,
+        Utf16LE,
+        Utf16BE,
+        Latin1
+    };
+
+    const char* ToString(TextEncoding encoding) noexcept;
+
+    // Detects the encoding of raw file contents from their byte order mark, else by validating them as
+    // UTF-8, and converts them to UTF-8 in place. Contents that are not valid UTF-8 are taken as Latin-1.
+    // Plain UTF-8, by far the common case, is only scanned.
+    TextEncoding DecodeText(std::string& text);
+
+    // The reverse of DecodeText: converts UTF-8 text to encoding, with the byte order mark DecodeText
+    // recognises it by. Characters encoding cannot represent, only possible for Latin-1, become '?'.
+    std::string EncodeText(std::string_view text, TextEncoding encoding);
+
+    // False if EncodeText would have to replace characters of text
+    bool CanEncode(std::string_view text, TextEncoding encoding) noexcept;
+
+    bool IsValidUtf8(std::string_view text) noexcept;
+
+    // Offset of the first character of every line, starting with 0
+    std::vector<std::size_t> IndexLines(std::string_view text);
+
+} // namespace core
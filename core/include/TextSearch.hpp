@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core {
+
+    struct SearchOptions {
+        bool regex = false;
+        bool caseSensitive = true; // ASCII letters only when false
+    };
+
+    // Line-oriented text search. Literal patterns are found with a SIMD filter on the first and last byte
+    // of the needle, regular expressions run through a DFA that is built lazily from the pattern's NFA as
+    // bytes are seen, so every input byte costs one table lookup. When every match of an expression has to
+    // contain some literal, only the lines the literal search finds go through the DFA. A match never
+    // spans a line break.
+    //
+    // Supported syntax: literals, escapes, '.', [classes] with ranges and negation, \d \w \s and their
+    // negations, ^ and $ at line boundaries, grouping, '|', and the quantifiers * + ? {m} {m,} {m,n}.
+    //
+    // Copies share the compiled pattern, each keeps its own DFA cache: use one copy per thread.
+    class TextSearcher {
+    public:
+        struct LineMatch {
+            std::size_t line;       // 0-based
+            std::size_t lineOffset; // offset of the line's first byte in the searched text
+            std::size_t lineLength; // without the '\n'
+            std::size_t column;     // byte offset of the first match in the line
+            std::size_t length;     // of the first match, the longest one starting at column
+        };
+
+        // Returns false to stop the search
+        using LineCallback = std::function<bool(const LineMatch& match)>;
+
+        // Empty if the pattern is empty or not a valid expression, error then says why
+        static std::optional<TextSearcher> create(std::string_view pattern, SearchOptions options, std::string* error = nullptr);
+
+        TextSearcher(const TextSearcher& other);
+        TextSearcher& operator=(const TextSearcher& other);
+        TextSearcher(TextSearcher&&) noexcept;
+        TextSearcher& operator=(TextSearcher&&) noexcept;
+        ~TextSearcher();
+
+        // Calls onMatch for every line of text that contains a match, in order, and returns the number of
+        // line breaks in the part of text that was searched
+        std::size_t forEachMatchingLine(std::string_view text, const LineCallback& onMatch);
+
+        const std::string& getPattern() const noexcept { return m_Pattern; }
+        const SearchOptions& getOptions() const noexcept { return m_Options; }
+
+        // Offset of the first occurrence of needle in text at or after from, npos if there is none
+        static std::size_t FindLiteral(std::string_view text, std::string_view needle, bool caseSensitive, std::size_t from = 0) noexcept;
+
+    private:
+        struct Program; // compiled NFA
+        class Dfa;
+
+        TextSearcher(std::string pattern, SearchOptions options, std::shared_ptr<const Program> program);
+
+        std::size_t searchLiteral(std::string_view literal, std::string_view text, const LineCallback& onMatch);
+        std::size_t searchRegex(std::string_view text, const LineCallback& onMatch);
+        bool firstMatchInLine(std::string_view line, std::size_t& column, std::size_t& length);
+
+        std::string m_Pattern;
+        SearchOptions m_Options;
+        std::shared_ptr<const Program> m_Program; // null for literal patterns
+        std::unique_ptr<Dfa> m_Search;            // unanchored, finds the lines that match
+        std::unique_ptr<Dfa> m_Extent;            // anchored, measures a match from a start position
+    };
+
+} // namespace core
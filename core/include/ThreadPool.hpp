@@ -1,36 +1,194 @@
-#pragma once
-
-#include <functional>
-#include <future>
-#include <vector>
-#include <queue>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <atomic>
-
-namespace core {
-
-    class ThreadPool {
-    public:
-        ThreadPool() {}
-     //   explicit ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency());
-        ~ThreadPool(){};
-
-        template<typename Func, typename... Args>
-        auto enqueue(Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>;
-
-        void waitIdle();
-
-    private:
-        void workerLoop();
-
-        std::vector<std::thread> m_workers;
-        std::queue<std::function<void()>> m_tasks;
-
-        std::mutex m_mutex;
-        std::condition_variable m_condition;
-        std::atomic<bool> m_stop{ false };
-    };
-
-} // namespace core
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "WorkStealingDeque.hpp"
+
+namespace core {
+
+    // Scheduling class of a task. Workers prefer higher classes but every few picks start with a
+    // lower one, so background work still progresses under a steady stream of interactive tasks.
+    enum class TaskPriority {
+        Interactive, // latency sensitive, e.g. re-highlighting visible lines, completion filtering
+        Normal,
+        Background   // indexing, scanning, PCH builds
+    };
+
+    // Cooperative cancellation flag shared by copies. A task whose token is cancelled before it starts is
+    // skipped and its future throws TaskCancelled; running tasks poll isCancelled() to stop early.
+    class CancellationToken {
+    public:
+        CancellationToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+        void cancel() noexcept { m_cancelled->store(true, std::memory_order_relaxed); }
+        bool isCancelled() const noexcept { return m_cancelled->load(std::memory_order_relaxed); }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> m_cancelled;
+    };
+
+    struct TaskCancelled : std::runtime_error {
+        TaskCancelled() : std::runtime_error("task cancelled") {}
+    };
+
+    // Work-stealing thread pool. Every worker owns a Chase-Lev deque: tasks enqueued from inside a
+    // task go to the current worker's deque without locking, idle workers steal from the others.
+    // Only submissions from threads outside the pool go through the shared injection queue.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency());
+        ~ThreadPool(); // runs the remaining tasks, then joins
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Scheduler counters, a snapshot of relaxed atomics
+        struct Stats {
+            std::size_t queued;    // waiting to run
+            std::size_t running;
+            std::size_t stolen;    // total tasks taken from another worker's deque
+            std::size_t cancelled; // total tasks skipped because their token was cancelled
+            std::size_t completed; // total tasks run
+        };
+
+        template<typename Func, typename... Args>
+        auto enqueue(Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>;
+
+        template<typename Func, typename... Args>
+        auto enqueue(TaskPriority priority, Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>;
+
+        template<typename Func, typename... Args>
+        auto enqueue(TaskPriority priority, CancellationToken token, Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>;
+
+        // Blocks until every enqueued task has finished. Must not be called from a pool task.
+        void waitIdle();
+
+        // Waits for a future or shared_future. On a worker thread other tasks are run meanwhile, so a
+        // task can wait for the tasks it spawned without blocking a worker. With nothing to run it parks
+        // on the future for a slice at a time, waiting on a long job such as a compile costs no CPU.
+        template<typename Future>
+        void waitFor(const Future& future);
+
+        // Runs one queued task on the calling thread, false if there was none
+        bool tryRunPendingTask();
+
+        std::size_t getThreadCount() const noexcept { return m_workers.size(); }
+        Stats getStats() const noexcept;
+
+        // Index of the calling worker in its pool, -1 outside a pool
+        static int getCurrentWorkerIndex() noexcept;
+
+    private:
+        using Task = std::function<void()>;
+
+        static constexpr std::size_t PriorityCount = 3;
+        // Longest a waiting worker parks before it looks for tasks again, the slices start short and double
+        static constexpr std::chrono::microseconds MinWaitSlice{ 50 };
+        static constexpr std::chrono::microseconds MaxWaitSlice{ 4000 };
+
+        struct Worker {
+            std::array<WorkStealingDeque<Task>, PriorityCount> deques; // one per TaskPriority
+            unsigned picks = 0; // owner only, drives the starvation protection
+        };
+
+        int currentIndex() const noexcept; // worker index if the caller is one of this pool's workers, else -1
+        void submit(std::unique_ptr<Task> task, TaskPriority priority);
+        void workerLoop(std::size_t index);
+        Task* findTask(int index);
+        Task* findTask(int index, std::size_t priority);
+        void runTask(Task* task);
+        bool hasQueuedTasks() const;
+
+        std::vector<std::thread> m_workers;
+        std::vector<std::unique_ptr<Worker>> m_queues;
+
+        std::array<std::queue<Task*>, PriorityCount> m_tasks; // injection queues for submissions from outside the pool
+        std::atomic<std::size_t> m_injected{ 0 };
+        mutable std::mutex m_mutex;
+
+        std::atomic<std::size_t> m_queued{ 0 };
+        std::atomic<std::size_t> m_running{ 0 };
+        std::atomic<std::size_t> m_stolen{ 0 };
+        std::atomic<std::size_t> m_cancelled{ 0 };
+        std::atomic<std::size_t> m_completed{ 0 };
+
+        std::mutex m_sleepMutex;
+        std::condition_variable m_condition;
+        std::atomic<std::size_t> m_sleeping{ 0 };
+        std::size_t m_wakeups = 0; // guarded by m_sleepMutex
+
+        std::atomic<std::size_t> m_pending{ 0 }; // enqueued and not finished
+        std::mutex m_idleMutex;
+        std::condition_variable m_idleCondition;
+
+        std::atomic<bool> m_stop{ false };
+    };
+
+    template<typename Func, typename... Args>
+    auto ThreadPool::enqueue(Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>
+    {
+        return enqueue(TaskPriority::Normal, std::forward<Func>(func), std::forward<Args>(args)...);
+    }
+
+    template<typename Func, typename... Args>
+    auto ThreadPool::enqueue(TaskPriority priority, Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>
+    {
+        using Result = std::invoke_result_t<Func, Args...>;
+
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(
+            [func = std::forward<Func>(func), ... args = std::forward<Args>(args)]() mutable -> Result {
+                return std::invoke(std::move(func), std::move(args)...);
+            });
+
+        std::future<Result> future = packaged->get_future();
+        submit(std::make_unique<Task>([packaged = std::move(packaged)]() { (*packaged)(); }), priority);
+        return future;
+    }
+
+    template<typename Func, typename... Args>
+    auto ThreadPool::enqueue(TaskPriority priority, CancellationToken token, Func&& func, Args&&... args) -> std::future<std::invoke_result_t<Func, Args...>>
+    {
+        using Result = std::invoke_result_t<Func, Args...>;
+
+        return enqueue(priority, [this, token = std::move(token), func = std::forward<Func>(func), ... args = std::forward<Args>(args)]() mutable -> Result {
+            if (token.isCancelled()) {
+                m_cancelled.fetch_add(1, std::memory_order_relaxed);
+                throw TaskCancelled();
+            }
+            return std::invoke(std::move(func), std::move(args)...);
+        });
+    }
+
+    template<typename Future>
+    void ThreadPool::waitFor(const Future& future)
+    {
+        if (currentIndex() < 0) {
+            future.wait();
+            return;
+        }
+
+        std::chrono::microseconds slice = MinWaitSlice;
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (tryRunPendingTask()) {
+                slice = MinWaitSlice;
+                continue;
+            }
+            if (future.wait_for(slice) == std::future_status::ready)
+                return;
+            slice = std::min(slice * 2, MaxWaitSlice);
+        }
+    }
+
+} // namespace core
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace core {
+
+    // Chase-Lev work-stealing deque of pointers (Le, Pop, Cohen, Zappa Nardelli: "Correct and
+    // Efficient Work-Stealing for Weak Memory Models"). The owning thread pushes and pops at the
+    // bottom without locking, any other thread steals from the top with a single CAS.
+    template<typename T>
+    class WorkStealingDeque {
+    public:
+        explicit WorkStealingDeque(std::size_t capacity = 256)
+            : m_Array(new Array(roundUp(capacity)))
+        {
+            m_Arrays.emplace_back(m_Array.load(std::memory_order_relaxed));
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // Owner thread only
+        void push(T* item)
+        {
+            const std::int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+            const std::int64_t top = m_Top.load(std::memory_order_acquire);
+            Array* array = m_Array.load(std::memory_order_relaxed);
+
+            if (bottom - top > static_cast<std::int64_t>(array->capacity) - 1)
+                array = grow(array, bottom, top);
+
+            array->store(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_Bottom.store(bottom + 1, std::memory_order_seq_cst);
+        }
+
+        // Owner thread only, newest item first. nullptr if empty.
+        T* pop()
+        {
+            const std::int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+            Array* array = m_Array.load(std::memory_order_relaxed);
+            m_Bottom.store(bottom, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t top = m_Top.load(std::memory_order_seq_cst);
+
+            if (top > bottom) {
+                m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T* item = array->load(bottom);
+            if (top == bottom) {
+                // Last item, race the thieves for it
+                if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    item = nullptr;
+                m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        // Any thread, oldest item first. nullptr if empty or another thread won the race.
+        T* steal()
+        {
+            std::int64_t top = m_Top.load(std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t bottom = m_Bottom.load(std::memory_order_seq_cst);
+
+            if (top >= bottom)
+                return nullptr;
+
+            Array* array = m_Array.load(std::memory_order_acquire);
+            T* item = array->load(top);
+            if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return item;
+        }
+
+        bool empty() const noexcept { return size() == 0; }
+
+        std::size_t size() const noexcept
+        {
+            const std::int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+            const std::int64_t top = m_Top.load(std::memory_order_relaxed);
+            return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+        }
+
+    private:
+        struct Array {
+            explicit Array(std::size_t size) : capacity(size), mask(size - 1), slots(new std::atomic<T*>[size]) {}
+
+            T* load(std::int64_t index) const { return slots[static_cast<std::size_t>(index) & mask].load(std::memory_order_relaxed); }
+            void store(std::int64_t index, T* item) { slots[static_cast<std::size_t>(index) & mask].store(item, std::memory_order_relaxed); }
+
+            std::size_t capacity;
+            std::size_t mask;
+            std::unique_ptr<std::atomic<T*>[]> slots;
+        };
+
+        static std::size_t roundUp(std::size_t capacity)
+        {
+            std::size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            return size;
+        }
+
+        // Thieves may still read the old array, so it is kept until the deque is destroyed
+        Array* grow(Array* array, std::int64_t bottom, std::int64_t top)
+        {
+            auto bigger = std::make_unique<Array>(array->capacity * 2);
+            for (std::int64_t i = top; i < bottom; ++i)
+                bigger->store(i, array->load(i));
+
+            Array* result = bigger.get();
+            m_Arrays.push_back(std::move(bigger));
+            m_Array.store(result, std::memory_order_release);
+            return result;
+        }
+
+        alignas(64) std::atomic<std::int64_t> m_Top{ 0 };
+        alignas(64) std::atomic<std::int64_t> m_Bottom{ 0 };
+        alignas(64) std::atomic<Array*> m_Array;
+        std::vector<std::unique_ptr<Array>> m_Arrays; // owner only
+    };
+
+} // namespace core
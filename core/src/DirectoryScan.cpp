@@ -0,0 +1,134 @@
+#include "DirectoryScan.hpp"
+#include "FileSystem.hpp"
+#include "ThreadPool.hpp"
+
+using namespace core;
+namespace fs = std::filesystem;
+
+// Files are delivered in batches of at least this size, the remainder when the walk ends
+static constexpr std::size_t kBatchSize = 256;
+
+DirectoryScan::DirectoryScan(ThreadPool& pool, const fs::path& root, ScanOptions options, Callback callback, FinishedCallback onFinished)
+	: m_Pool(pool)
+	, m_Exclude(options.excludeGlobs)
+	, m_Options(std::move(options))
+	, m_Callback(std::move(callback))
+	, m_OnFinished(std::move(onFinished))
+	, m_Done(std::make_shared<std::promise<void>>())
+	, m_DoneFuture(m_Done->get_future())
+{
+	spawn({ root, std::string(), nullptr });
+}
+
+DirectoryScan::~DirectoryScan()
+{
+	cancel();
+	wait();
+}
+
+void DirectoryScan::cancel()
+{
+	m_Cancelled.store(true);
+}
+
+void DirectoryScan::wait()
+{
+	m_Pool.waitFor(m_DoneFuture);
+}
+
+void DirectoryScan::spawn(Task task)
+{
+	m_Outstanding.fetch_add(1, std::memory_order_relaxed);
+	m_Pool.enqueue(TaskPriority::Background, [this, task = std::move(task)]() {
+		if (!m_Cancelled.load(std::memory_order_relaxed))
+			process(task);
+
+		// The last directory finishing ends the walk
+		auto done = m_Done;
+		if (m_Outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::vector<fs::path> rest;
+			deliver(rest, true);
+			if (m_OnFinished)
+				m_OnFinished();
+			m_Finished.store(true, std::memory_order_release);
+			done->set_value(); // the scan may be destroyed from here on
+		}
+	});
+}
+
+void DirectoryScan::process(const Task& task)
+{
+	std::shared_ptr<const IgnoreChain> ignore = task.ignore;
+	const std::string prefix = task.relative.empty() ? std::string() : task.relative + "/";
+
+	if (m_Options.useGitignore) {
+		auto gitignore = FileSystem::readFile(task.directory / ".gitignore");
+		if (gitignore.has_value()) {
+			PathMatcher matcher = PathMatcher::fromGitignore(gitignore.value());
+			if (!matcher.empty())
+				ignore = std::make_shared<const IgnoreChain>(IgnoreChain{ std::move(matcher), prefix.size(), std::move(ignore) });
+		}
+	}
+
+	std::vector<fs::path> files;
+	std::error_code ec;
+	for (fs::directory_iterator it(task.directory, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+		if (m_Cancelled.load(std::memory_order_relaxed))
+			return;
+
+		std::string name = it->path().filename().string();
+		if (name == ".git")
+			continue;
+
+		std::error_code typeEc;
+		const bool isDirectory = it->is_directory(typeEc) && !it->is_symlink(typeEc);
+		if (!isDirectory && !it->is_regular_file(typeEc))
+			continue;
+
+		std::string relative = prefix + name;
+		if (m_Exclude.isIgnored(relative, isDirectory) || isIgnored(ignore.get(), relative, isDirectory))
+			continue;
+
+		if (isDirectory)
+			spawn({ it->path(), std::move(relative), ignore });
+		else
+			files.push_back(it->path());
+	}
+
+	if (!files.empty())
+		deliver(files, false);
+}
+
+void DirectoryScan::deliver(std::vector<fs::path>& files, bool final)
+{
+	std::vector<fs::path> batch;
+	{
+		std::lock_guard<std::mutex> lock(m_BatchMutex);
+		if (m_Batch.empty())
+			m_Batch.swap(files);
+		else
+			m_Batch.insert(m_Batch.end(), std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()));
+
+		if (m_Batch.empty() || (!final && m_Batch.size() < kBatchSize))
+			return;
+		batch.swap(m_Batch);
+	}
+
+	if (m_Cancelled.load(std::memory_order_relaxed))
+		return;
+
+	m_FileCount.fetch_add(batch.size(), std::memory_order_relaxed);
+	if (m_Callback)
+		m_Callback(std::move(batch));
+}
+
+// The deepest .gitignore with a matching pattern decides, like git does
+bool DirectoryScan::isIgnored(const IgnoreChain* chain, const std::string& relative, bool isDirectory) const
+{
+	for (; chain; chain = chain->parent.get()) {
+		const auto result = chain->matcher.match(std::string_view(relative).substr(chain->baseLength), isDirectory);
+		if (result != PathMatcher::Result::None)
+			return result == PathMatcher::Result::Ignored;
+	}
+	return false;
+}
@@ -0,0 +1,170 @@
+#include "EventBus.hpp"
+
+#include <algorithm>
+
+using namespace core;
+
+// Subscription ids carry their EventId in the low bits, so unsubscribe only searches one list
+static constexpr unsigned kIdShift = 16;
+
+static std::size_t SlotOf(EventBus::SubscriptionId id)
+{
+	return static_cast<std::size_t>(id & ((EventBus::SubscriptionId{ 1 } << kIdShift) - 1));
+}
+
+EventBus::EventBus(std::pmr::memory_resource* resource)
+	: m_resource(resource)
+	, m_head(&m_stub)
+	, m_tail(&m_stub)
+{
+}
+
+EventBus::~EventBus()
+{
+	while (Node* node = pop())
+		node->destroy(node, m_resource);
+}
+
+void EventBus::unsubscribe(SubscriptionId id)
+{
+	const std::size_t slot = SlotOf(id);
+	if (slot >= EventCount)
+		return;
+
+	for (Subscription& subscription : m_handlers[slot]) {
+		if (subscription.id == id) {
+			subscription.active = false;
+			m_needsCompaction = true;
+		}
+	}
+	for (auto& added : m_added) {
+		if (added.second.id == id)
+			added.second.active = false;
+	}
+
+	if (m_dispatchDepth == 0)
+		DispatchScope{ *this }; // compacts right away
+}
+
+std::size_t EventBus::dispatchQueued()
+{
+	// A handler draining the queue again would reuse the batches being dispatched
+	if (m_dispatchDepth > 0)
+		return 0;
+
+	std::size_t count = 0;
+	while (Node* node = pop()) {
+		m_batches[static_cast<std::size_t>(node->id)].push_back(node);
+		++count;
+	}
+	if (count == 0)
+		return 0;
+	m_queued.fetch_sub(count, std::memory_order_relaxed);
+
+	// If a handler throws, the events not delivered yet are dropped, not left in the batches
+	struct DropUndelivered {
+		EventBus& bus;
+		~DropUndelivered()
+		{
+			for (auto& batch : bus.m_batches) {
+				for (Node* node : batch) {
+					if (node)
+						node->destroy(node, bus.m_resource);
+				}
+				batch.clear();
+			}
+		}
+	} drop{ *this };
+
+	DispatchScope scope(*this);
+	for (auto& batch : m_batches) {
+		for (Node*& node : batch) {
+			dispatch(node->id, node->event);
+			node->destroy(node, m_resource);
+			node = nullptr;
+		}
+	}
+
+	return count;
+}
+
+EventBus::SubscriptionId EventBus::add(EventId id, Handler handler)
+{
+	const SubscriptionId subscriptionId = (m_nextId++ << kIdShift) | static_cast<SubscriptionId>(id);
+	Subscription subscription{ subscriptionId, true, std::move(handler) };
+
+	// Appending could move a handler that is running right now
+	if (m_dispatchDepth > 0)
+		m_added.emplace_back(id, std::move(subscription));
+	else
+		m_handlers[static_cast<std::size_t>(id)].push_back(std::move(subscription));
+	return subscriptionId;
+}
+
+void EventBus::dispatch(EventId id, const void* event)
+{
+	const std::vector<Subscription>& handlers = m_handlers[static_cast<std::size_t>(id)];
+	for (const Subscription& subscription : handlers) {
+		if (subscription.active)
+			subscription.handler(event);
+	}
+}
+
+void EventBus::endDispatch()
+{
+	if (--m_dispatchDepth > 0)
+		return;
+
+	if (m_needsCompaction) {
+		for (auto& handlers : m_handlers)
+			handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [](const Subscription& subscription) { return !subscription.active; }), handlers.end());
+		m_needsCompaction = false;
+	}
+
+	for (auto& added : m_added) {
+		if (added.second.active)
+			m_handlers[static_cast<std::size_t>(added.first)].push_back(std::move(added.second));
+	}
+	m_added.clear();
+}
+
+void EventBus::push(Node* node)
+{
+	node->next.store(nullptr, std::memory_order_relaxed);
+
+	Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+}
+
+EventBus::Node* EventBus::pop()
+{
+	Node* tail = m_tail;
+	Node* next = tail->next.load(std::memory_order_acquire);
+
+	if (tail == &m_stub) {
+		if (!next)
+			return nullptr;
+		m_tail = next;
+		tail = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+
+	if (next) {
+		m_tail = next;
+		return tail;
+	}
+
+	// tail is the last node unless a producer is between its exchange and the link, then it is
+	// picked up by the next drain
+	if (tail != m_head.load(std::memory_order_acquire))
+		return nullptr;
+
+	push(&m_stub);
+
+	next = tail->next.load(std::memory_order_acquire);
+	if (next) {
+		m_tail = next;
+		return tail;
+	}
+	return nullptr;
+}
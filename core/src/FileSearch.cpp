@@ -0,0 +1,169 @@
+#include "FileSearch.hpp"
+#include "FileSystem.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace core;
+namespace fs = std::filesystem;
+
+// Files are searched in place in chunks of this size, cut back to the end of their last line
+static constexpr std::size_t kChunkSize = std::size_t{ 1 } << 20;
+// Like grep, a NUL byte near the start marks a file as binary
+static constexpr std::size_t kBinaryProbeSize = 8192;
+// Bytes shown before the match when a long line is shortened
+static constexpr std::size_t kPreviewContext = 40;
+
+static FileSearch::LineResult MakeLineResult(std::string_view text, const TextSearcher::LineMatch& match, std::size_t firstLine)
+{
+	std::string_view line = text.substr(match.lineOffset, match.lineLength);
+	if (!line.empty() && line.back() == '\r')
+		line.remove_suffix(1);
+
+	const std::size_t column = std::min(match.column, line.size());
+	std::size_t first = 0;
+	if (line.size() > FileSearch::MaxPreviewLength) {
+		first = column > kPreviewContext ? column - kPreviewContext : 0;
+		while (first > 0 && (static_cast<unsigned char>(line[first]) & 0xC0) == 0x80)
+			--first; // not inside a UTF-8 sequence
+		line = line.substr(first, FileSearch::MaxPreviewLength);
+	}
+
+	return { firstLine + match.line, match.column, match.length, std::string(line), column - first };
+}
+
+FileSearch::FileSearch(ThreadPool& pool, const fs::path& root, TextSearcher searcher, ScanOptions options, Callback callback, FinishedCallback onFinished)
+	: m_Pool(pool)
+	, m_Searcher(std::move(searcher))
+	, m_Callback(std::move(callback))
+	, m_OnFinished(std::move(onFinished))
+	, m_Done(std::make_shared<std::promise<void>>())
+	, m_DoneFuture(m_Done->get_future())
+{
+	// The walk holds one count until it is over, so the search cannot finish between two batches
+	m_Scan = FileSystem::scan(pool, root, std::move(options),
+		[this](std::vector<fs::path>&& files) {
+			if (m_Cancelled.load(std::memory_order_relaxed))
+				return;
+			m_Outstanding.fetch_add(1, std::memory_order_relaxed);
+			m_Pool.enqueue(TaskPriority::Normal, [this, files = std::move(files)]() {
+				if (!m_Cancelled.load(std::memory_order_relaxed))
+					searchFiles(files);
+				finishTask();
+			});
+		},
+		[this]() { finishTask(); });
+}
+
+FileSearch::~FileSearch()
+{
+	cancel();
+	wait();
+}
+
+void FileSearch::cancel()
+{
+	m_Cancelled.store(true);
+	if (m_Scan)
+		m_Scan->cancel();
+}
+
+void FileSearch::wait()
+{
+	m_Pool.waitFor(m_DoneFuture);
+}
+
+void FileSearch::finishTask()
+{
+	auto done = m_Done;
+	if (m_Outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		if (m_OnFinished)
+			m_OnFinished();
+		m_Finished.store(true, std::memory_order_release);
+		done->set_value(); // the search may be destroyed from here on
+	}
+}
+
+void FileSearch::searchFiles(const std::vector<fs::path>& files)
+{
+	PROFILE_ZONE("FileSearch::searchFiles");
+
+	TextSearcher searcher = m_Searcher; // with a DFA cache of its own
+	for (const fs::path& path : files) {
+		if (m_Cancelled.load(std::memory_order_relaxed))
+			return;
+		searchFile(path, searcher);
+	}
+}
+
+void FileSearch::searchFile(const fs::path& path, TextSearcher& searcher)
+{
+	auto mapped = FileSystem::mapFile(path);
+	if (!mapped.has_value())
+		return;
+
+	m_FileCount.fetch_add(1, std::memory_order_relaxed);
+	const std::size_t size = mapped->size();
+
+	FileResult result{ path, {}, false };
+	std::size_t offset = 0;    // of the first line not searched yet
+	std::size_t firstLine = 0; // its line number
+	std::size_t window = kChunkSize;
+	bool binary = false;
+
+	while (offset < size) {
+		const std::size_t count = std::min(window, size - offset);
+		const bool last = offset + count == size;
+		std::size_t searched = 0;
+
+		// The chunk is searched right in the mapping, only the matching lines are copied out
+		const bool read = mapped->view(offset, count, [&](std::string_view chunk) {
+			if (offset == 0 && std::memchr(chunk.data(), '\0', std::min(chunk.size(), kBinaryProbeSize))) {
+				binary = true;
+				return;
+			}
+
+			std::size_t end = chunk.size();
+			if (!last) {
+				const std::size_t lineBreak = chunk.rfind('\n');
+				if (lineBreak == std::string_view::npos)
+					return; // a line longer than the window, searched with a wider one
+				end = lineBreak + 1;
+			}
+
+			const std::string_view text = chunk.substr(0, end);
+			const std::size_t lineBreaks = searcher.forEachMatchingLine(text, [&](const TextSearcher::LineMatch& match) {
+				if (result.lines.size() == MaxLinesPerFile) {
+					result.truncated = true;
+					return false;
+				}
+				result.lines.push_back(MakeLineResult(text, match, firstLine));
+				return !m_Cancelled.load(std::memory_order_relaxed);
+			});
+			firstLine += lineBreaks;
+			searched = end;
+		});
+
+		// A file truncated while it is searched is dropped, the view showed zeros past its new end
+		if (!read || binary || m_Cancelled.load(std::memory_order_relaxed))
+			return;
+		m_ByteCount.fetch_add(searched, std::memory_order_relaxed);
+		if (result.truncated)
+			break;
+
+		if (searched == 0) {
+			window *= 2;
+			continue;
+		}
+		offset += searched;
+		window = kChunkSize;
+	}
+
+	if (result.lines.empty())
+		return;
+	m_MatchCount.fetch_add(result.lines.size(), std::memory_order_relaxed);
+	if (m_Callback)
+		m_Callback(std::move(result));
+}
@@ -1,114 +1,504 @@
-#include "FileSystem.hpp"
-#include "Platform.hpp"
-
-#include <fstream>
-#include <vector>
-#include <system_error>
-
-using namespace core;
-
-bool FileSystem::exists(const std::filesystem::path& path)
-{
-	return std::filesystem::exists(path);
-}
-
-bool FileSystem::createDirectory(const std::filesystem::path& path)
-{
-	std::error_code ec;
-	bool created = std::filesystem::create_directory(path);
-	return created && !ec;
-}
-
-bool FileSystem::remove(const std::filesystem::path& path)
-{
-	std::error_code ec;
-	bool removed = std::filesystem::remove_all(path, ec) > 0;
-	return removed && !ec;
-}
-
-std::optional<std::string> FileSystem::readFile(const std::filesystem::path& filePath)
-{
-	std::ifstream file(filePath, std::ios::binary);
-	if (!file)
-		return std::nullopt;
-
-	std::string contents;
-	file.seekg(0, std::ios::end);
-	contents.resize(file.tellg());
-	file.seekg(0, std::ios::beg);
-	file.read(&contents[0], contents.size());
-	return contents;
-}
-
-bool FileSystem::writeFile(const std::filesystem::path& filePath, std::string_view content)
-{
-	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
-	if (!file)
-		return false;
-
-	file.write(content.data(), content.size());
-	return file.good();
-}
-
-std::vector<std::filesystem::path> FileSystem::listFiles(const std::filesystem::path& directory, bool recursive)
-{
-	std::vector<std::filesystem::path> files;
-	std::error_code ec;
-
-	if (recursive)
-	{
-		for (auto& entry : std::filesystem::recursive_directory_iterator(directory, ec))
-		{
-			if (!ec && entry.is_regular_file())
-				files.push_back(entry.path());
-		}
-	}
-	else
-	{
-		for (auto& entry : std::filesystem::directory_iterator(directory, ec))
-		{
-			if (!ec && entry.is_regular_file())
-				files.push_back(entry.path());
-		}
-	}
-	return files;
-}
-
-std::optional<std::filesystem::path> FileSystem::openFile(std::filesystem::path path)
-{
-	return Platform::openFileDialog();
-}
-
-std::optional<std::filesystem::path> FileSystem::saveFile(std::string& buffer, std::filesystem::path path)
-{
-	if (!path.empty())
-	{
-		std::ofstream out(path);
-		if (!out.is_open())
-			return std::nullopt;
-
-		out << buffer;
-		return path;
-	}
-	else
-	{
-		auto maybePath = Platform::saveFileDialog();
-		if (!maybePath)
-			return std::nullopt;
-
-		std::ofstream out(*maybePath);
-		if (!out.is_open())
-			return std::nullopt;
-
-		out << buffer;
-		return maybePath;
-	}
-}
-
-
-
-std::optional<std::filesystem::path> FileSystem::openFolder(std::filesystem::path path)
-{
-
-	return Platform::folderDialog();
-}
+#include "FileSystem.hpp"
+#include "Platform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <system_error>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <process.h>
+#else
+#include <csetjmp>
+#include <csignal>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace core;
+
+namespace {
+
+#ifdef _WIN32
+	// SEH cannot share a function with C++ objects that need unwinding
+	bool GuardedCopy(char* out, const char* in, std::size_t count)
+	{
+#ifdef _MSC_VER
+		__try {
+			std::memcpy(out, in, count);
+			return true;
+		}
+		__except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+			return false;
+		}
+#else
+		std::memcpy(out, in, count);
+		return true;
+#endif
+	}
+#else
+	// A SIGBUS raised while a thread copies out of a mapping jumps back into MappedFile::copy.
+	// volatile, or the store before memcpy would be dropped as dead.
+	thread_local sigjmp_buf* volatile t_FaultGuard = nullptr;
+	// MappedFile::view runs arbitrary code on the mapping, jumping out of it would skip destructors.
+	// A fault inside the viewed range gets a zero page mapped over it instead and the access repeats.
+	thread_local const char* volatile t_ViewBegin = nullptr;
+	thread_local const char* volatile t_ViewEnd = nullptr;
+	thread_local volatile std::sig_atomic_t t_ViewFaulted = 0;
+	struct sigaction s_PreviousBusAction;
+	std::once_flag s_BusHandlerInstalled;
+	std::uintptr_t s_PageSize = 4096; // sysconf is not async-signal-safe, read on install
+
+	void OnBusError(int, siginfo_t* info, void*)
+	{
+		if (sigjmp_buf* guard = t_FaultGuard)
+			siglongjmp(*guard, 1);
+
+		const char* address = static_cast<const char*>(info->si_addr);
+		if (address >= t_ViewBegin && address < t_ViewEnd) {
+			void* page = reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(address) & ~(s_PageSize - 1));
+			if (mmap(page, s_PageSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+				t_ViewFaulted = 1;
+				return;
+			}
+		}
+
+		// Not a guarded copy: restore the previous handler, the faulting access repeats and reaches it
+		sigaction(SIGBUS, &s_PreviousBusAction, nullptr);
+	}
+
+	void InstallBusHandler()
+	{
+		s_PageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+
+		struct sigaction action {};
+		action.sa_sigaction = &OnBusError;
+		action.sa_flags = SA_SIGINFO;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGBUS, &action, &s_PreviousBusAction);
+	}
+
+	bool GuardedCopy(char* out, const char* in, std::size_t count)
+	{
+		std::call_once(s_BusHandlerInstalled, InstallBusHandler);
+
+		sigjmp_buf guard;
+		if (sigsetjmp(guard, 1) != 0) { // restores the signal mask, SIGBUS is blocked inside the handler
+			t_FaultGuard = nullptr;
+			return false;
+		}
+		t_FaultGuard = &guard;
+		std::memcpy(out, in, count);
+		t_FaultGuard = nullptr;
+		return true;
+	}
+#endif
+
+	// Large writes, below the 2 GiB that Linux and WriteFile accept in one call
+	constexpr std::size_t kMaxWriteBytes = std::size_t{ 1 } << 30;
+
+	std::atomic<unsigned> s_TempCounter{ 0 };
+
+	// Hidden sibling of target, unique within the process, the pid keeps processes apart
+	std::filesystem::path TempPathFor(const std::filesystem::path& target)
+	{
+#ifdef _WIN32
+		const int pid = _getpid();
+#else
+		const int pid = static_cast<int>(getpid());
+#endif
+		std::filesystem::path temp = target;
+		temp.replace_filename("." + target.filename().string() + "." + std::to_string(pid) + "."
+			+ std::to_string(s_TempCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp");
+		return temp;
+	}
+
+#ifdef _WIN32
+	bool WriteAll(HANDLE file, const char* data, std::size_t size)
+	{
+		while (size > 0) {
+			DWORD written = 0;
+			if (!WriteFile(file, data, static_cast<DWORD>(std::min(size, kMaxWriteBytes)), &written, nullptr))
+				return false;
+			data += written;
+			size -= written;
+		}
+		return true;
+	}
+#else
+	bool WriteAll(int fd, const char* data, std::size_t size)
+	{
+		while (size > 0) {
+			const ssize_t written = ::write(fd, data, std::min(size, kMaxWriteBytes));
+			if (written < 0) {
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+			data += written;
+			size -= static_cast<std::size_t>(written);
+		}
+		return true;
+	}
+#endif
+
+}
+
+MappedFile::~MappedFile()
+{
+	release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_data(other.m_data), m_size(other.m_size)
+#ifdef _WIN32
+	, m_mapping(other.m_mapping)
+#endif
+{
+	other.m_data = nullptr;
+	other.m_size = 0;
+#ifdef _WIN32
+	other.m_mapping = nullptr;
+#endif
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other) {
+		release();
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+#ifdef _WIN32
+		std::swap(m_mapping, other.m_mapping);
+#endif
+	}
+	return *this;
+}
+
+void MappedFile::release() noexcept
+{
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	if (m_data)
+		munmap(m_data, m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+bool MappedFile::copy(std::size_t offset, std::size_t count, char* out) const noexcept
+{
+	if (offset > m_size || count > m_size - offset)
+		return false;
+	if (count == 0)
+		return true;
+	return GuardedCopy(out, data() + offset, count);
+}
+
+bool MappedFile::viewGuarded(std::size_t offset, std::size_t count, void (*visit)(void*, std::string_view), void* context) const
+{
+	if (offset > m_size || count > m_size - offset)
+		return false;
+	if (count == 0) {
+		visit(context, {});
+		return true;
+	}
+
+#ifdef _WIN32
+	thread_local std::string t_Copy;
+	t_Copy.resize(count);
+	if (!GuardedCopy(t_Copy.data(), data() + offset, count))
+		return false;
+	visit(context, t_Copy);
+	return true;
+#else
+	std::call_once(s_BusHandlerInstalled, InstallBusHandler);
+
+	// Cleared however visit ends
+	struct ViewGuard {
+		ViewGuard(const char* begin, const char* end)
+		{
+			t_ViewFaulted = 0;
+			t_ViewBegin = begin;
+			t_ViewEnd = end;
+		}
+		~ViewGuard()
+		{
+			t_ViewBegin = nullptr;
+			t_ViewEnd = nullptr;
+		}
+	} guard(data() + offset, data() + offset + count);
+
+	visit(context, std::string_view(data() + offset, count));
+	return t_ViewFaulted == 0;
+#endif
+}
+
+bool FileSystem::exists(const std::filesystem::path& path)
+{
+	return std::filesystem::exists(path);
+}
+
+bool FileSystem::createDirectory(const std::filesystem::path& path)
+{
+	std::error_code ec;
+	bool created = std::filesystem::create_directory(path);
+	return created && !ec;
+}
+
+bool FileSystem::remove(const std::filesystem::path& path)
+{
+	std::error_code ec;
+	bool removed = std::filesystem::remove_all(path, ec) > 0;
+	return removed && !ec;
+}
+
+std::optional<std::string> FileSystem::readFile(const std::filesystem::path& filePath)
+{
+	// An empty mapping may also be a file whose size the OS does not report, e.g. in /proc, read below
+	if (auto mapped = mapFile(filePath); mapped && !mapped->empty()) {
+		std::string contents(mapped->size(), '\0');
+		if (!mapped->copy(0, contents.size(), contents.data()))
+			return std::nullopt; // truncated while reading
+		return contents;
+	}
+
+	// Not mappable, e.g. a pipe: no size to go by, read until the end
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file)
+		return std::nullopt;
+
+	std::string contents;
+	char buffer[64 * 1024];
+	while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+		contents.append(buffer, static_cast<std::size_t>(file.gcount()));
+	if (file.bad())
+		return std::nullopt;
+	return contents;
+}
+
+std::optional<MappedFile> FileSystem::mapFile(const std::filesystem::path& filePath)
+{
+	MappedFile mapped;
+#ifdef _WIN32
+	HANDLE file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return std::nullopt;
+
+	LARGE_INTEGER size{};
+	if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return std::nullopt;
+	}
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return mapped;
+	}
+
+	// The mapping object keeps the file open
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		return std::nullopt;
+
+	mapped.m_mapping = mapping;
+	mapped.m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!mapped.m_data)
+		return std::nullopt;
+	mapped.m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+	const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return std::nullopt;
+
+	struct stat info {};
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+		::close(fd);
+		return std::nullopt;
+	}
+	if (info.st_size == 0) {
+		::close(fd);
+		return mapped;
+	}
+
+	void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping keeps its own reference
+	if (data == MAP_FAILED)
+		return std::nullopt;
+
+	mapped.m_data = data;
+	mapped.m_size = static_cast<std::size_t>(info.st_size);
+#endif
+	return mapped;
+}
+
+bool FileSystem::writeFile(const std::filesystem::path& filePath, std::string_view content)
+{
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+
+	file.write(content.data(), content.size());
+	return file.good();
+}
+
+bool FileSystem::writeFileAtomic(const std::filesystem::path& filePath, std::string_view content)
+{
+	// Replacing a symlink would turn it into a regular file, the file it points to is replaced instead
+	std::error_code ec;
+	std::filesystem::path target = filePath;
+	if (std::filesystem::is_symlink(filePath, ec)) {
+		target = std::filesystem::canonical(filePath, ec);
+		if (ec)
+			return false;
+	}
+
+#ifdef _WIN32
+	std::filesystem::path temp;
+	HANDLE file = INVALID_HANDLE_VALUE;
+	for (int attempt = 0; attempt < 16 && file == INVALID_HANDLE_VALUE; ++attempt) {
+		temp = TempPathFor(target);
+		file = CreateFileW(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE && GetLastError() != ERROR_FILE_EXISTS)
+			return false;
+	}
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	const bool written = WriteAll(file, content.data(), content.size()) && FlushFileBuffers(file);
+	CloseHandle(file);
+
+	// ReplaceFileW keeps the attributes, ACLs and creation time of the file it replaces
+	const bool replaced = written && (std::filesystem::exists(target, ec)
+		? ReplaceFileW(target.c_str(), temp.c_str(), nullptr, REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr)
+		: MoveFileExW(temp.c_str(), target.c_str(), MOVEFILE_WRITE_THROUGH));
+	if (!replaced)
+		DeleteFileW(temp.c_str());
+	return replaced;
+#else
+	struct stat existing {};
+	const bool exists = ::stat(target.c_str(), &existing) == 0;
+
+	// A new file gets 0666 minus the umask, as it would from ofstream
+	std::filesystem::path temp;
+	int fd = -1;
+	for (int attempt = 0; attempt < 16 && fd < 0; ++attempt) {
+		temp = TempPathFor(target);
+		fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+		if (fd < 0 && errno != EEXIST)
+			return false;
+	}
+	if (fd < 0)
+		return false;
+
+	bool written = WriteAll(fd, content.data(), content.size());
+	if (written && exists) {
+		written = fchmod(fd, existing.st_mode & 07777) == 0;
+		(void)!fchown(fd, existing.st_uid, existing.st_gid); // only possible for privileged users, best effort
+	}
+	// Data first, or the rename may reach the disk before the contents and a crash leaves an empty file
+	written = written && fsync(fd) == 0;
+	written = ::close(fd) == 0 && written;
+
+	if (!written || ::rename(temp.c_str(), target.c_str()) != 0) {
+		::unlink(temp.c_str());
+		return false;
+	}
+
+	// Makes the rename itself durable
+	const int directory = ::open(target.has_parent_path() ? target.parent_path().c_str() : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (directory >= 0) {
+		fsync(directory);
+		::close(directory);
+	}
+	return true;
+#endif
+}
+
+std::vector<std::filesystem::path> FileSystem::listFiles(const std::filesystem::path& directory, bool recursive)
+{
+	std::vector<std::filesystem::path> files;
+	std::error_code ec;
+
+	if (recursive)
+	{
+		for (auto& entry : std::filesystem::recursive_directory_iterator(directory, ec))
+		{
+			if (!ec && entry.is_regular_file())
+				files.push_back(entry.path());
+		}
+	}
+	else
+	{
+		for (auto& entry : std::filesystem::directory_iterator(directory, ec))
+		{
+			if (!ec && entry.is_regular_file())
+				files.push_back(entry.path());
+		}
+	}
+	return files;
+}
+
+std::unique_ptr<DirectoryScan> FileSystem::scan(ThreadPool& pool, const std::filesystem::path& directory, ScanOptions options,
+	DirectoryScan::Callback callback, DirectoryScan::FinishedCallback onFinished)
+{
+	return std::make_unique<DirectoryScan>(pool, directory, std::move(options), std::move(callback), std::move(onFinished));
+}
+
+std::optional<std::filesystem::path> FileSystem::openFile(std::filesystem::path path)
+{
+	return Platform::openFileDialog();
+}
+
+std::optional<std::filesystem::path> FileSystem::saveFile(const std::string& buffer, std::filesystem::path path, TextEncoding encoding)
+{
+	if (path.empty())
+	{
+		auto maybePath = Platform::saveFileDialog();
+		if (!maybePath)
+			return std::nullopt;
+		path = *maybePath;
+	}
+
+#ifdef _WIN32
+	// Documents hold LF line ends, the text-mode stream this replaced wrote them as CRLF
+	std::string content;
+	content.reserve(buffer.size() + buffer.size() / 32);
+	for (const char c : buffer)
+	{
+		if (c == '\n')
+			content += '\r';
+		content += c;
+	}
+#else
+	const std::string& content = buffer;
+#endif
+
+	const bool converted = encoding != TextEncoding::Utf8;
+	if (!writeFileAtomic(path, converted ? EncodeText(content, encoding) : content))
+		return std::nullopt;
+	return path;
+}
+
+
+
+std::optional<std::filesystem::path> FileSystem::openFolder(std::filesystem::path path)
+{
+
+	return Platform::folderDialog();
+}
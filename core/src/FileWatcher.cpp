@@ -0,0 +1,467 @@
+#include "FileWatcher.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace core;
+namespace fs = std::filesystem;
+
+// A continuous stream of events is still delivered at least this often
+static constexpr auto kMaxLatency = std::chrono::seconds(1);
+static constexpr auto kPollInterval = std::chrono::seconds(1);
+
+static fs::path NormalizeRoot(const fs::path& path)
+{
+	std::error_code ec;
+	fs::path root = fs::absolute(path, ec).lexically_normal();
+	if (!root.has_filename() && root.has_relative_path())
+		root = root.parent_path();
+	return root;
+}
+
+static bool IsWithin(const fs::path& path, const fs::path& root)
+{
+	auto pathIt = path.begin();
+	for (auto rootIt = root.begin(); rootIt != root.end(); ++rootIt, ++pathIt) {
+		if (pathIt == path.end() || *pathIt != *rootIt)
+			return false;
+	}
+	return true;
+}
+
+FileWatcher::FileWatcher(std::chrono::milliseconds debounce)
+	: m_debounce(debounce)
+{
+#ifdef __linux__
+	m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotifyFd >= 0) {
+		m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (m_wakeFd < 0) {
+			close(m_inotifyFd);
+			m_inotifyFd = -1;
+		}
+	}
+	if (m_inotifyFd < 0)
+		LOG("[FileWatcher]: inotify unavailable, falling back to polling", Log::LogLevel::Warn);
+#endif
+	m_thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	m_stop.store(true);
+	wake();
+	if (m_thread.joinable())
+		m_thread.join();
+#ifdef __linux__
+	if (m_inotifyFd >= 0)
+		close(m_inotifyFd);
+	if (m_wakeFd >= 0)
+		close(m_wakeFd);
+#endif
+}
+
+void FileWatcher::watch(const fs::path& path, Callback callback)
+{
+	const fs::path root = NormalizeRoot(path);
+	const bool recursive = fs::is_directory(root);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_watches[root] = { std::move(callback), recursive };
+		// Only the root's own watch is added here, a large tree would stall the caller
+		if (isNative())
+			addDescriptor(recursive ? root : root.parent_path());
+		if (recursive || !isNative())
+			m_registrations.push_back(root);
+	}
+	wake();
+}
+
+void FileWatcher::unwatch(const fs::path& path)
+{
+	const fs::path root = NormalizeRoot(path);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_watches.erase(root);
+	m_snapshots.erase(root);
+
+#ifdef __linux__
+	// Drop the kernel watches that no remaining root still needs
+	for (auto it = m_watchDescriptors.begin(); it != m_watchDescriptors.end();) {
+		const fs::path& directory = it->second;
+		if (!isNeeded(directory) && (IsWithin(directory, root) || directory == root.parent_path())) {
+			inotify_rm_watch(m_inotifyFd, it->first);
+			it = m_watchDescriptors.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+#endif
+}
+
+// Called with m_mutex held
+bool FileWatcher::isNeeded(const fs::path& directory) const
+{
+	return std::any_of(m_watches.begin(), m_watches.end(), [&directory](const auto& entry) {
+		return entry.second.recursive ? IsWithin(directory, entry.first) : directory == entry.first.parent_path();
+	});
+}
+
+void FileWatcher::wake()
+{
+#ifdef __linux__
+	if (m_wakeFd >= 0) {
+		const std::uint64_t one = 1;
+		[[maybe_unused]] auto written = write(m_wakeFd, &one, sizeof(one));
+	}
+#endif
+}
+
+bool FileWatcher::pollChanges()
+{
+	if (!m_hasReady.load(std::memory_order_acquire))
+		return false;
+
+	std::vector<FileChange> changes;
+	std::vector<std::pair<fs::path, Callback>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		changes.swap(m_ready);
+		m_hasReady.store(false, std::memory_order_relaxed);
+
+		callbacks.reserve(m_watches.size());
+		for (const auto& [root, watch] : m_watches)
+			callbacks.emplace_back(root, watch.callback);
+	}
+
+	// Callbacks run without the lock, they may watch or unwatch paths
+	std::vector<FileChange> matching;
+	for (const auto& [root, callback] : callbacks) {
+		matching.clear();
+		for (const auto& change : changes) {
+			if (IsWithin(change.path, root))
+				matching.push_back(change);
+		}
+		if (!matching.empty() && callback)
+			callback(matching);
+	}
+	return true;
+}
+
+void FileWatcher::run()
+{
+	auto nextPoll = Clock::now() + kPollInterval;
+
+	while (!m_stop.load()) {
+		registerWatches();
+
+		auto now = Clock::now();
+		Clock::time_point deadline = Clock::time_point::max();
+		if (!m_pending.empty())
+			deadline = std::min(m_lastPending + m_debounce, m_firstPending + kMaxLatency);
+
+		if (isNative()) {
+#ifdef __linux__
+			int timeout = -1;
+			if (deadline != Clock::time_point::max())
+				timeout = static_cast<int>(std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1));
+
+			pollfd fds[2] = { { m_inotifyFd, POLLIN, 0 }, { m_wakeFd, POLLIN, 0 } };
+			if (poll(fds, 2, timeout) > 0) {
+				if (fds[1].revents & POLLIN) {
+					std::uint64_t count;
+					[[maybe_unused]] auto drained = read(m_wakeFd, &count, sizeof(count));
+				}
+				if (fds[0].revents & POLLIN)
+					readEvents();
+			}
+#endif
+		}
+		else {
+			// Sleep in short slices so destruction is not delayed by a whole poll interval
+			std::this_thread::sleep_until(std::min({ deadline, nextPoll, now + std::chrono::milliseconds(50) }));
+			if (Clock::now() >= nextPoll) {
+				pollSnapshots();
+				nextPoll = Clock::now() + kPollInterval;
+			}
+		}
+
+		now = Clock::now();
+		if (!m_pending.empty() && (now >= m_lastPending + m_debounce || now >= m_firstPending + kMaxLatency))
+			flushPending();
+	}
+}
+
+void FileWatcher::record(const fs::path& path, FileChangeType type)
+{
+	const auto now = Clock::now();
+	if (m_pending.empty())
+		m_firstPending = now;
+	m_lastPending = now;
+
+	auto [it, inserted] = m_pending.try_emplace(path, type);
+	if (inserted)
+		return;
+
+	// Coalesce the sequence of events on one path into its net effect
+	const FileChangeType previous = it->second;
+	if (previous == FileChangeType::Created && type == FileChangeType::Removed)
+		m_pending.erase(it);
+	else if (previous == FileChangeType::Created)
+		it->second = FileChangeType::Created;
+	else if (previous == FileChangeType::Removed && type == FileChangeType::Created)
+		it->second = FileChangeType::Modified;
+	else
+		it->second = type;
+}
+
+void FileWatcher::flushPending()
+{
+	std::vector<FileChange> batch;
+	batch.reserve(m_pending.size());
+	for (auto& [path, type] : m_pending)
+		batch.push_back({ path, type });
+	m_pending.clear();
+
+	std::sort(batch.begin(), batch.end(), [](const FileChange& a, const FileChange& b) { return a.path < b.path; });
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_ready.empty())
+			m_ready = std::move(batch);
+		else
+			m_ready.insert(m_ready.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+		m_hasReady.store(true, std::memory_order_release);
+	}
+
+	if (auto wake = m_wakeHandler.load(std::memory_order_acquire))
+		wake();
+}
+
+// Walks the trees watch() registered, on the watcher thread
+void FileWatcher::registerWatches()
+{
+	std::vector<fs::path> roots;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		roots.swap(m_registrations);
+	}
+
+	for (const fs::path& root : roots) {
+		if (isNative()) {
+			addWatch(root, false);
+			continue;
+		}
+
+		bool recursive;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto watch = m_watches.find(root);
+			if (watch == m_watches.end())
+				continue; // unwatched before its turn
+			recursive = watch->second.recursive;
+		}
+
+		std::unordered_map<fs::path, fs::file_time_type> snapshot;
+		scan(root, recursive, snapshot);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_watches.find(root) != m_watches.end())
+			m_snapshots[root] = std::move(snapshot);
+	}
+}
+
+// Called with m_mutex held. Returns the descriptor, or -1 if the directory could not be watched.
+int FileWatcher::addDescriptor(const fs::path& directory)
+{
+#ifdef __linux__
+	constexpr std::uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF | IN_ONLYDIR;
+
+	const int wd = inotify_add_watch(m_inotifyFd, directory.c_str(), mask);
+	if (wd < 0) {
+		// Once the per-user limit is reached every further directory fails the same way, say so once
+		if (errno != ENOSPC)
+			LOG("[FileWatcher]: Failed to watch {}", Log::LogLevel::Warn, directory);
+		else if (!m_watchLimitReported) {
+			m_watchLimitReported = true;
+			LOG("[FileWatcher]: inotify watch limit reached at {}, raise fs.inotify.max_user_watches to see changes below it", Log::LogLevel::Warn, directory);
+		}
+		return -1;
+	}
+	m_watchDescriptors[wd] = directory;
+	return wd;
+#else
+	return -1;
+#endif
+}
+
+// Watches directory and the tree below it. Runs on the watcher thread and only takes m_mutex for each
+// directory it adds, so watch() and pollChanges() are not held up by a large tree.
+void FileWatcher::addWatch(const fs::path& directory, bool reportContents)
+{
+#ifdef __linux__
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!isNeeded(directory) || addDescriptor(directory) < 0)
+			return; // unwatched meanwhile, or out of watches
+	}
+
+	std::error_code ec;
+	for (fs::directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+		// A new directory may already have contents by the time its watch is added
+		if (reportContents)
+			record(it->path(), FileChangeType::Created);
+
+		std::error_code typeEc;
+		if (it->is_directory(typeEc) && !it->is_symlink(typeEc))
+			addWatch(it->path(), reportContents);
+	}
+#endif
+}
+
+// Called with m_mutex held. Drops the watches of directory and of everything below it.
+void FileWatcher::removeWatches(const fs::path& directory)
+{
+#ifdef __linux__
+	for (auto it = m_watchDescriptors.begin(); it != m_watchDescriptors.end();) {
+		if (IsWithin(it->second, directory)) {
+			inotify_rm_watch(m_inotifyFd, it->first);
+			it = m_watchDescriptors.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+#endif
+}
+
+void FileWatcher::readEvents()
+{
+#ifdef __linux__
+	alignas(inotify_event) char buffer[64 * 1024];
+
+	// Walked after the lock is released, see addWatch
+	std::vector<fs::path> newDirectories;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		const ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+		if (length <= 0)
+			break;
+
+		for (const char* ptr = buffer; ptr < buffer + length;) {
+			const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+			ptr += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				// Events were dropped, report every root as modified so consumers rescan
+				LOG("[FileWatcher]: inotify queue overflow", Log::LogLevel::Warn);
+				for (const auto& [root, watch] : m_watches)
+					record(root, FileChangeType::Modified);
+				continue;
+			}
+
+			auto directory = m_watchDescriptors.find(event->wd);
+			if (directory == m_watchDescriptors.end())
+				continue;
+
+			if (event->mask & IN_IGNORED) {
+				m_watchDescriptors.erase(directory);
+				continue;
+			}
+
+			if (event->mask & IN_MOVE_SELF) {
+				// The parent reports the move and the new location is watched again on IN_MOVED_TO. The
+				// descriptors below still name the old paths, the whole subtree goes. Unless the mapping
+				// was already moved along by that new watch: inotify hands out the same descriptor.
+				std::error_code ec;
+				if (!fs::exists(directory->second, ec))
+					removeWatches(fs::path(directory->second));
+				continue;
+			}
+
+			const fs::path path = event->len > 0 ? directory->second / event->name : directory->second;
+			const bool recursive = std::any_of(m_watches.begin(), m_watches.end(), [&path](const auto& entry) {
+				return entry.second.recursive && IsWithin(path, entry.first);
+			});
+
+			if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+				record(path, FileChangeType::Created);
+				if ((event->mask & IN_ISDIR) && recursive)
+					newDirectories.push_back(path);
+			}
+			else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+				record(path, FileChangeType::Removed);
+			}
+			else if (event->mask & (IN_MODIFY | IN_CLOSE_WRITE)) {
+				record(path, FileChangeType::Modified);
+			}
+		}
+	}
+	lock.unlock();
+
+	for (const fs::path& directory : newDirectories)
+		addWatch(directory, true);
+#endif
+}
+
+void FileWatcher::scan(const fs::path& root, bool recursive, std::unordered_map<fs::path, fs::file_time_type>& snapshot) const
+{
+	std::error_code ec;
+	if (!recursive) {
+		const auto time = fs::last_write_time(root, ec);
+		if (!ec)
+			snapshot[root] = time;
+		return;
+	}
+
+	for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+		std::error_code timeEc;
+		const auto time = it->last_write_time(timeEc);
+		if (!timeEc)
+			snapshot[it->path()] = time;
+	}
+}
+
+void FileWatcher::pollSnapshots()
+{
+	std::vector<std::pair<fs::path, bool>> roots;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& [root, watch] : m_watches)
+			roots.emplace_back(root, watch.recursive);
+	}
+
+	for (const auto& [root, recursive] : roots) {
+		std::unordered_map<fs::path, fs::file_time_type> current;
+		scan(root, recursive, current);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto previous = m_snapshots.find(root);
+		if (previous == m_snapshots.end())
+			continue; // unwatched while scanning
+
+		for (const auto& [path, time] : current) {
+			auto old = previous->second.find(path);
+			if (old == previous->second.end())
+				record(path, FileChangeType::Created);
+			else if (old->second != time)
+				record(path, FileChangeType::Modified);
+		}
+		for (const auto& [path, time] : previous->second) {
+			if (current.find(path) == current.end())
+				record(path, FileChangeType::Removed);
+		}
+		previous->second = std::move(current);
+	}
+}
@@ -0,0 +1,74 @@
+#include "FrameArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace core;
+
+FrameArena::FrameArena(std::size_t capacity)
+{
+	addChunk(capacity);
+}
+
+FrameArena::~FrameArena() = default;
+
+void FrameArena::reset()
+{
+	m_lastFrame = getStats();
+	m_peak = m_lastFrame.peak;
+
+	if (m_chunks.size() > 1) {
+		// Last frame overflowed, keep one chunk that fits the whole frame
+		std::size_t total = 0;
+		for (const Chunk& chunk : m_chunks)
+			total += chunk.size;
+		m_chunks.clear();
+		addChunk(total);
+	}
+
+	Chunk& chunk = m_chunks.back();
+	m_current = chunk.memory.get();
+	m_end = m_current + chunk.size;
+	m_used = 0;
+	m_overflows = 0;
+	m_allocations = 0;
+}
+
+FrameArena::Stats FrameArena::getStats() const noexcept
+{
+	std::size_t capacity = 0;
+	for (const Chunk& chunk : m_chunks)
+		capacity += chunk.size;
+
+	const std::size_t used = m_used + static_cast<std::size_t>(m_current - (m_end - m_chunks.back().size));
+	return { used, capacity, std::max(m_peak, used), m_overflows, m_allocations };
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	auto current = reinterpret_cast<std::uintptr_t>(m_current);
+	auto aligned = (current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+
+	if (aligned + bytes > reinterpret_cast<std::uintptr_t>(m_end)) {
+		++m_overflows;
+		addChunk(bytes + alignment);
+		current = reinterpret_cast<std::uintptr_t>(m_current);
+		aligned = (current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+	}
+
+	m_current = reinterpret_cast<std::byte*>(aligned + bytes);
+	++m_allocations;
+	return reinterpret_cast<void*>(aligned);
+}
+
+void FrameArena::addChunk(std::size_t minimum)
+{
+	if (!m_chunks.empty())
+		m_used += m_chunks.back().size; // the rest of the current chunk is wasted for this frame
+
+	// Grow geometrically so a frame that keeps overflowing needs few chunks
+	const std::size_t size = std::max(minimum, m_chunks.empty() ? std::size_t{ 4096 } : m_chunks.back().size * 2);
+	m_chunks.push_back({ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+	m_current = m_chunks.back().memory.get();
+	m_end = m_current + size;
+}
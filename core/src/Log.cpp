@@ -1,43 +1,308 @@
 #include "Log.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 using namespace core;
 
-void Log::LoG(const char* formattedMsg, LogLevel severity)
-{
-    if (severity > m_LogLevel) return;
+namespace {
+
+    constexpr std::size_t kRingSize = 4096; // cells, a power of two
+
+    // Bounded MPSC ring (Vyukov): a cell's sequence says whether it is free for the producer that
+    // claimed its position or holds a record for the sink
+    struct alignas(64) Cell {
+        std::atomic<std::size_t> sequence;
+        LogRecord record;
+    };
+
+    class Sink {
+    public:
+        Sink()
+            : m_cells(new Cell[kRingSize])
+        {
+            for (std::size_t i = 0; i < kRingSize; ++i)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            m_thread = std::thread(&Sink::run, this);
+        }
+
+        ~Sink()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_one();
+            m_thread.join(); // the sink drains the ring before it exits
+        }
+
+        bool push(Log::LogLevel level, std::string_view format, LogRecord::Formatter formatter, const void* context,
+            void (*pack)(LogRecord& record, const void* context))
+        {
+            const std::int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+
+            Cell* cell = nullptr;
+            std::size_t position = m_enqueue.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &m_cells[position & (kRingSize - 1)];
+                const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                if (difference == 0) {
+                    if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0) {
+                    // Full
+                    if (m_policy.load(std::memory_order_relaxed) == Log::OverflowPolicy::Drop) {
+                        m_dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    wake();
+                    std::this_thread::yield();
+                    position = m_enqueue.load(std::memory_order_relaxed);
+                }
+                else {
+                    position = m_enqueue.load(std::memory_order_relaxed);
+                }
+            }
+
+            LogRecord& record = cell->record;
+            record.timestamp = timestamp;
+            record.format = format;
+            record.formatter = formatter;
+            record.level = level;
+            pack(record, context);
+            // seq_cst like the sink's m_sleeping store and re-check: either it sees this record or we see it asleep
+            cell->sequence.store(position + 1, std::memory_order_seq_cst);
+
+            if (m_sleeping.load(std::memory_order_seq_cst))
+                wake();
+            return true;
+        }
+
+        void flush()
+        {
+            const std::size_t target = m_enqueue.load(std::memory_order_acquire);
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.notify_one();
+            m_flushed.wait(lock, [&] { return m_written >= target || m_stop; });
+        }
+
+        void setPolicy(Log::OverflowPolicy policy) { m_policy.store(policy, std::memory_order_relaxed); }
+        std::size_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        void wake()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wake.notify_one();
+        }
 
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
+        void run()
+        {
+            std::string batch;
+            std::size_t reportedDrops = 0;
 
+            for (;;) {
+                std::size_t count = 0;
+                batch.clear();
+
+                // Format everything that is ready, a cell is released as soon as its record has been formatted
+                for (;;) {
+                    Cell& cell = m_cells[m_dequeue & (kRingSize - 1)];
+                    if (cell.sequence.load(std::memory_order_acquire) != m_dequeue + 1)
+                        break;
+
+                    append(batch, cell.record);
+                    cell.sequence.store(m_dequeue + kRingSize, std::memory_order_release);
+                    ++m_dequeue;
+                    ++count;
+                }
+
+                const std::size_t dropped = m_dropped.load(std::memory_order_relaxed);
+                if (dropped != reportedDrops) {
+                    appendDropped(batch, dropped - reportedDrops);
+                    reportedDrops = dropped;
+                }
+
+                if (!batch.empty())
+                    write(batch);
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (count > 0) {
+                    m_written = m_dequeue;
+                    m_flushed.notify_all();
+                    continue;
+                }
+                if (m_stop)
+                    break;
+
+                // Producers only signal while the sink sleeps. A record published before m_sleeping was set
+                // is seen by the re-check, one published after it finds the sink asleep and wakes it, so an
+                // idle sink sleeps until there is work, a flush or stop.
+                m_sleeping.store(true, std::memory_order_seq_cst);
+                if (m_cells[m_dequeue & (kRingSize - 1)].sequence.load(std::memory_order_seq_cst) != m_dequeue + 1)
+                    m_wake.wait(lock);
+                m_sleeping.store(false, std::memory_order_relaxed);
+            }
+
+            m_flushed.notify_all();
+        }
+
+        static const char* levelName(int level)
+        {
+            return level == Log::Error ? "ERROR" : level == Log::Warn ? "WARN" : "INFO";
+        }
+
+        void appendPrefix(std::string& out, int level, std::int64_t timestamp)
+        {
+#ifndef _WIN32
+            out += level == Log::Error ? "\033[31m" : level == Log::Warn ? "\033[33m" : "\033[32m";
+#endif
+            // localtime only once per second
+            const std::time_t seconds = static_cast<std::time_t>(timestamp / 1000000000);
+            if (seconds != m_cachedSecond) {
+                m_cachedSecond = seconds;
+                std::tm local{};
 #ifdef _WIN32
-    HANDLE hcon = GetStdHandle(STD_OUTPUT_HANDLE);
-    WORD color = 7;
-    switch (severity) {
-    case Error:  color = 4; break;
-    case Warn:   color = 14; break;
-    case Tracer: color = 10; break;
-    }
-    SetConsoleTextAttribute(hcon, color);
+                localtime_s(&local, &seconds);
 #else
-    const char* color = "";
-    switch (severity) {
-    case Error:  color = "\033[31m"; break;
-    case Warn:   color = "\033[33m"; break;
-    case Tracer: color = "\033[32m"; break;
-    }
-    std::cout << color;
+                localtime_r(&seconds, &local);
 #endif
+                std::strftime(m_cachedTime, sizeof(m_cachedTime), "%Y-%m-%d %H:%M:%S", &local);
+            }
 
-    const char* levelStr = (severity == Error ? "ERROR" : severity == Warn ? "WARN" : "INFO");
-    std::string timeStr = std::ctime(&time);
-    if (!timeStr.empty() && timeStr.back() == '\n') {
-        timeStr = timeStr.substr(0, timeStr.size() - 1);  // Remove last char (newline)
-    }
+            char prefix[64];
+            const int length = std::snprintf(prefix, sizeof(prefix), "[%s][%s.%03d]: ", levelName(level), m_cachedTime,
+                static_cast<int>(timestamp / 1000000 % 1000));
+            out.append(prefix, static_cast<std::size_t>(length));
+        }
 
-    std::cout << "[" << levelStr << "][" << timeStr << "]: " << formattedMsg << std::endl;
+        void append(std::string& out, const LogRecord& record)
+        {
+#ifdef _WIN32
+            // Colours are console attributes on Windows, so every record is written on its own
+            appendPrefix(out, record.level, record.timestamp);
+            record.formatter(record, out);
+            out += '\n';
+            writeColoured(out, record.level);
+            out.clear();
+#else
+            appendPrefix(out, record.level, record.timestamp);
+            record.formatter(record, out);
+            out += "\033[0m\n";
+#endif
+        }
 
+        void appendDropped(std::string& out, std::size_t dropped)
+        {
+            const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            appendPrefix(out, Log::Warn, now);
+            out += std::to_string(dropped) + " log messages dropped, the log ring was full";
 #ifdef _WIN32
-    SetConsoleTextAttribute(hcon, 7);
+            out += '\n';
+            writeColoured(out, Log::Warn);
+            out.clear();
 #else
-    std::cout << "\033[0m";
+            out += "\033[0m\n";
 #endif
+        }
+
+        static void write(const std::string& text)
+        {
+            std::fwrite(text.data(), 1, text.size(), stdout);
+            std::fflush(stdout);
+        }
+
+#ifdef _WIN32
+        static void writeColoured(const std::string& text, int level)
+        {
+            HANDLE hcon = GetStdHandle(STD_OUTPUT_HANDLE);
+            SetConsoleTextAttribute(hcon, level == Log::Error ? 4 : level == Log::Warn ? 14 : 10);
+            write(text);
+            SetConsoleTextAttribute(hcon, 7);
+        }
+#endif
+
+        std::unique_ptr<Cell[]> m_cells;
+        alignas(64) std::atomic<std::size_t> m_enqueue{ 0 };
+        alignas(64) std::size_t m_dequeue = 0; // sink thread only
+
+        std::atomic<std::size_t> m_dropped{ 0 };
+        std::atomic<Log::OverflowPolicy> m_policy{ Log::OverflowPolicy::Block };
+        std::atomic<bool> m_sleeping{ false };
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_flushed;
+        std::size_t m_written = 0;     // guarded by m_mutex
+        bool m_stop = false;           // guarded by m_mutex
+
+        std::time_t m_cachedSecond = -1;
+        char m_cachedTime[32] = {};
+
+        std::thread m_thread;
+    };
+
+    // Set once the sink is destroyed during static destruction, later messages are written directly
+    std::atomic<bool> s_SinkDestroyed{ false };
+
+    struct SinkHolder {
+        Sink sink;
+        ~SinkHolder() { s_SinkDestroyed.store(true); }
+    };
+
+    Sink* GetSink()
+    {
+        if (s_SinkDestroyed.load(std::memory_order_relaxed))
+            return nullptr;
+        static SinkHolder holder;
+        return &holder.sink;
+    }
+
+}
+
+bool Log::Push(LogLevel level, std::string_view format, LogRecord::Formatter formatter, const void* context,
+    void (*pack)(LogRecord& record, const void* context))
+{
+    if (Sink* sink = GetSink())
+        return sink->push(level, format, formatter, context, pack);
+
+    // Too late for the sink thread, format on the caller's thread
+    LogRecord record{};
+    record.format = format;
+    record.formatter = formatter;
+    record.level = level;
+    pack(record, context);
+
+    std::string text;
+    record.formatter(record, text);
+    std::fprintf(stderr, "[%s]: %s\n", level == Error ? "ERROR" : level == Warn ? "WARN" : "INFO", text.c_str());
+    return true;
+}
+
+void Log::LoG(const char* formattedMsg, LogLevel severity)
+{
+    Write(severity, "{}", formattedMsg);
+}
+
+void Log::SetOverflowPolicy(OverflowPolicy policy)
+{
+    if (Sink* sink = GetSink())
+        sink->setPolicy(policy);
+}
+
+void Log::Flush()
+{
+    if (Sink* sink = GetSink())
+        sink->flush();
+}
+
+std::size_t Log::GetDroppedCount()
+{
+    Sink* sink = GetSink();
+    return sink ? sink->getDropped() : 0;
 }
@@ -1,12 +1,249 @@
-#include "MemoryPool.hpp"
-using namespace core;
-
-MemoryPool::MemoryPool(std::size_t blockSize, std::size_t blockCount)
-{
-
-}
-
-core::MemoryPool::~MemoryPool()
-{
-
-}
+#include "MemoryPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <new>
+
+using namespace core;
+
+// Blocks per thread magazine. An empty magazine takes half of this from the pool, a full one gives half back.
+static constexpr std::size_t kMagazineSize = 64;
+// Pools a thread can cache at once, further pools use the locked path
+static constexpr std::size_t kMagazineSlots = 8;
+// Every block is aligned for any fundamental type
+static constexpr std::size_t kBlockAlignment = alignof(std::max_align_t);
+
+// Attaching and detaching magazines happens once per thread and pool, a global lock keeps
+// thread exit and pool destruction from racing each other
+static std::mutex s_RegistryMutex;
+// Set once the calling thread's magazines are gone, e.g. for deallocations from static destructors
+static thread_local bool t_MagazinesDestroyed = false;
+
+struct MemoryPool::Magazine {
+	std::atomic<MemoryPool*> pool{ nullptr };
+	Block* head = nullptr;
+	std::atomic<std::size_t> count{ 0 }; // written by the owner only, read by getStats
+};
+
+struct MemoryPool::MagazineCache {
+	std::array<Magazine, kMagazineSlots> slots;
+	std::size_t last = 0;
+
+	~MagazineCache()
+	{
+		std::lock_guard<std::mutex> registry(s_RegistryMutex);
+		for (Magazine& magazine : slots) {
+			MemoryPool* pool = magazine.pool.load(std::memory_order_relaxed);
+			if (!pool)
+				continue;
+
+			pool->drain(magazine, 0);
+			pool->m_magazines.erase(std::find(pool->m_magazines.begin(), pool->m_magazines.end(), &magazine));
+			magazine.pool.store(nullptr, std::memory_order_relaxed);
+		}
+		t_MagazinesDestroyed = true;
+	}
+};
+
+MemoryPool::MemoryPool(std::size_t blockSize, std::size_t blockCount, std::pmr::memory_resource* upstream)
+	: m_upstream(upstream)
+	, m_blockSize((std::max(blockSize, sizeof(Block)) + kBlockAlignment - 1) / kBlockAlignment * kBlockAlignment)
+	, m_blockCount(std::max<std::size_t>(blockCount, 1))
+{
+}
+
+MemoryPool::~MemoryPool()
+{
+	// Magazines of threads still alive hold blocks of chunks freed below, forget them
+	std::lock_guard<std::mutex> registry(s_RegistryMutex);
+	for (Magazine* magazine : m_magazines) {
+		magazine->head = nullptr;
+		magazine->count.store(0, std::memory_order_relaxed);
+		magazine->pool.store(nullptr, std::memory_order_relaxed);
+	}
+
+	for (std::byte* chunk : m_chunks)
+		m_upstream->deallocate(chunk, m_blockSize * m_blockCount, kBlockAlignment);
+}
+
+void* MemoryPool::allocate()
+{
+	Magazine* magazine = getMagazine();
+	if (!magazine) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_freeList)
+			grow();
+		Block* block = m_freeList;
+		m_freeList = block->next;
+		--m_freeCount;
+		return block;
+	}
+
+	if (!magazine->head)
+		refill(*magazine);
+
+	Block* block = magazine->head;
+	magazine->head = block->next;
+	magazine->count.store(magazine->count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+	return block;
+}
+
+void MemoryPool::deallocate(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	Block* block = static_cast<Block*>(ptr);
+	Magazine* magazine = getMagazine();
+	if (!magazine) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		block->next = m_freeList;
+		m_freeList = block;
+		++m_freeCount;
+		return;
+	}
+
+	block->next = magazine->head;
+	magazine->head = block;
+	const std::size_t count = magazine->count.load(std::memory_order_relaxed) + 1;
+	magazine->count.store(count, std::memory_order_relaxed);
+
+	if (count >= kMagazineSize)
+		drain(*magazine, kMagazineSize / 2);
+}
+
+MemoryPool::Stats MemoryPool::getStats() const
+{
+	std::lock_guard<std::mutex> registry(s_RegistryMutex);
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::size_t cached = 0;
+	for (const Magazine* magazine : m_magazines)
+		cached += magazine->count.load(std::memory_order_relaxed);
+
+	const std::size_t capacity = m_chunks.size() * m_blockCount;
+	return { m_blockSize, m_chunks.size(), capacity, capacity - m_freeCount - std::min(cached, capacity - m_freeCount) };
+}
+
+void* MemoryPool::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	if (bytes <= m_blockSize && alignment <= kBlockAlignment)
+		return allocate();
+	return m_upstream->allocate(bytes, alignment);
+}
+
+void MemoryPool::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+	if (bytes <= m_blockSize && alignment <= kBlockAlignment)
+		deallocate(ptr);
+	else
+		m_upstream->deallocate(ptr, bytes, alignment);
+}
+
+bool MemoryPool::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+
+MemoryPool::Magazine* MemoryPool::getMagazine()
+{
+	if (t_MagazinesDestroyed)
+		return nullptr;
+
+	static thread_local MagazineCache cache;
+	if (cache.slots[cache.last].pool.load(std::memory_order_relaxed) == this)
+		return &cache.slots[cache.last];
+
+	for (std::size_t i = 0; i < kMagazineSlots; ++i) {
+		if (cache.slots[i].pool.load(std::memory_order_relaxed) == this) {
+			cache.last = i;
+			return &cache.slots[i];
+		}
+	}
+
+	// First use of this pool on this thread
+	std::lock_guard<std::mutex> registry(s_RegistryMutex);
+	for (std::size_t i = 0; i < kMagazineSlots; ++i) {
+		Magazine& magazine = cache.slots[i];
+		if (magazine.pool.load(std::memory_order_relaxed))
+			continue;
+
+		magazine.head = nullptr;
+		magazine.count.store(0, std::memory_order_relaxed);
+		magazine.pool.store(this, std::memory_order_relaxed);
+		m_magazines.push_back(&magazine);
+		cache.last = i;
+		return &magazine;
+	}
+	return nullptr;
+}
+
+void MemoryPool::refill(Magazine& magazine)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_freeCount < kMagazineSize / 2)
+		grow();
+
+	// Splice the first half magazine of the free list in one go
+	Block* first = m_freeList;
+	Block* last = first;
+	for (std::size_t i = 1; i < kMagazineSize / 2; ++i)
+		last = last->next;
+
+	m_freeList = last->next;
+	m_freeCount -= kMagazineSize / 2;
+
+	last->next = magazine.head;
+	magazine.head = first;
+	magazine.count.store(magazine.count.load(std::memory_order_relaxed) + kMagazineSize / 2, std::memory_order_relaxed);
+}
+
+void MemoryPool::drain(Magazine& magazine, std::size_t keep)
+{
+	const std::size_t count = magazine.count.load(std::memory_order_relaxed);
+	if (count <= keep)
+		return;
+
+	// Cut the list after keep blocks, the rest goes back to the pool
+	Block* first = magazine.head;
+	Block* cut = nullptr;
+	for (std::size_t i = 0; i < keep; ++i) {
+		cut = first;
+		first = first->next;
+	}
+
+	Block* last = first;
+	while (last->next)
+		last = last->next;
+
+	if (cut)
+		cut->next = nullptr;
+	else
+		magazine.head = nullptr;
+	magazine.count.store(keep, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	last->next = m_freeList;
+	m_freeList = first;
+	m_freeCount += count - keep;
+}
+
+void MemoryPool::grow()
+{
+	const std::size_t chunks = std::max<std::size_t>(1, (kMagazineSize + m_blockCount - 1) / m_blockCount);
+	for (std::size_t c = 0; c < chunks; ++c) {
+		// Reserve first so a chunk is never allocated without a slot to remember it by
+		m_chunks.reserve(m_chunks.size() + 1);
+		std::byte* memory = static_cast<std::byte*>(m_upstream->allocate(m_blockSize * m_blockCount, kBlockAlignment));
+		m_chunks.push_back(memory);
+
+		// Thread the new blocks in address order in front of the free list
+		for (std::size_t i = m_blockCount; i-- > 0;) {
+			Block* block = reinterpret_cast<Block*>(memory + i * m_blockSize);
+			block->next = m_freeList;
+			m_freeList = block;
+		}
+		m_freeCount += m_blockCount;
+	}
+}
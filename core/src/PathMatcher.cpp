@@ -0,0 +1,225 @@
+#include "PathMatcher.hpp"
+
+#include <algorithm>
+
+using namespace core;
+
+static bool HasWildcard(std::string_view text)
+{
+	return text.find_first_of("*?[\\") != std::string_view::npos;
+}
+
+PathMatcher::PathMatcher(const std::vector<std::string>& patterns)
+{
+	for (const auto& pattern : patterns)
+		add(pattern);
+}
+
+PathMatcher PathMatcher::fromGitignore(std::string_view content)
+{
+	PathMatcher matcher;
+	while (!content.empty()) {
+		std::size_t end = content.find('\n');
+		std::string_view line = content.substr(0, end);
+		content = end == std::string_view::npos ? std::string_view() : content.substr(end + 1);
+
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+		if (line.empty() || line.front() == '#')
+			continue;
+
+		// Trailing spaces are ignored unless escaped
+		while (line.size() > 1 && line.back() == ' ' && line[line.size() - 2] != '\\')
+			line.remove_suffix(1);
+
+		matcher.add(line);
+	}
+	return matcher;
+}
+
+void PathMatcher::add(std::string_view pattern)
+{
+	Rule rule{};
+	if (!pattern.empty() && pattern.front() == '!') {
+		rule.negated = true;
+		pattern.remove_prefix(1);
+	}
+	else if (pattern.size() > 1 && pattern.front() == '\\' && (pattern[1] == '!' || pattern[1] == '#')) {
+		pattern.remove_prefix(1);
+	}
+
+	if (!pattern.empty() && pattern.back() == '/') {
+		rule.directoryOnly = true;
+		pattern.remove_suffix(1);
+	}
+
+	// A slash at the start or in the middle anchors the pattern to the .gitignore directory
+	rule.anchored = pattern.find('/') != std::string_view::npos;
+	if (!pattern.empty() && pattern.front() == '/')
+		pattern.remove_prefix(1);
+
+	if (pattern.empty())
+		return;
+
+	rule.pattern = std::string(pattern);
+	if (!HasWildcard(pattern))
+		rule.kind = Rule::Kind::Literal;
+	else if (!rule.anchored && pattern.size() > 1 && pattern.front() == '*' && !HasWildcard(pattern.substr(1)))
+		rule.kind = Rule::Kind::Suffix;
+	else
+		rule.kind = Rule::Kind::Glob;
+
+	const std::size_t index = m_Rules.size();
+	m_HasNegation = m_HasNegation || rule.negated;
+
+	if (rule.kind == Rule::Kind::Literal && !rule.anchored)
+		(rule.directoryOnly ? m_DirectoryNames : m_Names).insert(rule.pattern);
+	else if (rule.kind == Rule::Kind::Suffix && !rule.directoryOnly && rule.pattern[1] == '.')
+		m_Extensions.insert(rule.pattern.substr(1));
+	else
+		m_GlobRules.push_back(index);
+
+	m_Rules.push_back(std::move(rule));
+}
+
+PathMatcher::Result PathMatcher::match(std::string_view relativePath, bool isDirectory) const
+{
+	if (m_Rules.empty())
+		return Result::None;
+
+	const std::size_t slash = relativePath.rfind('/');
+	const std::string_view name = slash == std::string_view::npos ? relativePath : relativePath.substr(slash + 1);
+
+	if (m_HasNegation) {
+		// The last matching rule decides
+		for (auto it = m_Rules.rbegin(); it != m_Rules.rend(); ++it) {
+			if (matches(*it, relativePath, name, isDirectory))
+				return it->negated ? Result::Included : Result::Ignored;
+		}
+		return Result::None;
+	}
+
+	const std::string key(name);
+	if (m_Names.count(key) || (isDirectory && m_DirectoryNames.count(key)))
+		return Result::Ignored;
+
+	if (!m_Extensions.empty()) {
+		for (std::size_t dot = name.find('.'); dot != std::string_view::npos; dot = name.find('.', dot + 1)) {
+			if (m_Extensions.count(std::string(name.substr(dot))))
+				return Result::Ignored;
+		}
+	}
+
+	for (std::size_t index : m_GlobRules) {
+		if (matches(m_Rules[index], relativePath, name, isDirectory))
+			return Result::Ignored;
+	}
+	return Result::None;
+}
+
+bool PathMatcher::matches(const Rule& rule, std::string_view relativePath, std::string_view name, bool isDirectory) const
+{
+	if (rule.directoryOnly && !isDirectory)
+		return false;
+
+	const std::string_view subject = rule.anchored ? relativePath : name;
+	switch (rule.kind) {
+	case Rule::Kind::Literal:
+		return subject == rule.pattern;
+	case Rule::Kind::Suffix:
+		return subject.size() >= rule.pattern.size() - 1
+			&& subject.substr(subject.size() - (rule.pattern.size() - 1)) == std::string_view(rule.pattern).substr(1);
+	case Rule::Kind::Glob:
+		return MatchGlob(rule.pattern, subject);
+	}
+	return false;
+}
+
+// Matches one character class starting at pattern[0] == '[', advances pattern past it
+static bool MatchClass(std::string_view& pattern, char c)
+{
+	std::size_t i = 1;
+	const bool negate = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+	if (negate)
+		++i;
+
+	bool matched = false;
+	const std::size_t first = i;
+	for (; i < pattern.size() && (pattern[i] != ']' || i == first); ++i) {
+		if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+			matched = matched || (c >= pattern[i] && c <= pattern[i + 2]);
+			i += 2;
+		}
+		else {
+			matched = matched || c == pattern[i];
+		}
+	}
+
+	pattern.remove_prefix(std::min(i + 1, pattern.size()));
+	return matched != negate;
+}
+
+// '*' and '?' stop at '/', "**" crosses directories, "[a-z]" and "[!a]" are character classes
+bool PathMatcher::MatchGlob(std::string_view pattern, std::string_view text)
+{
+	while (!pattern.empty()) {
+		const char p = pattern.front();
+
+		if (p == '*') {
+			const bool doubleStar = pattern.size() > 1 && pattern[1] == '*';
+			while (!pattern.empty() && pattern.front() == '*')
+				pattern.remove_prefix(1);
+
+			if (doubleStar) {
+				// "**/" matches zero or more directories, a trailing "**" everything below
+				if (pattern.empty())
+					return true;
+				if (pattern.front() == '/') {
+					pattern.remove_prefix(1);
+					for (std::size_t i = 0;; ++i) {
+						if (MatchGlob(pattern, text.substr(i)))
+							return true;
+						i = text.find('/', i);
+						if (i == std::string_view::npos)
+							return false;
+					}
+				}
+				for (std::size_t i = 0; i <= text.size(); ++i) {
+					if (MatchGlob(pattern, text.substr(i)))
+						return true;
+				}
+				return false;
+			}
+
+			for (std::size_t i = 0; i <= text.size(); ++i) {
+				if (MatchGlob(pattern, text.substr(i)))
+					return true;
+				if (i < text.size() && text[i] == '/')
+					break;
+			}
+			return false;
+		}
+
+		if (text.empty())
+			return false;
+
+		if (p == '?') {
+			if (text.front() == '/')
+				return false;
+			pattern.remove_prefix(1);
+		}
+		else if (p == '[') {
+			if (text.front() == '/' || !MatchClass(pattern, text.front()))
+				return false;
+		}
+		else {
+			if (p == '\\' && pattern.size() > 1)
+				pattern.remove_prefix(1);
+			if (pattern.front() != text.front())
+				return false;
+			pattern.remove_prefix(1);
+		}
+		text.remove_prefix(1);
+	}
+	return text.empty();
+}
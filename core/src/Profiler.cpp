@@ -0,0 +1,290 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace core;
+
+namespace {
+
+	// Slots are relaxed atomics so a reader may copy the ring while its thread keeps writing
+	struct Slot {
+		std::atomic<const ZoneSite*> site{ nullptr };
+		std::atomic<std::uint64_t> begin{ 0 };
+		std::atomic<std::uint64_t> end{ 0 };
+	};
+
+	struct ThreadBuffer {
+		std::unique_ptr<Slot[]> slots{ new Slot[Profiler::BufferCapacity] };
+		std::atomic<std::uint64_t> written{ 0 }; // events ever recorded, only the owning thread stores
+		std::uint32_t threadId = 0;
+		std::string name;        // guarded by the registry lock
+		bool finished = false;   // guarded by the registry lock
+	};
+
+	constexpr std::size_t kMaxFinishedBuffers = 32; // of exited threads, kept so their zones can still be exported
+
+	std::mutex s_RegistryMutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> s_Buffers;
+	std::uint32_t s_NextThreadId = 0;
+
+	// The raw pointer keeps the recording path free of TLS initialisation guards, the owner
+	// marks the buffer finished when the thread exits
+	thread_local ThreadBuffer* t_Buffer = nullptr;
+	thread_local bool t_Exited = false;
+
+	struct BufferOwner {
+		std::shared_ptr<ThreadBuffer> buffer;
+
+		~BufferOwner()
+		{
+			t_Buffer = nullptr;
+			t_Exited = true;
+			if (!buffer)
+				return;
+			std::lock_guard<std::mutex> lock(s_RegistryMutex);
+			buffer->finished = true;
+		}
+	};
+
+	ThreadBuffer* AcquireBuffer()
+	{
+		if (t_Buffer || t_Exited)
+			return t_Buffer;
+
+		thread_local BufferOwner owner;
+		owner.buffer = std::make_shared<ThreadBuffer>();
+
+		std::lock_guard<std::mutex> lock(s_RegistryMutex);
+		owner.buffer->threadId = s_NextThreadId++;
+		owner.buffer->name = "Thread " + std::to_string(owner.buffer->threadId);
+
+		const auto finished = std::count_if(s_Buffers.begin(), s_Buffers.end(), [](const auto& buffer) { return buffer->finished; });
+		if (static_cast<std::size_t>(finished) >= kMaxFinishedBuffers) {
+			auto oldest = std::find_if(s_Buffers.begin(), s_Buffers.end(), [](const auto& buffer) { return buffer->finished; });
+			s_Buffers.erase(oldest);
+		}
+		s_Buffers.push_back(owner.buffer);
+
+		t_Buffer = owner.buffer.get();
+		return t_Buffer;
+	}
+
+	// Start of the profiler's timeline, the reference for calibrating rdtsc
+	struct Origin {
+		std::uint64_t ticks;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	const Origin s_Origin{ Profiler::Now(), std::chrono::steady_clock::now() };
+
+	double TicksSinceOrigin(std::uint64_t ticks)
+	{
+		return ticks >= s_Origin.ticks
+			? static_cast<double>(ticks - s_Origin.ticks)
+			: -static_cast<double>(s_Origin.ticks - ticks);
+	}
+
+	void AppendJsonString(std::string& out, std::string_view text)
+	{
+		out += '"';
+		for (const char c : text) {
+			switch (c) {
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+					out += escaped;
+				}
+				else {
+					out += c;
+				}
+			}
+		}
+		out += '"';
+	}
+
+	template<typename T>
+	void AppendNumber(std::string& out, T value)
+	{
+		char buffer[32];
+		std::to_chars_result result;
+		if constexpr (std::is_floating_point_v<T>)
+			result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 3);
+		else
+			result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		out.append(buffer, result.ptr);
+	}
+
+}
+
+double Profiler::TicksPerNanosecond()
+{
+#ifdef QUANTOM_PROFILER_RDTSC
+	// Too short an interval gives a poor rate, only possible right after start-up
+	auto elapsed = std::chrono::steady_clock::now() - s_Origin.time;
+	while (elapsed < std::chrono::milliseconds(1)) {
+		std::this_thread::yield();
+		elapsed = std::chrono::steady_clock::now() - s_Origin.time;
+	}
+	const std::uint64_t ticks = Now() - s_Origin.ticks;
+	const double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	return static_cast<double>(ticks) / nanoseconds;
+#else
+	return 1.0;
+#endif
+}
+
+double Profiler::ToNanoseconds(std::uint64_t ticks)
+{
+	return TicksSinceOrigin(ticks) / TicksPerNanosecond();
+}
+
+void Profiler::Record(const ZoneSite* site, std::uint64_t begin, std::uint64_t end) noexcept
+{
+	ThreadBuffer* buffer = t_Buffer;
+	if (!buffer) {
+		try {
+			buffer = AcquireBuffer();
+		}
+		catch (...) {
+			return;
+		}
+		if (!buffer)
+			return;
+	}
+
+	const std::uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	Slot& slot = buffer->slots[index & (BufferCapacity - 1)];
+	slot.site.store(site, std::memory_order_relaxed);
+	slot.begin.store(begin, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(std::string name)
+{
+	ThreadBuffer* buffer = AcquireBuffer();
+	if (!buffer)
+		return;
+
+	std::lock_guard<std::mutex> lock(s_RegistryMutex);
+	buffer->name = std::move(name);
+}
+
+std::vector<Profiler::ThreadEvents> Profiler::Collect(std::uint64_t since)
+{
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	std::vector<ThreadEvents> result;
+	{
+		std::lock_guard<std::mutex> lock(s_RegistryMutex);
+		buffers = s_Buffers;
+		for (const auto& buffer : buffers)
+			result.push_back({ buffer->threadId, buffer->name, {} });
+	}
+
+	for (std::size_t i = 0; i < buffers.size(); ++i) {
+		ThreadBuffer& buffer = *buffers[i];
+		std::vector<ProfileEvent>& events = result[i].events;
+
+		const std::uint64_t written = buffer.written.load(std::memory_order_acquire);
+		std::uint64_t first = written > BufferCapacity ? written - BufferCapacity : 0;
+
+		// Zones are recorded in the order they end, so only a tail of the ring can be recent enough.
+		// Polling with the previous call's time therefore copies only what is new.
+		if (since != 0) {
+			std::uint64_t index = written;
+			while (index > first && buffer.slots[(index - 1) & (BufferCapacity - 1)].end.load(std::memory_order_relaxed) >= since)
+				--index;
+			first = index;
+		}
+
+		events.reserve(static_cast<std::size_t>(written - first));
+		for (std::uint64_t index = first; index < written; ++index) {
+			const Slot& slot = buffer.slots[index & (BufferCapacity - 1)];
+			events.push_back({ slot.site.load(std::memory_order_relaxed),
+				slot.begin.load(std::memory_order_relaxed),
+				slot.end.load(std::memory_order_relaxed) });
+		}
+
+		// The owner may have lapped the oldest slots while they were copied, and may be in the
+		// middle of writing the slot after the last event it published
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const std::uint64_t now = buffer.written.load(std::memory_order_relaxed);
+		if (now + 1 > first + BufferCapacity) {
+			const std::uint64_t overwritten = std::min<std::uint64_t>(now + 1 - BufferCapacity - first, events.size());
+			events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(overwritten));
+		}
+
+		events.erase(std::remove_if(events.begin(), events.end(), [since](const ProfileEvent& event) {
+			return event.end < since;
+		}), events.end());
+	}
+
+	return result;
+}
+
+std::string Profiler::ExportTrace(double windowSeconds, std::uint64_t end)
+{
+	const double ticksPerNanosecond = TicksPerNanosecond();
+	const auto window = static_cast<std::uint64_t>(std::max(0.0, windowSeconds) * 1e9 * ticksPerNanosecond);
+	const std::vector<ThreadEvents> threads = Collect(end > window ? end - window : 0);
+
+	// Microseconds since the profiler started, as trace-event timestamps expect
+	auto toMicroseconds = [&](std::uint64_t ticks) {
+		return TicksSinceOrigin(ticks) / ticksPerNanosecond / 1000.0;
+	};
+
+	std::string out;
+	out.reserve(256 + threads.size() * 128);
+	out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	auto beginEvent = [&]() {
+		if (!first)
+			out += ",\n";
+		first = false;
+	};
+
+	for (const ThreadEvents& thread : threads) {
+		const std::uint32_t tid = thread.threadId + 1;
+
+		beginEvent();
+		out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+		AppendNumber(out, tid);
+		out += ",\"args\":{\"name\":";
+		AppendJsonString(out, thread.name);
+		out += "}}";
+
+		out.reserve(out.size() + thread.events.size() * 160);
+		for (const ProfileEvent& event : thread.events) {
+			if (event.end > end)
+				continue; // recorded after the capture was asked for
+			beginEvent();
+			out += "{\"name\":";
+			AppendJsonString(out, event.site->name);
+			out += ",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":";
+			AppendNumber(out, toMicroseconds(event.begin));
+			out += ",\"dur\":";
+			AppendNumber(out, static_cast<double>(event.end - event.begin) / ticksPerNanosecond / 1000.0);
+			out += ",\"pid\":1,\"tid\":";
+			AppendNumber(out, tid);
+			out += ",\"args\":{\"file\":";
+			AppendJsonString(out, event.site->file);
+			out += ",\"line\":";
+			AppendNumber(out, event.site->line);
+			out += "}}";
+		}
+	}
+
+	out += "]}\n";
+	return out;
+}
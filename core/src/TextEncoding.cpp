@@ -0,0 +1,258 @@
+#include "TextEncoding.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace core;
+
+namespace {
+
+	constexpr std::uint64_t kHighBits = 0x8080808080808080ull;
+
+	void AppendUtf8(std::string& out, char32_t codePoint)
+	{
+		if (codePoint < 0x80) {
+			out += static_cast<char>(codePoint);
+		}
+		else if (codePoint < 0x800) {
+			out += static_cast<char>(0xC0 | (codePoint >> 6));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000) {
+			out += static_cast<char>(0xE0 | (codePoint >> 12));
+			out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else {
+			out += static_cast<char>(0xF0 | (codePoint >> 18));
+			out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+
+	// Unpaired surrogates become U+FFFD, a trailing odd byte is dropped
+	std::string DecodeUtf16(std::string_view bytes, bool bigEndian)
+	{
+		auto unit = [&](std::size_t index) -> char16_t {
+			const auto first = static_cast<unsigned char>(bytes[index]);
+			const auto second = static_cast<unsigned char>(bytes[index + 1]);
+			return static_cast<char16_t>(bigEndian ? (first << 8) | second : (second << 8) | first);
+		};
+
+		std::string out;
+		out.reserve(bytes.size());
+		const std::size_t units = bytes.size() / 2;
+		for (std::size_t i = 0; i < units; ++i) {
+			const char16_t high = unit(i * 2);
+			if (high >= 0xD800 && high <= 0xDBFF && i + 1 < units) {
+				const char16_t low = unit((i + 1) * 2);
+				if (low >= 0xDC00 && low <= 0xDFFF) {
+					AppendUtf8(out, 0x10000 + ((char32_t(high) - 0xD800) << 10) + (char32_t(low) - 0xDC00));
+					++i;
+					continue;
+				}
+			}
+			AppendUtf8(out, high >= 0xD800 && high <= 0xDFFF ? char32_t(0xFFFD) : char32_t(high));
+		}
+		return out;
+	}
+
+	// Code point of the UTF-8 sequence at i, which is moved past it. A byte that does not start a valid
+	// sequence is taken on its own as U+FFFD.
+	char32_t NextCodePoint(std::string_view text, std::size_t& i)
+	{
+		const auto lead = static_cast<unsigned char>(text[i]);
+		std::size_t length = lead < 0x80 ? 1 : lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+		if (length == 0 || text.size() - i < length || !IsValidUtf8(text.substr(i, length))) {
+			++i;
+			return lead < 0x80 ? lead : 0xFFFD;
+		}
+
+		char32_t codePoint = length == 1 ? lead : lead & (0x7F >> length);
+		for (std::size_t k = 1; k < length; ++k)
+			codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+		i += length;
+		return codePoint;
+	}
+
+	void EncodeUtf16(std::string& out, std::string_view text, bool bigEndian)
+	{
+		auto append = [&](char16_t unit) {
+			const char high = static_cast<char>(unit >> 8);
+			const char low = static_cast<char>(unit & 0xFF);
+			out += bigEndian ? high : low;
+			out += bigEndian ? low : high;
+		};
+
+		out.reserve(out.size() + text.size() * 2);
+		for (std::size_t i = 0; i < text.size();) {
+			const char32_t codePoint = NextCodePoint(text, i);
+			if (codePoint >= 0x10000) {
+				append(static_cast<char16_t>(0xD800 + ((codePoint - 0x10000) >> 10)));
+				append(static_cast<char16_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF)));
+			}
+			else {
+				append(static_cast<char16_t>(codePoint));
+			}
+		}
+	}
+
+	std::string DecodeLatin1(std::string_view bytes)
+	{
+		std::string out;
+		out.reserve(bytes.size() + bytes.size() / 8);
+		for (const char c : bytes)
+			AppendUtf8(out, static_cast<unsigned char>(c));
+		return out;
+	}
+
+}
+
+const char* core::ToString(TextEncoding encoding) noexcept
+{
+	switch (encoding) {
+	case TextEncoding::Utf8: return "UTF-8";
+	case TextEncoding::Utf8Bom: return "UTF-8 with BOM";
+	case TextEncoding::Utf16LE: return "UTF-16 LE";
+	case TextEncoding::Utf16BE: return "UTF-16 BE";
+	case TextEncoding::Latin1: return "Latin-1";
+	}
+	return "Unknown";
+}
+
+TextEncoding core::DecodeText(std::string& text)
+{
+	const std::string_view bytes = text;
+	if (bytes.starts_with("\xEF\xBB\xBF")) {
+		text.erase(0, 3);
+		return TextEncoding::Utf8Bom;
+	}
+	if (bytes.starts_with("\xFF\xFE")) {
+		text = DecodeUtf16(bytes.substr(2), false);
+		return TextEncoding::Utf16LE;
+	}
+	if (bytes.starts_with("\xFE\xFF")) {
+		text = DecodeUtf16(bytes.substr(2), true);
+		return TextEncoding::Utf16BE;
+	}
+	if (IsValidUtf8(bytes))
+		return TextEncoding::Utf8;
+
+	text = DecodeLatin1(bytes);
+	return TextEncoding::Latin1;
+}
+
+std::string core::EncodeText(std::string_view text, TextEncoding encoding)
+{
+	std::string out;
+	switch (encoding) {
+	case TextEncoding::Utf8:
+		out = text;
+		break;
+	case TextEncoding::Utf8Bom:
+		out.reserve(text.size() + 3);
+		out = "\xEF\xBB\xBF";
+		out += text;
+		break;
+	case TextEncoding::Utf16LE:
+		out = "\xFF\xFE";
+		EncodeUtf16(out, text, false);
+		break;
+	case TextEncoding::Utf16BE:
+		out = "\xFE\xFF";
+		EncodeUtf16(out, text, true);
+		break;
+	case TextEncoding::Latin1:
+		out.reserve(text.size());
+		for (std::size_t i = 0; i < text.size();) {
+			const char32_t codePoint = NextCodePoint(text, i);
+			out += codePoint <= 0xFF ? static_cast<char>(codePoint) : '?';
+		}
+		break;
+	}
+	return out;
+}
+
+bool core::CanEncode(std::string_view text, TextEncoding encoding) noexcept
+{
+	if (encoding != TextEncoding::Latin1)
+		return true;
+
+	// Only U+0000 to U+00FF, in UTF-8 ASCII or a C2/C3 lead byte with one continuation byte
+	for (std::size_t i = 0; i < text.size(); ++i) {
+		const auto byte = static_cast<unsigned char>(text[i]);
+		if (byte < 0x80)
+			continue;
+		if ((byte != 0xC2 && byte != 0xC3) || i + 1 == text.size() || (static_cast<unsigned char>(text[i + 1]) & 0xC0) != 0x80)
+			return false;
+		++i;
+	}
+	return true;
+}
+
+bool core::IsValidUtf8(std::string_view text) noexcept
+{
+	const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+	const std::size_t size = text.size();
+	std::size_t i = 0;
+
+	while (i < size) {
+		// Source files are mostly ASCII, skip it a word at a time
+		if (i + 8 <= size) {
+			std::uint64_t word;
+			std::memcpy(&word, bytes + i, sizeof(word));
+			if ((word & kHighBits) == 0) {
+				i += 8;
+				continue;
+			}
+		}
+
+		const unsigned char lead = bytes[i];
+		if (lead < 0x80) {
+			++i;
+			continue;
+		}
+
+		std::size_t length;
+		unsigned char min = 0x80, max = 0xBF; // allowed range of the second byte
+		if (lead >= 0xC2 && lead <= 0xDF) {
+			length = 2;
+		}
+		else if (lead >= 0xE0 && lead <= 0xEF) {
+			length = 3;
+			if (lead == 0xE0) min = 0xA0;      // overlong
+			else if (lead == 0xED) max = 0x9F; // surrogates
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4) {
+			length = 4;
+			if (lead == 0xF0) min = 0x90;      // overlong
+			else if (lead == 0xF4) max = 0x8F; // above U+10FFFF
+		}
+		else {
+			return false;
+		}
+
+		if (size - i < length || bytes[i + 1] < min || bytes[i + 1] > max)
+			return false;
+		for (std::size_t k = 2; k < length; ++k) {
+			if ((bytes[i + k] & 0xC0) != 0x80)
+				return false;
+		}
+		i += length;
+	}
+	return true;
+}
+
+std::vector<std::size_t> core::IndexLines(std::string_view text)
+{
+	std::vector<std::size_t> lineStarts;
+	lineStarts.reserve(text.size() / 32 + 1);
+	lineStarts.push_back(0);
+
+	const char* begin = text.data();
+	const char* end = begin + text.size();
+	for (const char* p = begin; (p = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)))) != nullptr; ++p)
+		lineStarts.push_back(static_cast<std::size_t>(p - begin) + 1);
+	return lineStarts;
+}
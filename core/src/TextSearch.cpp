@@ -0,0 +1,951 @@
+#include "TextSearch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QUANTOM_SEARCH_SSE2 1
+#endif
+
+using namespace core;
+
+namespace {
+
+	using ByteSet = std::bitset<256>;
+
+	constexpr std::size_t kMaxNestingDepth = 256;
+	constexpr int kMaxRepeat = 1000;
+	constexpr std::size_t kMaxProgramStates = 100000;
+
+	struct ParseError : std::runtime_error {
+		using std::runtime_error::runtime_error;
+	};
+
+	bool IsAsciiLetter(unsigned char c) noexcept
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	}
+
+	unsigned char OtherCase(unsigned char c) noexcept
+	{
+		return IsAsciiLetter(c) ? static_cast<unsigned char>(c ^ 0x20) : c;
+	}
+
+	bool EqualBytes(const char* a, const char* b, std::size_t count, bool caseSensitive) noexcept
+	{
+		if (caseSensitive)
+			return std::memcmp(a, b, count) == 0;
+		for (std::size_t i = 0; i < count; ++i) {
+			const auto x = static_cast<unsigned char>(a[i]);
+			const auto y = static_cast<unsigned char>(b[i]);
+			if (x != y && OtherCase(x) != y)
+				return false;
+		}
+		return true;
+	}
+
+	std::size_t CountLineBreaks(const char* data, std::size_t size) noexcept
+	{
+		std::size_t count = 0;
+		std::size_t i = 0;
+#ifdef QUANTOM_SEARCH_SSE2
+		const __m128i lineBreak = _mm_set1_epi8('\n');
+		while (size - i >= 16) {
+			// Byte counters take 255 blocks before they could overflow, then they are summed up
+			__m128i counters = _mm_setzero_si128();
+			const std::size_t blocks = std::min<std::size_t>((size - i) / 16, 255);
+			for (std::size_t block = 0; block < blocks; ++block, i += 16) {
+				const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(bytes, lineBreak));
+			}
+			const __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+			count += static_cast<std::size_t>(_mm_cvtsi128_si32(sums)) + static_cast<std::size_t>(_mm_extract_epi16(sums, 4));
+		}
+#endif
+		for (; i < size; ++i)
+			count += data[i] == '\n';
+		return count;
+	}
+
+	// Regex syntax tree, compiled into the NFA and thrown away
+	struct Node {
+		enum class Kind { Empty, Set, Concat, Alternate, Repeat, LineStart, LineEnd };
+
+		Kind kind = Kind::Empty;
+		ByteSet set;
+		std::vector<std::unique_ptr<Node>> children;
+		int min = 0;
+		int max = -1; // -1 is unbounded
+	};
+
+	unsigned char SingleByte(const ByteSet& set) noexcept
+	{
+		for (unsigned c = 0; c < 256; ++c) {
+			if (set[c])
+				return static_cast<unsigned char>(c);
+		}
+		return 0;
+	}
+
+	std::unique_ptr<Node> MakeNode(Node::Kind kind)
+	{
+		auto node = std::make_unique<Node>();
+		node->kind = kind;
+		return node;
+	}
+
+	class Parser {
+	public:
+		Parser(std::string_view pattern, bool caseSensitive)
+			: m_Pattern(pattern), m_CaseSensitive(caseSensitive)
+		{
+		}
+
+		std::unique_ptr<Node> parse()
+		{
+			auto node = parseAlternation(0);
+			if (m_Position < m_Pattern.size())
+				throw ParseError("unmatched ')'");
+			return node;
+		}
+
+	private:
+		bool atEnd() const noexcept { return m_Position >= m_Pattern.size(); }
+		char peek() const noexcept { return m_Pattern[m_Position]; }
+
+		std::unique_ptr<Node> parseAlternation(std::size_t depth)
+		{
+			if (depth > kMaxNestingDepth)
+				throw ParseError("expression is nested too deeply");
+
+			auto first = parseConcat(depth);
+			if (atEnd() || peek() != '|')
+				return first;
+
+			auto node = MakeNode(Node::Kind::Alternate);
+			node->children.push_back(std::move(first));
+			while (!atEnd() && peek() == '|') {
+				++m_Position;
+				node->children.push_back(parseConcat(depth));
+			}
+			return node;
+		}
+
+		std::unique_ptr<Node> parseConcat(std::size_t depth)
+		{
+			auto node = MakeNode(Node::Kind::Concat);
+			while (!atEnd() && peek() != '|' && peek() != ')')
+				node->children.push_back(parseRepeat(depth));
+			return node;
+		}
+
+		std::unique_ptr<Node> parseRepeat(std::size_t depth)
+		{
+			auto atom = parseAtom(depth);
+			while (!atEnd()) {
+				int min, max;
+				const char c = peek();
+				if (c == '*') { min = 0; max = -1; ++m_Position; }
+				else if (c == '+') { min = 1; max = -1; ++m_Position; }
+				else if (c == '?') { min = 0; max = 1; ++m_Position; }
+				else if (c == '{' && parseCount(min, max)) {}
+				else break;
+
+				if (atom->kind == Node::Kind::LineStart || atom->kind == Node::Kind::LineEnd)
+					throw ParseError("nothing to repeat");
+				// Lazy and greedy quantifiers match the same lines
+				if (!atEnd() && peek() == '?')
+					++m_Position;
+
+				auto repeat = MakeNode(Node::Kind::Repeat);
+				repeat->min = min;
+				repeat->max = max;
+				repeat->children.push_back(std::move(atom));
+				atom = std::move(repeat);
+			}
+			return atom;
+		}
+
+		// {m}, {m,} or {m,n}; a '{' that does not start a count is a literal
+		bool parseCount(int& min, int& max)
+		{
+			std::size_t position = m_Position + 1;
+			auto number = [&](int& value) {
+				const std::size_t start = position;
+				value = 0;
+				while (position < m_Pattern.size() && m_Pattern[position] >= '0' && m_Pattern[position] <= '9') {
+					value = value * 10 + (m_Pattern[position] - '0');
+					if (value > kMaxRepeat)
+						throw ParseError("repetition count is too large");
+					++position;
+				}
+				return position > start;
+			};
+
+			if (!number(min))
+				return false;
+			max = min;
+			if (position < m_Pattern.size() && m_Pattern[position] == ',') {
+				++position;
+				if (!number(max))
+					max = -1;
+			}
+			if (position >= m_Pattern.size() || m_Pattern[position] != '}')
+				return false;
+			if (max != -1 && max < min)
+				throw ParseError("invalid repetition range");
+
+			m_Position = position + 1;
+			return true;
+		}
+
+		std::unique_ptr<Node> parseAtom(std::size_t depth)
+		{
+			const char c = peek();
+			++m_Position;
+
+			switch (c) {
+			case '(': {
+				if (m_Pattern.substr(m_Position).starts_with("?:"))
+					m_Position += 2;
+				else if (!atEnd() && peek() == '?')
+					throw ParseError("unsupported group");
+				auto group = parseAlternation(depth + 1);
+				if (atEnd() || peek() != ')')
+					throw ParseError("missing ')'");
+				++m_Position;
+				return group;
+			}
+			case '*':
+			case '+':
+			case '?':
+				throw ParseError("nothing to repeat");
+			case '^':
+				return MakeNode(Node::Kind::LineStart);
+			case '$':
+				return MakeNode(Node::Kind::LineEnd);
+			case '.': {
+				auto node = MakeNode(Node::Kind::Set);
+				node->set.set();
+				return finishSet(std::move(node), false);
+			}
+			case '[':
+				return parseClass();
+			case '\\': {
+				auto node = MakeNode(Node::Kind::Set);
+				parseEscape(node->set, false);
+				return finishSet(std::move(node), false);
+			}
+			default: {
+				auto node = MakeNode(Node::Kind::Set);
+				node->set.set(static_cast<unsigned char>(c));
+				return finishSet(std::move(node), false);
+			}
+			}
+		}
+
+		std::unique_ptr<Node> parseClass()
+		{
+			auto node = MakeNode(Node::Kind::Set);
+			bool negated = false;
+			if (!atEnd() && peek() == '^') {
+				negated = true;
+				++m_Position;
+			}
+
+			bool first = true;
+			while (!atEnd() && (peek() != ']' || first)) {
+				first = false;
+				unsigned char low;
+				if (peek() == '\\') {
+					++m_Position;
+					ByteSet escaped;
+					if (!parseEscape(escaped, true)) {
+						node->set |= escaped; // \d, \w, \s and their negations are not range bounds
+						continue;
+					}
+					low = SingleByte(escaped);
+				}
+				else {
+					low = static_cast<unsigned char>(peek());
+					++m_Position;
+				}
+
+				if (m_Position + 1 < m_Pattern.size() && peek() == '-' && m_Pattern[m_Position + 1] != ']') {
+					++m_Position;
+					unsigned char high;
+					if (peek() == '\\') {
+						++m_Position;
+						ByteSet escaped;
+						if (!parseEscape(escaped, true))
+							throw ParseError("invalid range in character class");
+						high = SingleByte(escaped);
+					}
+					else {
+						high = static_cast<unsigned char>(peek());
+						++m_Position;
+					}
+					if (high < low)
+						throw ParseError("invalid range in character class");
+					for (unsigned c = low; c <= high; ++c)
+						node->set.set(c);
+				}
+				else {
+					node->set.set(low);
+				}
+			}
+			if (atEnd())
+				throw ParseError("missing ']'");
+			++m_Position;
+
+			return finishSet(std::move(node), negated);
+		}
+
+		// Adds the escape after a '\' to set, true if it was a single character
+		bool parseEscape(ByteSet& set, bool inClass)
+		{
+			if (atEnd())
+				throw ParseError("trailing '\\'");
+			const char c = peek();
+			++m_Position;
+
+			auto classOf = [&](char lower) {
+				ByteSet members;
+				auto range = [&](char low, char high) {
+					for (int b = low; b <= high; ++b)
+						members.set(static_cast<unsigned char>(b));
+				};
+				switch (lower) {
+				case 'd': range('0', '9'); break;
+				case 'w': range('0', '9'); range('a', 'z'); range('A', 'Z'); members.set('_'); break;
+				case 's': members.set(' '); members.set('\t'); members.set('\r'); members.set('\f'); members.set('\v'); break;
+				}
+				if (c != lower)
+					members.flip();
+				set |= members;
+				return false;
+			};
+
+			switch (c) {
+			case 'd': case 'D': return classOf('d');
+			case 'w': case 'W': return classOf('w');
+			case 's': case 'S': return classOf('s');
+			case 't': set.set('\t'); return true;
+			case 'n': set.set('\n'); return true;
+			case 'r': set.set('\r'); return true;
+			case 'f': set.set('\f'); return true;
+			case 'v': set.set('\v'); return true;
+			case 'x': {
+				int value = 0;
+				for (int i = 0; i < 2; ++i) {
+					if (atEnd() || !std::isxdigit(static_cast<unsigned char>(peek())))
+						throw ParseError("invalid \\x escape");
+					const char digit = peek();
+					value = value * 16 + (digit <= '9' ? digit - '0' : (digit | 0x20) - 'a' + 10);
+					++m_Position;
+				}
+				set.set(static_cast<unsigned char>(value));
+				return true;
+			}
+			default:
+				if (std::isalnum(static_cast<unsigned char>(c)) && !(inClass && c == 'b'))
+					throw ParseError(std::string("unsupported escape \\") + c);
+				set.set(static_cast<unsigned char>(c == 'b' ? '\b' : c));
+				return true;
+			}
+		}
+
+		std::unique_ptr<Node> finishSet(std::unique_ptr<Node> node, bool negated)
+		{
+			if (!m_CaseSensitive) {
+				for (unsigned c = 'A'; c <= 'Z'; ++c) {
+					if (node->set[c] || node->set[c | 0x20]) {
+						node->set.set(c);
+						node->set.set(c | 0x20);
+					}
+				}
+			}
+			if (negated)
+				node->set.flip();
+			node->set.reset('\n'); // matches end at line breaks
+			return node;
+		}
+
+		std::string_view m_Pattern;
+		std::size_t m_Position = 0;
+		bool m_CaseSensitive;
+	};
+
+}
+
+namespace {
+
+	// Shortest literal worth looking for before running the DFA
+	constexpr std::size_t kMinRequiredLength = 3;
+
+	// Longest run of single characters in the top-level sequence: every match contains it, so only
+	// lines containing it need to run through the DFA. "get\\w+\\(" gives "get".
+	std::string RequiredLiteral(const Node& root, bool caseSensitive)
+	{
+		auto literalByte = [&](const Node& node, char& byte) {
+			if (node.kind != Node::Kind::Set)
+				return false;
+			const std::size_t count = node.set.count();
+			const unsigned char c = SingleByte(node.set);
+			if (count == 1 || (!caseSensitive && count == 2 && IsAsciiLetter(c) && node.set[OtherCase(c)])) {
+				byte = static_cast<char>(c);
+				return true;
+			}
+			return false;
+		};
+
+		if (root.kind != Node::Kind::Concat)
+			return std::string();
+
+		std::string best, current;
+		for (const auto& child : root.children) {
+			char byte;
+			if (literalByte(*child, byte)) {
+				current += byte;
+				continue;
+			}
+			if (current.size() > best.size())
+				best = current;
+			current.clear();
+		}
+		if (current.size() > best.size())
+			best = current;
+		return best.size() >= kMinRequiredLength ? best : std::string();
+	}
+
+}
+
+struct TextSearcher::Program {
+	enum class Kind : std::uint8_t { Set, Split, LineStart, LineEnd, Match };
+
+	struct State {
+		Kind kind;
+		int out = -1;
+		int out1 = -1; // second branch of a Split
+		int set = -1;  // index into sets
+	};
+
+	std::vector<State> states;
+	std::vector<ByteSet> sets;
+	int start = -1;
+	std::string required; // literal every match contains, empty if there is none worth searching for
+
+	int emit(State state)
+	{
+		if (states.size() >= kMaxProgramStates)
+			throw ParseError("expression is too large");
+		states.push_back(state);
+		return static_cast<int>(states.size() - 1);
+	}
+
+	// Thompson construction from the back: next is the state that follows node
+	int compile(const Node& node, int next)
+	{
+		switch (node.kind) {
+		case Node::Kind::Empty:
+			return next;
+		case Node::Kind::Set:
+			sets.push_back(node.set);
+			return emit({ Kind::Set, next, -1, static_cast<int>(sets.size() - 1) });
+		case Node::Kind::LineStart:
+			return emit({ Kind::LineStart, next });
+		case Node::Kind::LineEnd:
+			return emit({ Kind::LineEnd, next });
+		case Node::Kind::Concat:
+			for (auto it = node.children.rbegin(); it != node.children.rend(); ++it)
+				next = compile(**it, next);
+			return next;
+		case Node::Kind::Alternate: {
+			int branch = compile(*node.children.back(), next);
+			for (auto it = node.children.rbegin() + 1; it != node.children.rend(); ++it)
+				branch = emit({ Kind::Split, compile(**it, next), branch });
+			return branch;
+		}
+		case Node::Kind::Repeat: {
+			const Node& child = *node.children.front();
+			int tail = next;
+			if (node.max == -1) {
+				const int loop = emit({ Kind::Split, -1, next });
+				states[loop].out = compile(child, loop);
+				tail = loop;
+			}
+			else {
+				for (int i = node.min; i < node.max; ++i)
+					tail = emit({ Kind::Split, compile(child, tail), next });
+			}
+			for (int i = 0; i < node.min; ++i)
+				tail = compile(child, tail);
+			return tail;
+		}
+		}
+		return next;
+	}
+};
+
+// Subset construction done on demand. A DFA state is the set of NFA states the search can be in, its
+// transitions are filled in the first time a byte is seen there. Line breaks are never followed: the
+// searcher restarts at every line.
+class TextSearcher::Dfa {
+public:
+	// A transition is the target's row in the table, its index times 256, so the next lookup is a single
+	// addition. Targets that match carry MatchTag; Unknown and LineBreak are never rows, so one compare
+	// against MatchTag tells the common case from everything else.
+	using Transition = std::uint32_t;
+	static constexpr Transition MatchTag = Transition{ 1 } << 31;
+	static constexpr Transition Unknown = ~Transition{ 0 };
+	static constexpr Transition LineBreak = Unknown - 1;
+	static constexpr Transition Dead = 0; // row of the empty state, only reachable when anchored
+
+	static Transition Row(Transition transition) noexcept { return transition & ~MatchTag; }
+	static bool IsMatch(Transition transition) noexcept { return (transition & MatchTag) != 0; }
+
+	Dfa(const Program& program, bool unanchored)
+		: m_Program(program), m_Unanchored(unanchored), m_Marks(program.states.size(), 0)
+	{
+		reset();
+	}
+
+	Transition start(bool atLineStart)
+	{
+		Transition& state = m_Start[atLineStart ? 1 : 0];
+		if (state == Unknown) {
+			m_Scratch.clear();
+			nextGeneration();
+			addClosure(m_Scratch, m_Program.start, atLineStart);
+			state = intern(m_Scratch);
+		}
+		return state;
+	}
+
+	// byte must not be a line break
+	Transition next(Transition state, unsigned char byte)
+	{
+		const Transition row = Row(state);
+		const Transition cached = m_Next[row + byte];
+		return cached != Unknown ? cached : computeNext(row, byte);
+	}
+
+	bool isMatchAtLineEnd(Transition state) const noexcept { return m_Flags[Row(state) / 256] & MatchAtEndFlag; }
+
+	// Valid until the next call that computes a transition or a start state
+	const Transition* table() const noexcept { return m_Next.data(); }
+
+private:
+	using Kind = Program::Kind;
+
+	static constexpr std::uint8_t MatchFlag = 1;
+	static constexpr std::uint8_t MatchAtEndFlag = 2;
+	static constexpr std::size_t kMaxStates = 4096; // 4 MiB of transitions, the cache starts over beyond
+
+	void reset()
+	{
+		m_States.clear();
+		m_Index.clear();
+		m_Next.clear();
+		m_Flags.clear();
+		m_Start[0] = m_Start[1] = Unknown;
+		intern({});
+	}
+
+	Transition computeNext(Transition row, unsigned char byte)
+	{
+		m_Scratch.clear();
+		nextGeneration();
+		for (const int id : m_States[row / 256]) {
+			const Program::State& nfa = m_Program.states[static_cast<std::size_t>(id)];
+			if (nfa.kind == Kind::Set && m_Program.sets[static_cast<std::size_t>(nfa.set)][byte])
+				addClosure(m_Scratch, nfa.out, false);
+		}
+		if (m_Unanchored)
+			addClosure(m_Scratch, m_Program.start, false);
+
+		if (m_States.size() >= kMaxStates) {
+			// Pathological patterns could build a state per input position, start over instead
+			reset();
+			return intern(m_Scratch);
+		}
+		const Transition target = intern(m_Scratch);
+		m_Next[row + byte] = target;
+		return target;
+	}
+
+	void nextGeneration()
+	{
+		if (++m_Generation == 0) {
+			std::fill(m_Marks.begin(), m_Marks.end(), 0u);
+			m_Generation = 1;
+		}
+	}
+
+	// Follows the epsilon edges from id, collecting the states that consume input or decide a match
+	void addClosure(std::vector<int>& out, int id, bool atLineStart)
+	{
+		m_Stack.clear();
+		m_Stack.push_back(id);
+		while (!m_Stack.empty()) {
+			const int current = m_Stack.back();
+			m_Stack.pop_back();
+			if (m_Marks[static_cast<std::size_t>(current)] == m_Generation)
+				continue;
+			m_Marks[static_cast<std::size_t>(current)] = m_Generation;
+
+			const Program::State& nfa = m_Program.states[static_cast<std::size_t>(current)];
+			switch (nfa.kind) {
+			case Kind::Split:
+				m_Stack.push_back(nfa.out1);
+				m_Stack.push_back(nfa.out);
+				break;
+			case Kind::LineStart:
+				if (atLineStart)
+					m_Stack.push_back(nfa.out);
+				break;
+			default:
+				out.push_back(current);
+				break;
+			}
+		}
+	}
+
+	// Whether the states can reach Match through '$' once the line ends here
+	bool matchesAtLineEnd(const std::vector<int>& ids)
+	{
+		nextGeneration();
+		m_Stack.clear();
+		for (const int id : ids) {
+			if (m_Program.states[static_cast<std::size_t>(id)].kind == Kind::LineEnd)
+				m_Stack.push_back(id);
+		}
+		while (!m_Stack.empty()) {
+			const int current = m_Stack.back();
+			m_Stack.pop_back();
+			if (m_Marks[static_cast<std::size_t>(current)] == m_Generation)
+				continue;
+			m_Marks[static_cast<std::size_t>(current)] = m_Generation;
+
+			const Program::State& nfa = m_Program.states[static_cast<std::size_t>(current)];
+			switch (nfa.kind) {
+			case Kind::Match:
+				return true;
+			case Kind::Split:
+				m_Stack.push_back(nfa.out1);
+				m_Stack.push_back(nfa.out);
+				break;
+			case Kind::LineEnd:
+				m_Stack.push_back(nfa.out);
+				break;
+			default:
+				break;
+			}
+		}
+		return false;
+	}
+
+	Transition intern(std::vector<int> ids)
+	{
+		std::sort(ids.begin(), ids.end());
+		auto it = m_Index.find(ids);
+		if (it != m_Index.end())
+			return it->second;
+
+		std::uint8_t flags = 0;
+		for (const int id : ids) {
+			if (m_Program.states[static_cast<std::size_t>(id)].kind == Kind::Match)
+				flags |= MatchFlag | MatchAtEndFlag;
+		}
+		if (!(flags & MatchFlag) && matchesAtLineEnd(ids))
+			flags |= MatchAtEndFlag;
+
+		const auto row = static_cast<Transition>(m_Next.size());
+		const Transition state = (flags & MatchFlag) ? row | MatchTag : row;
+		m_Index.emplace(ids, state);
+		m_States.push_back(std::move(ids));
+		m_Flags.push_back(flags);
+		m_Next.resize(m_Next.size() + 256, Unknown);
+		m_Next[row + '\n'] = LineBreak;
+		return state;
+	}
+
+	const Program& m_Program;
+	bool m_Unanchored;
+
+	std::vector<std::vector<int>> m_States; // sorted NFA state ids
+	std::map<std::vector<int>, Transition> m_Index;
+	std::vector<Transition> m_Next;         // 256 per state
+	std::vector<std::uint8_t> m_Flags;
+	Transition m_Start[2];                  // mid-line, line start
+
+	std::vector<int> m_Scratch;
+	std::vector<int> m_Stack;
+	std::vector<std::uint32_t> m_Marks;     // visited in the current closure when equal to m_Generation
+	std::uint32_t m_Generation = 0;
+};
+
+std::optional<TextSearcher> TextSearcher::create(std::string_view pattern, SearchOptions options, std::string* error)
+{
+	auto fail = [&](std::string message) -> std::optional<TextSearcher> {
+		if (error)
+			*error = std::move(message);
+		return std::nullopt;
+	};
+
+	if (pattern.empty())
+		return fail("empty pattern");
+	if (!options.regex) {
+		if (pattern.find('\n') != std::string_view::npos)
+			return fail("a pattern can not span lines");
+		return TextSearcher(std::string(pattern), options, nullptr);
+	}
+
+	try {
+		auto program = std::make_shared<Program>();
+		const auto tree = Parser(pattern, options.caseSensitive).parse();
+		const int match = program->emit({ Program::Kind::Match });
+		program->start = program->compile(*tree, match);
+		program->required = RequiredLiteral(*tree, options.caseSensitive);
+		return TextSearcher(std::string(pattern), options, std::move(program));
+	}
+	catch (const ParseError& e) {
+		return fail(e.what());
+	}
+}
+
+TextSearcher::TextSearcher(std::string pattern, SearchOptions options, std::shared_ptr<const Program> program)
+	: m_Pattern(std::move(pattern))
+	, m_Options(options)
+	, m_Program(std::move(program))
+{
+	if (m_Program) {
+		m_Search = std::make_unique<Dfa>(*m_Program, true);
+		m_Extent = std::make_unique<Dfa>(*m_Program, false);
+	}
+}
+
+TextSearcher::TextSearcher(const TextSearcher& other)
+	: TextSearcher(other.m_Pattern, other.m_Options, other.m_Program)
+{
+}
+
+TextSearcher& TextSearcher::operator=(const TextSearcher& other)
+{
+	if (this != &other)
+		*this = TextSearcher(other);
+	return *this;
+}
+
+TextSearcher::TextSearcher(TextSearcher&&) noexcept = default;
+TextSearcher& TextSearcher::operator=(TextSearcher&&) noexcept = default;
+TextSearcher::~TextSearcher() = default;
+
+std::size_t TextSearcher::forEachMatchingLine(std::string_view text, const LineCallback& onMatch)
+{
+	if (!m_Program)
+		return searchLiteral(m_Pattern, text, onMatch);
+	if (!m_Program->required.empty())
+		return searchLiteral(m_Program->required, text, onMatch);
+	return searchRegex(text, onMatch);
+}
+
+// With a regex program the literal only finds candidate lines, the DFA decides
+std::size_t TextSearcher::searchLiteral(std::string_view literal, std::string_view text, const LineCallback& onMatch)
+{
+	const bool caseSensitive = m_Options.caseSensitive;
+	std::size_t line = 0;
+	std::size_t counted = 0; // line breaks before here are in line
+	std::size_t position = 0;
+
+	while (position < text.size()) {
+		const std::size_t hit = FindLiteral(text, literal, caseSensitive, position);
+		if (hit == std::string_view::npos)
+			break;
+
+		// position is always the start of a line
+		std::size_t lineStart = hit;
+		while (lineStart > position && text[lineStart - 1] != '\n')
+			--lineStart;
+		std::size_t lineEnd = text.find('\n', hit + literal.size());
+		if (lineEnd == std::string_view::npos)
+			lineEnd = text.size();
+		position = lineEnd + 1;
+
+		std::size_t column = hit - lineStart;
+		std::size_t length = literal.size();
+		if (m_Program && !firstMatchInLine(text.substr(lineStart, lineEnd - lineStart), column, length))
+			continue;
+
+		line += CountLineBreaks(text.data() + counted, lineStart - counted);
+		counted = lineStart;
+		if (!onMatch({ line, lineStart, lineEnd - lineStart, column, length }))
+			return line;
+	}
+
+	return line + CountLineBreaks(text.data() + counted, text.size() - counted);
+}
+
+std::size_t TextSearcher::searchRegex(std::string_view text, const LineCallback& onMatch)
+{
+	using Transition = Dfa::Transition;
+
+	Dfa& dfa = *m_Search;
+	const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+	const std::size_t size = text.size();
+
+	std::size_t line = 0;
+	std::size_t lineStart = 0;
+	Transition row = Dfa::Row(dfa.start(true));
+	const Transition* table = dfa.table();
+
+	auto report = [&](std::size_t lineEnd) {
+		std::size_t column = 0, length = 0;
+		firstMatchInLine(text.substr(lineStart, lineEnd - lineStart), column, length);
+		return onMatch({ line, lineStart, lineEnd - lineStart, column, length });
+	};
+
+	for (std::size_t i = 0; i < size; ++i) {
+		Transition next = table[row + bytes[i]];
+		if (next < Dfa::MatchTag) {
+			row = next;
+			continue;
+		}
+
+		if (next == Dfa::LineBreak) {
+			if (dfa.isMatchAtLineEnd(row) && !report(i))
+				return line;
+			++line;
+			lineStart = i + 1;
+			row = Dfa::Row(dfa.start(true));
+			table = dfa.table();
+			continue;
+		}
+
+		if (next == Dfa::Unknown) {
+			next = dfa.next(row, bytes[i]);
+			table = dfa.table();
+			if (!Dfa::IsMatch(next)) {
+				row = next;
+				continue;
+			}
+		}
+
+		// The rest of the line does not matter any more
+		const void* lineBreak = std::memchr(bytes + i, '\n', size - i);
+		const std::size_t lineEnd = lineBreak ? static_cast<std::size_t>(static_cast<const unsigned char*>(lineBreak) - bytes) : size;
+		if (!report(lineEnd) || lineEnd == size)
+			return line;
+		++line;
+		i = lineEnd;
+		lineStart = lineEnd + 1;
+		row = Dfa::Row(dfa.start(true));
+		table = dfa.table();
+	}
+
+	if (lineStart < size && dfa.isMatchAtLineEnd(row))
+		report(size);
+	return line;
+}
+
+// Leftmost start, longest match from there. Only runs for lines already known to match.
+bool TextSearcher::firstMatchInLine(std::string_view line, std::size_t& column, std::size_t& length)
+{
+	Dfa& dfa = *m_Extent;
+	const auto* bytes = reinterpret_cast<const unsigned char*>(line.data());
+
+	for (std::size_t start = 0; start <= line.size(); ++start) {
+		Dfa::Transition state = dfa.start(start == 0);
+		std::size_t end = Dfa::IsMatch(state) ? start : std::string_view::npos;
+
+		std::size_t i = start;
+		for (; i < line.size() && Dfa::Row(state) != Dfa::Dead; ++i) {
+			state = dfa.next(state, bytes[i]);
+			if (Dfa::IsMatch(state))
+				end = i + 1;
+		}
+		if (i == line.size() && Dfa::Row(state) != Dfa::Dead && dfa.isMatchAtLineEnd(state))
+			end = line.size();
+
+		if (end != std::string_view::npos) {
+			column = start;
+			length = end - start;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::size_t TextSearcher::FindLiteral(std::string_view text, std::string_view needle, bool caseSensitive, std::size_t from) noexcept
+{
+	const std::size_t n = needle.size();
+	const std::size_t size = text.size();
+	if (from > size || size - from < n)
+		return std::string_view::npos;
+	if (n == 0)
+		return from;
+
+	const char* data = text.data();
+	const auto first = static_cast<unsigned char>(needle.front());
+	const auto last = static_cast<unsigned char>(needle.back());
+	const unsigned char firstOther = caseSensitive ? first : OtherCase(first);
+	const unsigned char lastOther = caseSensitive ? last : OtherCase(last);
+	const std::size_t middle = n > 2 ? n - 2 : 0; // bytes between the first and the last
+	const std::size_t lastStart = size - n;
+	std::size_t i = from;
+
+	if (n == 1 && firstOther == first) {
+		const void* hit = std::memchr(data + from, first, size - from);
+		return hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - data) : std::string_view::npos;
+	}
+
+#ifdef QUANTOM_SEARCH_SSE2
+	// Compares 16 candidate positions at once on their first and last byte, only positions where both
+	// agree are compared in full. Rare byte pairs make this skip most of the text at load speed.
+	const __m128i first0 = _mm_set1_epi8(static_cast<char>(first));
+	const __m128i first1 = _mm_set1_epi8(static_cast<char>(firstOther));
+	const __m128i last0 = _mm_set1_epi8(static_cast<char>(last));
+	const __m128i last1 = _mm_set1_epi8(static_cast<char>(lastOther));
+
+	for (; i + 16 <= lastStart + 1; i += 16) {
+		const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+		const __m128i headEqual = _mm_or_si128(_mm_cmpeq_epi8(head, first0), _mm_cmpeq_epi8(head, first1));
+		const __m128i tailEqual = _mm_or_si128(_mm_cmpeq_epi8(tail, last0), _mm_cmpeq_epi8(tail, last1));
+
+		auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(headEqual, tailEqual)));
+		while (mask != 0) {
+			const std::size_t candidate = i + static_cast<std::size_t>(std::countr_zero(mask));
+			if (EqualBytes(data + candidate + 1, needle.data() + 1, middle, caseSensitive))
+				return candidate;
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	for (; i <= lastStart; ++i) {
+		if (caseSensitive) {
+			const void* hit = std::memchr(data + i, first, lastStart - i + 1);
+			if (!hit)
+				break;
+			i = static_cast<std::size_t>(static_cast<const char*>(hit) - data);
+		}
+		else {
+			const auto c = static_cast<unsigned char>(data[i]);
+			if (c != first && c != firstOther)
+				continue;
+		}
+
+		const auto end = static_cast<unsigned char>(data[i + n - 1]);
+		if ((end == last || end == lastOther) && EqualBytes(data + i + 1, needle.data() + 1, middle, caseSensitive))
+			return i;
+	}
+	return std::string_view::npos;
+}
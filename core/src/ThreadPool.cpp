@@ -0,0 +1,234 @@
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+
+using namespace core;
+
+static thread_local const ThreadPool* t_Pool = nullptr;
+static thread_local int t_WorkerIndex = -1;
+
+// Every 4th pick a worker looks at Normal before Interactive, every 16th at Background first
+static constexpr unsigned kNormalTurn = 4;
+static constexpr unsigned kBackgroundTurn = 16;
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+{
+	threadCount = std::max<std::size_t>(1, threadCount);
+
+	m_queues.reserve(threadCount);
+	for (std::size_t i = 0; i < threadCount; ++i)
+		m_queues.push_back(std::make_unique<Worker>());
+
+	m_workers.reserve(threadCount);
+	for (std::size_t i = 0; i < threadCount; ++i)
+		m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	m_stop.store(true);
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_condition.notify_all();
+	}
+
+	for (auto& worker : m_workers) {
+		if (worker.joinable())
+			worker.join();
+	}
+}
+
+int ThreadPool::getCurrentWorkerIndex() noexcept
+{
+	return t_WorkerIndex;
+}
+
+int ThreadPool::currentIndex() const noexcept
+{
+	return t_Pool == this ? t_WorkerIndex : -1;
+}
+
+ThreadPool::Stats ThreadPool::getStats() const noexcept
+{
+	return {
+		m_queued.load(std::memory_order_relaxed),
+		m_running.load(std::memory_order_relaxed),
+		m_stolen.load(std::memory_order_relaxed),
+		m_cancelled.load(std::memory_order_relaxed),
+		m_completed.load(std::memory_order_relaxed)
+	};
+}
+
+void ThreadPool::submit(std::unique_ptr<Task> task, TaskPriority priority)
+{
+	m_pending.fetch_add(1, std::memory_order_relaxed);
+	m_queued.fetch_add(1, std::memory_order_relaxed);
+
+	const auto queue = static_cast<std::size_t>(priority);
+	const int index = currentIndex();
+	if (index >= 0) {
+		// Nested spawn, lock free on the worker's own deque
+		m_queues[index]->deques[queue].push(task.release());
+	}
+	else {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks[queue].push(task.release());
+		m_injected.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	// Pairs with the sleeping worker's recheck of the queues
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_sleeping.load(std::memory_order_seq_cst) > 0) {
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		++m_wakeups;
+		m_condition.notify_one();
+	}
+}
+
+void ThreadPool::workerLoop(std::size_t index)
+{
+	t_Pool = this;
+	t_WorkerIndex = static_cast<int>(index);
+	Profiler::SetThreadName("Worker " + std::to_string(index));
+
+	for (;;) {
+		if (Task* task = findTask(static_cast<int>(index))) {
+			runTask(task);
+			continue;
+		}
+
+		// Spin briefly before sleeping, stealable work often shows up right away
+		bool found = false;
+		for (int spin = 0; spin < 64 && !found; ++spin) {
+			std::this_thread::yield();
+			found = hasQueuedTasks();
+		}
+		if (found)
+			continue;
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (hasQueuedTasks()) {
+			m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+			continue;
+		}
+		if (m_stop.load()) {
+			m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+			break; // nothing left to drain
+		}
+
+		m_condition.wait(lock, [this]() { return m_wakeups > 0 || m_stop.load(); });
+		if (m_wakeups > 0)
+			--m_wakeups;
+		m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	t_Pool = nullptr;
+	t_WorkerIndex = -1;
+}
+
+// Picks a priority class to look at first, then falls back to the others in priority order
+ThreadPool::Task* ThreadPool::findTask(int index)
+{
+	std::size_t first = static_cast<std::size_t>(TaskPriority::Interactive);
+	if (index >= 0) {
+		const unsigned pick = ++m_queues[index]->picks;
+		if (pick % kBackgroundTurn == 0)
+			first = static_cast<std::size_t>(TaskPriority::Background);
+		else if (pick % kNormalTurn == 0)
+			first = static_cast<std::size_t>(TaskPriority::Normal);
+	}
+
+	if (Task* task = findTask(index, first))
+		return task;
+
+	for (std::size_t priority = 0; priority < PriorityCount; ++priority) {
+		if (priority == first)
+			continue;
+		if (Task* task = findTask(index, priority))
+			return task;
+	}
+	return nullptr;
+}
+
+// Own deque first, then the injection queue, then steal from the other workers
+ThreadPool::Task* ThreadPool::findTask(int index, std::size_t priority)
+{
+	if (index >= 0) {
+		if (Task* task = m_queues[index]->deques[priority].pop())
+			return task;
+	}
+
+	if (m_injected.load(std::memory_order_relaxed) > 0) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto& tasks = m_tasks[priority];
+		if (!tasks.empty()) {
+			Task* task = tasks.front();
+			tasks.pop();
+			m_injected.fetch_sub(1, std::memory_order_relaxed);
+			return task;
+		}
+	}
+
+	const std::size_t count = m_queues.size();
+	const std::size_t start = index >= 0 ? static_cast<std::size_t>(index) + 1 : 0;
+	for (std::size_t i = 0; i < count; ++i) {
+		const std::size_t victim = (start + i) % count;
+		if (static_cast<int>(victim) == index)
+			continue;
+		if (Task* task = m_queues[victim]->deques[priority].steal()) {
+			m_stolen.fetch_add(1, std::memory_order_relaxed);
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+void ThreadPool::runTask(Task* task)
+{
+	m_queued.fetch_sub(1, std::memory_order_relaxed);
+	m_running.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		PROFILE_ZONE("ThreadPool::runTask"); // busy time of the workers, the Performance window's utilisation
+		std::unique_ptr<Task> owned(task);
+		(*owned)();
+	}
+
+	m_running.fetch_sub(1, std::memory_order_relaxed);
+	m_completed.fetch_add(1, std::memory_order_relaxed);
+
+	if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		std::lock_guard<std::mutex> lock(m_idleMutex);
+		m_idleCondition.notify_all();
+	}
+}
+
+bool ThreadPool::tryRunPendingTask()
+{
+	Task* task = findTask(currentIndex());
+	if (!task)
+		return false;
+
+	runTask(task);
+	return true;
+}
+
+bool ThreadPool::hasQueuedTasks() const
+{
+	if (m_injected.load(std::memory_order_seq_cst) > 0)
+		return true;
+
+	return std::any_of(m_queues.begin(), m_queues.end(), [](const auto& worker) {
+		return std::any_of(worker->deques.begin(), worker->deques.end(), [](const auto& deque) { return !deque.empty(); });
+	});
+}
+
+void ThreadPool::waitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_idleMutex);
+	m_idleCondition.wait(lock, [this]() { return m_pending.load(std::memory_order_acquire) == 0; });
+}
@@ -0,0 +1,142 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Test events take application slots, like the application's own events
+    struct Ping {
+        static constexpr core::EventId Id = core::AppEventId(0);
+        int value;
+    };
+
+    struct Pong {
+        static constexpr core::EventId Id = core::AppEventId(1);
+        int value;
+    };
+}
+
+TEST_CASE("EventBus delivers published events synchronously", "[EventBus]") {
+    core::EventBus bus;
+    std::vector<int> received;
+
+    auto id = bus.subscribe<Ping>([&](const Ping& ping) { received.push_back(ping.value); });
+    bus.subscribe<Pong>([&](const Pong& pong) { received.push_back(-pong.value); });
+
+    bus.publish(Ping{ 1 });
+    bus.publish(Pong{ 2 });
+    bus.unsubscribe(id);
+    bus.publish(Ping{ 3 });
+
+    std::vector<int> expected = { 1, -2 };
+    REQUIRE(received == expected);
+}
+
+TEST_CASE("EventBus handlers may subscribe and unsubscribe during dispatch", "[EventBus]") {
+    core::EventBus bus;
+    int first = 0;
+    int second = 0;
+
+    core::EventBus::SubscriptionId self = 0;
+    self = bus.subscribe<Ping>([&](const Ping&) {
+        ++first;
+        bus.unsubscribe(self);
+        bus.subscribe<Ping>([&](const Ping&) { ++second; });
+    });
+
+    bus.publish(Ping{ 0 });
+    REQUIRE(first == 1);
+    REQUIRE(second == 0);
+
+    bus.publish(Ping{ 0 });
+    REQUIRE(first == 1);
+    REQUIRE(second == 1);
+}
+
+TEST_CASE("EventBus recovers from a throwing handler", "[EventBus]") {
+    core::EventBus bus;
+    int calls = 0;
+    auto id = bus.subscribe<Ping>([&](const Ping& ping) {
+        ++calls;
+        if (ping.value < 0)
+            throw std::runtime_error("handler failed");
+    });
+
+    REQUIRE_THROWS(bus.publish(Ping{ -1 }));
+    bus.post(Ping{ -1 });
+    bus.post(Ping{ -2 });
+    REQUIRE_THROWS(bus.dispatchQueued());
+    REQUIRE(calls == 2); // the second queued event was dropped
+
+    // Unsubscribing still takes effect right away
+    bus.unsubscribe(id);
+    bus.publish(Ping{ 1 });
+    bus.post(Ping{ 2 });
+    REQUIRE(bus.dispatchQueued() == 1);
+    REQUIRE(calls == 2);
+}
+
+TEST_CASE("EventBus queues posted events until dispatchQueued", "[EventBus]") {
+    core::MemoryPool pool(64, 256);
+    core::EventBus bus(&pool);
+
+    constexpr int kThreads = 4;
+    constexpr int kEvents = 10000;
+
+    std::vector<std::vector<int>> pings(kThreads);
+    long pongs = 0;
+    bus.subscribe<Ping>([&](const Ping& ping) { pings[ping.value / kEvents].push_back(ping.value % kEvents); });
+    bus.subscribe<Pong>([&](const Pong& pong) { pongs += pong.value; });
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&bus, t]() {
+            for (int i = 0; i < kEvents; ++i) {
+                bus.post(Ping{ t * kEvents + i });
+                bus.post(Pong{ 1 });
+            }
+        });
+    }
+
+    // Drain concurrently with the producers, like the UI thread does every frame
+    std::size_t delivered = 0;
+    while (delivered < 2 * kThreads * kEvents)
+        delivered += bus.dispatchQueued();
+    for (auto& producer : producers)
+        producer.join();
+
+    REQUIRE(bus.dispatchQueued() == 0);
+    REQUIRE(bus.getQueuedCount() == 0);
+    REQUIRE(pongs == kThreads * kEvents);
+
+    // Each producer's events arrive in the order they were posted
+    for (const auto& values : pings) {
+        REQUIRE(values.size() == kEvents);
+        bool ordered = true;
+        for (int i = 0; i < kEvents; ++i)
+            ordered = ordered && values[i] == i;
+        REQUIRE(ordered);
+    }
+}
+
+TEST_CASE("EventBus wakes the consumer when an event is posted", "[EventBus]") {
+    static std::atomic<int> wakes{ 0 };
+    core::EventBus bus;
+    bus.setWakeHandler([] { wakes.fetch_add(1); });
+
+    std::thread producer([&bus]() { bus.post(Ping{ 1 }); });
+    producer.join();
+    REQUIRE(wakes.load() == 1);
+
+    bus.publish(Ping{ 2 }); // synchronous, nobody to wake
+    REQUIRE(wakes.load() == 1);
+
+    bus.setWakeHandler(nullptr);
+    bus.post(Ping{ 3 });
+    REQUIRE(wakes.load() == 1);
+    REQUIRE(bus.dispatchQueued() == 2);
+}
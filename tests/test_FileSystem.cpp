@@ -1,103 +1,268 @@
-#define NOMINMAX
-#define CATCH_CONFIG_MAIN
-#include <catch2/catch_test_macros.hpp>
-#include <catch2/catch_all.hpp>
-#include <catch2/matchers/catch_matchers_all.hpp>
-
-#include "Core.hpp" // Assuming FileSystem is declared here
-#include <fstream>
-
-namespace fs = std::filesystem;
-
-TEST_CASE("FileSystem creates and removes directories", "[FileSystem]") {
-    core::FileSystem fs;
-    std::string dir = "TestDir";
-
-    SECTION("Create directory") {
-        REQUIRE(core::FileSystem::createDirectory(dir));
-        REQUIRE(core::FileSystem::exists(dir));
-    }
-
-    SECTION("Remove directory") {
-        core::FileSystem::createDirectory(dir);
-        REQUIRE(core::FileSystem::remove(dir));
-        REQUIRE_FALSE(core::FileSystem::exists(dir));
-    }
-}
-
-TEST_CASE("FileSystem reads and writes files", "[FileSystem]") {
-    std::string dir = "TestDir";
-    std::string file = dir + "/test.txt";
-    std::string content = "Hello Catch2!";
-
-    core::FileSystem::createDirectory(dir);
-
-    SECTION("Write file") {
-        REQUIRE(core::FileSystem::writeFile(file, content));
-        REQUIRE(core::FileSystem::exists(file));
-    }
-
-    SECTION("Read file") {
-        core::FileSystem::writeFile(file, content);
-        auto result = core::FileSystem::readFile(file);
-        REQUIRE(result.has_value());
-        REQUIRE(result.value() == content);
-    }
-
-    // Cleanup
-    core::FileSystem::remove(dir);
-}
-
-TEST_CASE("FileSystem listFiles works", "[FileSystem]") {
-    const std::string dir = "ListTestDir";
-    const std::string file1 = dir + "/a.txt";
-    const std::string file2 = dir + "/b.txt";
-
-    // Ensure test directory exists
-    REQUIRE(core::FileSystem::createDirectory(dir));
-
-    // Create two files with different content
-    REQUIRE(core::FileSystem::writeFile(file1, "File A"));
-    REQUIRE(core::FileSystem::writeFile(file2, "File B"));
-
-    // List files in directory (non-recursive)
-    auto files = core::FileSystem::listFiles(dir);
-    REQUIRE(files.size() == 2);
-
-    // Extract just the filenames
-    std::vector<std::string> found;
-    found.reserve(files.size());
-    std::transform(files.begin(), files.end(), std::back_inserter(found),
-                   [](const std::filesystem::path& p) { return p.filename().string(); });
-
-    // Check if both expected filenames are found, order doesn't matter
-   // REQUIRE_THAT(found, Catch::Matchers::UnorderedEquals({"a.txt", "b.txt"})); TODO Fix missmatched arguments?
-
-    // Cleanup test directory and contents
-    REQUIRE(core::FileSystem::remove(dir));
-}
-
-TEST_CASE("FileSystem exists handles files and folders", "[FileSystem]") {
-    std::string dir = "ExistTestDir";
-    std::string file = dir + "/file.txt";
-
-    REQUIRE_FALSE(core::FileSystem::exists(dir));
-    REQUIRE(core::FileSystem::createDirectory(dir));
-    REQUIRE(core::FileSystem::exists(dir));
-
-    REQUIRE(core::FileSystem::writeFile(file, "data"));
-    REQUIRE(core::FileSystem::exists(file));
-
-    // Cleanup
-    core::FileSystem::remove(dir);
-}
-
-TEST_CASE("FileSystem handles invalid read/write safely", "[FileSystem]") {
-    std::string invalidFile = "/root/forbidden.txt"; // assuming this will fail on most systems
-
-    auto result = core::FileSystem::readFile(invalidFile);
-    REQUIRE_FALSE(result.has_value());
-
-    bool writeResult = core::FileSystem::writeFile(invalidFile, "Should fail");
-    REQUIRE_FALSE(writeResult);
-}
+#define NOMINMAX
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <catch2/matchers/catch_matchers_all.hpp>
+
+#include "Core.hpp" // Assuming FileSystem is declared here
+#include <fstream>
+#include <algorithm>
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+TEST_CASE("FileSystem creates and removes directories", "[FileSystem]") {
+    core::FileSystem fs;
+    std::string dir = "TestDir";
+
+    SECTION("Create directory") {
+        REQUIRE(core::FileSystem::createDirectory(dir));
+        REQUIRE(core::FileSystem::exists(dir));
+    }
+
+    SECTION("Remove directory") {
+        core::FileSystem::createDirectory(dir);
+        REQUIRE(core::FileSystem::remove(dir));
+        REQUIRE_FALSE(core::FileSystem::exists(dir));
+    }
+}
+
+TEST_CASE("FileSystem reads and writes files", "[FileSystem]") {
+    std::string dir = "TestDir";
+    std::string file = dir + "/test.txt";
+    std::string content = "Hello Catch2!";
+
+    core::FileSystem::createDirectory(dir);
+
+    SECTION("Write file") {
+        REQUIRE(core::FileSystem::writeFile(file, content));
+        REQUIRE(core::FileSystem::exists(file));
+    }
+
+    SECTION("Read file") {
+        core::FileSystem::writeFile(file, content);
+        auto result = core::FileSystem::readFile(file);
+        REQUIRE(result.has_value());
+        REQUIRE(result.value() == content);
+    }
+
+    // Cleanup
+    core::FileSystem::remove(dir);
+}
+
+TEST_CASE("FileSystem listFiles works", "[FileSystem]") {
+    const std::string dir = "ListTestDir";
+    const std::string file1 = dir + "/a.txt";
+    const std::string file2 = dir + "/b.txt";
+
+    // Ensure test directory exists
+    REQUIRE(core::FileSystem::createDirectory(dir));
+
+    // Create two files with different content
+    REQUIRE(core::FileSystem::writeFile(file1, "File A"));
+    REQUIRE(core::FileSystem::writeFile(file2, "File B"));
+
+    // List files in directory (non-recursive)
+    auto files = core::FileSystem::listFiles(dir);
+    REQUIRE(files.size() == 2);
+
+    // Extract just the filenames
+    std::vector<std::string> found;
+    found.reserve(files.size());
+    std::transform(files.begin(), files.end(), std::back_inserter(found),
+                   [](const std::filesystem::path& p) { return p.filename().string(); });
+
+    // Check if both expected filenames are found, order doesn't matter
+   // REQUIRE_THAT(found, Catch::Matchers::UnorderedEquals({"a.txt", "b.txt"})); TODO Fix missmatched arguments?
+
+    // Cleanup test directory and contents
+    REQUIRE(core::FileSystem::remove(dir));
+}
+
+TEST_CASE("FileSystem exists handles files and folders", "[FileSystem]") {
+    std::string dir = "ExistTestDir";
+    std::string file = dir + "/file.txt";
+
+    REQUIRE_FALSE(core::FileSystem::exists(dir));
+    REQUIRE(core::FileSystem::createDirectory(dir));
+    REQUIRE(core::FileSystem::exists(dir));
+
+    REQUIRE(core::FileSystem::writeFile(file, "data"));
+    REQUIRE(core::FileSystem::exists(file));
+
+    // Cleanup
+    core::FileSystem::remove(dir);
+}
+
+TEST_CASE("FileSystem handles invalid read/write safely", "[FileSystem]") {
+    std::string invalidFile = "/root/forbidden.txt"; // assuming this will fail on most systems
+
+    auto result = core::FileSystem::readFile(invalidFile);
+    REQUIRE_FALSE(result.has_value());
+
+    bool writeResult = core::FileSystem::writeFile(invalidFile, "Should fail");
+    REQUIRE_FALSE(writeResult);
+}
+
+TEST_CASE("FileSystem scan honours .gitignore and exclude globs", "[FileSystem]") {
+    const std::string dir = "ScanTestDir";
+    core::FileSystem::remove(dir);
+    REQUIRE(core::FileSystem::createDirectory(dir));
+    for (const char* sub : { "/src", "/src/nested", "/build", "/.git", "/third_party" })
+        REQUIRE(core::FileSystem::createDirectory(dir + sub));
+
+    REQUIRE(core::FileSystem::writeFile(dir + "/.gitignore", "build/\n*.o\n"));
+    REQUIRE(core::FileSystem::writeFile(dir + "/src/nested/.gitignore", "!keep.o\n"));
+    for (const char* file : { "/main.cpp", "/src/a.cpp", "/src/a.o", "/src/nested/b.cpp", "/src/nested/keep.o",
+                              "/build/out.cpp", "/.git/HEAD", "/third_party/lib.cpp" })
+        REQUIRE(core::FileSystem::writeFile(dir + file, "data"));
+
+    std::mutex mutex;
+    std::vector<std::string> found;
+    core::ScanOptions options;
+    options.excludeGlobs = { "/third_party" };
+
+    core::ThreadPool pool(4);
+    auto scan = core::FileSystem::scan(pool, dir, options, [&](std::vector<fs::path>&& files) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& file : files)
+            found.push_back(file.lexically_relative(dir).generic_string());
+    });
+    scan->wait();
+
+    REQUIRE(scan->isFinished());
+    std::sort(found.begin(), found.end());
+    const std::vector<std::string> expected{ ".gitignore", "main.cpp", "src/a.cpp", "src/nested/.gitignore", "src/nested/b.cpp", "src/nested/keep.o" };
+    REQUIRE(found == expected);
+    REQUIRE(scan->getFileCount() == found.size());
+
+    core::FileSystem::remove(dir);
+}
+
+TEST_CASE("FileSystem maps files read-only", "[FileSystem]") {
+    const std::string dir = "MapTestDir";
+    core::FileSystem::createDirectory(dir);
+
+    SECTION("The mapping shows the file's bytes") {
+        std::string content(100000, '\0');
+        for (std::size_t i = 0; i < content.size(); ++i)
+            content[i] = static_cast<char>('a' + i % 26);
+        REQUIRE(core::FileSystem::writeFile(dir + "/big.txt", content));
+
+        auto mapped = core::FileSystem::mapFile(dir + "/big.txt");
+        REQUIRE(mapped.has_value());
+        REQUIRE(mapped->size() == content.size());
+        REQUIRE(std::string_view(mapped->data(), mapped->size()) == content);
+
+        std::string middle(10, '\0');
+        REQUIRE(mapped->copy(50000, middle.size(), middle.data()));
+        REQUIRE(middle == content.substr(50000, 10));
+        REQUIRE_FALSE(mapped->copy(content.size() - 5, 10, middle.data()));
+
+        REQUIRE(core::FileSystem::readFile(dir + "/big.txt") == content);
+    }
+
+    SECTION("Empty and missing files") {
+        REQUIRE(core::FileSystem::writeFile(dir + "/empty.txt", ""));
+        auto empty = core::FileSystem::mapFile(dir + "/empty.txt");
+        REQUIRE(empty.has_value());
+        REQUIRE(empty->empty());
+        REQUIRE(core::FileSystem::readFile(dir + "/empty.txt") == std::string());
+
+        REQUIRE_FALSE(core::FileSystem::mapFile(dir + "/missing.txt").has_value());
+        REQUIRE_FALSE(core::FileSystem::mapFile(dir).has_value());
+    }
+
+#ifdef __linux__
+    SECTION("Files without a reported size are read to the end") {
+        auto status = core::FileSystem::readFile("/proc/self/status");
+        REQUIRE(status.has_value());
+        REQUIRE(status->starts_with("Name:"));
+    }
+#endif
+
+#ifndef _WIN32
+    SECTION("Truncation by another writer makes copy fail instead of crashing") {
+        REQUIRE(core::FileSystem::writeFile(dir + "/shrinking.txt", std::string(3 * 65536, 'x')));
+        auto mapped = core::FileSystem::mapFile(dir + "/shrinking.txt");
+        REQUIRE(mapped.has_value());
+
+        fs::resize_file(dir + "/shrinking.txt", 0);
+        std::string out(mapped->size(), '\0');
+        REQUIRE_FALSE(mapped->copy(0, out.size(), out.data()));
+
+        // Still usable afterwards
+        fs::resize_file(dir + "/shrinking.txt", 3 * 65536);
+        REQUIRE(mapped->copy(0, out.size(), out.data()));
+    }
+
+    SECTION("Views read in place and report truncation") {
+        REQUIRE(core::FileSystem::writeFile(dir + "/viewed.txt", std::string(3 * 65536, 'x')));
+        auto mapped = core::FileSystem::mapFile(dir + "/viewed.txt");
+        REQUIRE(mapped.has_value());
+
+        std::size_t xs = 0;
+        REQUIRE(mapped->view(65536, 65536, [&](std::string_view bytes) {
+            REQUIRE(bytes.data() == mapped->data() + 65536);
+            xs = static_cast<std::size_t>(std::count(bytes.begin(), bytes.end(), 'x'));
+        }));
+        REQUIRE(xs == 65536);
+
+        fs::resize_file(dir + "/viewed.txt", 0);
+        REQUIRE_FALSE(mapped->view(0, mapped->size(), [&](std::string_view bytes) {
+            xs = static_cast<std::size_t>(std::count(bytes.begin(), bytes.end(), 'x'));
+        }));
+        REQUIRE(xs == 0); // past the end the view showed zeros
+    }
+#endif
+
+    core::FileSystem::remove(dir);
+}
+
+TEST_CASE("FileSystem replaces files atomically", "[FileSystem]") {
+    const std::string dir = "AtomicTestDir";
+    core::FileSystem::remove(dir);
+    core::FileSystem::createDirectory(dir);
+    const std::string file = dir + "/doc.txt";
+
+    SECTION("New and existing files get the new content, no temporary is left behind") {
+        REQUIRE(core::FileSystem::writeFileAtomic(file, "first"));
+        REQUIRE(core::FileSystem::readFile(file) == std::string("first"));
+
+        const std::string big(3 * 1024 * 1024, 'q');
+        REQUIRE(core::FileSystem::writeFileAtomic(file, big));
+        REQUIRE(core::FileSystem::readFile(file) == big);
+
+        REQUIRE(core::FileSystem::listFiles(dir).size() == 1);
+    }
+
+    SECTION("A missing directory fails without creating anything") {
+        REQUIRE_FALSE(core::FileSystem::writeFileAtomic(dir + "/missing/doc.txt", "data"));
+        REQUIRE(core::FileSystem::listFiles(dir, true).empty());
+    }
+
+    SECTION("Saving writes a document back in the encoding it was read in") {
+        const std::string original("\xFF\xFE" "a\0\xE9\0", 6);
+        REQUIRE(core::FileSystem::writeFile(file, original));
+
+        std::string text = *core::FileSystem::readFile(file);
+        const core::TextEncoding encoding = core::DecodeText(text);
+        REQUIRE(core::FileSystem::saveFile(text, file, encoding).has_value());
+        REQUIRE(core::FileSystem::readFile(file) == original);
+    }
+
+#ifndef _WIN32
+    SECTION("Permissions are kept and symlinks keep pointing at the file") {
+        REQUIRE(core::FileSystem::writeFile(file, "old"));
+        fs::permissions(file, fs::perms::owner_read | fs::perms::owner_write | fs::perms::owner_exec);
+        fs::create_symlink("doc.txt", dir + "/link.txt");
+
+        REQUIRE(core::FileSystem::writeFileAtomic(dir + "/link.txt", "new"));
+        REQUIRE(fs::is_symlink(dir + "/link.txt"));
+        REQUIRE(core::FileSystem::readFile(file) == std::string("new"));
+        REQUIRE((fs::status(file).permissions() & fs::perms::all) == (fs::perms::owner_read | fs::perms::owner_write | fs::perms::owner_exec));
+    }
+#endif
+
+    core::FileSystem::remove(dir);
+}
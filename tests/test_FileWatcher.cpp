@@ -0,0 +1,64 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// Polls the watcher until a change set arrives or the timeout expires
+static std::vector<core::FileChange> waitForChanges(core::FileWatcher& watcher, std::vector<core::FileChange>& received) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (received.empty() && std::chrono::steady_clock::now() < deadline) {
+        watcher.pollChanges();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return received;
+}
+
+TEST_CASE("FileWatcher batches changes below a watched directory", "[FileWatcher]") {
+    const std::string dir = "WatchTestDir";
+    core::FileSystem::remove(dir);
+    REQUIRE(core::FileSystem::createDirectory(dir));
+
+    core::FileWatcher watcher(std::chrono::milliseconds(50));
+    std::vector<core::FileChange> received;
+    int batches = 0;
+    watcher.watch(dir, [&](const std::vector<core::FileChange>& changes) {
+        received.insert(received.end(), changes.begin(), changes.end());
+        ++batches;
+    });
+
+    SECTION("A burst is delivered as one change set") {
+        REQUIRE(core::FileSystem::createDirectory(dir + "/sub"));
+        for (int i = 0; i < 20; ++i)
+            REQUIRE(core::FileSystem::writeFile(dir + "/sub/file" + std::to_string(i) + ".txt", "data"));
+
+        auto changes = waitForChanges(watcher, received);
+        REQUIRE(batches == 1);
+        REQUIRE(changes.size() == 21);
+        for (const auto& change : changes)
+            REQUIRE(change.type == core::FileChangeType::Created);
+    }
+
+    SECTION("A file created and removed within the window is not reported") {
+        REQUIRE(core::FileSystem::writeFile(dir + "/keep.txt", "data"));
+        REQUIRE(core::FileSystem::writeFile(dir + "/temp.txt", "data"));
+        REQUIRE(core::FileSystem::remove(dir + "/temp.txt"));
+
+        auto changes = waitForChanges(watcher, received);
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].path.filename() == "keep.txt");
+    }
+
+    SECTION("Unwatched paths are no longer reported") {
+        watcher.unwatch(dir);
+        REQUIRE(core::FileSystem::writeFile(dir + "/ignored.txt", "data"));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        watcher.pollChanges();
+        REQUIRE(received.empty());
+    }
+
+    core::FileSystem::remove(dir);
+}
@@ -0,0 +1,59 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <cstdint>
+
+TEST_CASE("FrameArena bump allocates and rewinds per frame", "[FrameArena]") {
+    core::FrameArena arena(1024);
+
+    SECTION("Allocations honour alignment") {
+        void* a = arena.allocate(3, 1);
+        void* b = arena.allocate(8, 8);
+        void* c = arena.allocate(1, 64);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(b) % 8 == 0);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(c) % 64 == 0);
+        REQUIRE(a != b);
+        REQUIRE(arena.getStats().used >= 3 + 8 + 1);
+    }
+
+    SECTION("Reset reuses the same memory") {
+        void* first = arena.allocate(100, 8);
+        arena.reset();
+        REQUIRE(arena.getStats().used == 0);
+        REQUIRE(arena.allocate(100, 8) == first);
+    }
+
+    SECTION("An overflowing frame makes the next frames fit one chunk") {
+        core::FrameVector<int> numbers(&arena);
+        for (int i = 0; i < 2000; ++i)
+            numbers.push_back(i);
+        REQUIRE(numbers[1999] == 1999);
+        REQUIRE(arena.getStats().overflows > 0);
+
+        const std::size_t peak = arena.getStats().used;
+        arena.reset();
+        REQUIRE(arena.getStats().capacity >= peak);
+
+        core::FrameString text(&arena);
+        core::FrameVector<int> again(&arena);
+        for (int i = 0; i < 2000; ++i)
+            again.push_back(i);
+        text.assign(200, 'x');
+        REQUIRE(arena.getStats().overflows == 0);
+    }
+
+    SECTION("The last frame's stats survive the reset") {
+        void* first = arena.allocate(16, 8);
+        void* second = arena.allocate(32, 8);
+        REQUIRE(first != nullptr);
+        REQUIRE(second != nullptr);
+        REQUIRE(first != second);
+        REQUIRE(arena.getStats().allocations == 2);
+
+        arena.reset();
+        REQUIRE(arena.getStats().allocations == 0);
+        REQUIRE(arena.getLastFrameStats().allocations == 2);
+        REQUIRE(arena.getLastFrameStats().used >= 48);
+    }
+}
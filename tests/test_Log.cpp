@@ -0,0 +1,70 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+template<typename... Args>
+static std::string FormatThroughRecord(core::LogFormat<Args...> format, const Args&... args)
+{
+    core::LogRecord record{};
+    record.format = format.text;
+    core::detail::PackLogArguments<core::detail::LogStored<Args>...>(record, core::detail::LogStorageFor<Args>::convert(args)...);
+
+    std::string text;
+    core::detail::FormatLogRecord<core::detail::LogStored<Args>...>(record, text);
+    return text;
+}
+
+TEST_CASE("Log records carry their arguments by value", "[Log]") {
+    SECTION("Numbers, text and braces") {
+        const std::string name = "main.cpp";
+        REQUIRE(FormatThroughRecord("{} {} {} {{x}}", 42, name, 2.5) == "42 main.cpp 2.5 {x}");
+        REQUIRE(FormatThroughRecord("{}/{}/{}", true, 'c', std::string_view("view")) == "true/c/view");
+    }
+
+    SECTION("Text is copied, the caller's buffer may change afterwards") {
+        char buffer[] = "before";
+        core::LogRecord record{};
+        record.format = "{}";
+        core::detail::PackLogArguments<core::detail::LogText>(record, std::string_view(buffer));
+        buffer[0] = 'X';
+
+        std::string text;
+        core::detail::FormatLogRecord<core::detail::LogText>(record, text);
+        REQUIRE(text == "before");
+    }
+
+    SECTION("Text that does not fit the record is kept whole") {
+        const std::string longText(5000, 'x');
+        REQUIRE(FormatThroughRecord("[{}][{}]", longText, "tail") == "[" + longText + "][tail]");
+    }
+}
+
+TEST_CASE("Log skips arguments of disabled levels", "[Log]") {
+    int evaluated = 0;
+    auto argument = [&evaluated]() { return ++evaluated; };
+
+    core::Log::SetLogLevel(core::Log::Error);
+    LOG("never written {}", core::Log::Tracer, argument());
+    REQUIRE(evaluated == 0);
+    core::Log::SetLogLevel(core::Log::Tracer);
+}
+
+TEST_CASE("Log accepts messages from many threads", "[Log]") {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < 25; ++i)
+                LOG("log test thread {} message {}", core::Log::Tracer, t, i);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    core::Log::Flush();
+    REQUIRE(core::Log::GetDroppedCount() == 0);
+}
@@ -0,0 +1,115 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("MemoryPool hands out distinct aligned blocks", "[MemoryPool]") {
+    core::MemoryPool pool(24, 16);
+
+    REQUIRE(pool.getBlockSize() >= 24);
+    REQUIRE(pool.getBlockSize() % alignof(std::max_align_t) == 0);
+
+    SECTION("Blocks are unique, aligned and reused after deallocate") {
+        std::vector<void*> blocks;
+        for (int i = 0; i < 200; ++i) {
+            void* block = pool.allocate();
+            REQUIRE(reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t) == 0);
+            blocks.push_back(block);
+        }
+
+        std::vector<void*> sorted = blocks;
+        std::sort(sorted.begin(), sorted.end());
+        REQUIRE(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+        REQUIRE(pool.getStats().inUse == 200);
+
+        for (void* block : blocks)
+            pool.deallocate(block);
+        REQUIRE(pool.getStats().inUse == 0);
+
+        const std::size_t chunks = pool.getStats().chunks;
+        for (int i = 0; i < 200; ++i)
+            blocks[i] = pool.allocate();
+        REQUIRE(pool.getStats().chunks == chunks);
+        for (void* block : blocks)
+            pool.deallocate(block);
+    }
+
+    SECTION("Works as a pmr memory resource") {
+        std::pmr::vector<std::uint64_t> small(&pool);
+        small.push_back(1); // fits a block
+        std::pmr::vector<std::uint64_t> large(1000, 7, &pool); // goes to the upstream resource
+
+        REQUIRE(small.front() == 1);
+        REQUIRE(large.back() == 7);
+        REQUIRE(pool.getStats().inUse == 1);
+    }
+}
+
+TEST_CASE("MemoryPool takes its chunks from the upstream resource", "[MemoryPool]") {
+    struct CountingResource : std::pmr::memory_resource {
+        std::size_t live = 0;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            ++live;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+            --live;
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    } upstream;
+
+    {
+        core::MemoryPool pool(32, 16, &upstream);
+        std::vector<void*> blocks;
+        for (int i = 0; i < 100; ++i)
+            blocks.push_back(pool.allocate());
+
+        REQUIRE(upstream.live == pool.getStats().chunks);
+        for (void* block : blocks)
+            pool.deallocate(block);
+    }
+    REQUIRE(upstream.live == 0);
+}
+
+TEST_CASE("MemoryPool blocks can be freed on another thread", "[MemoryPool]") {
+    core::MemoryPool pool(64, 128);
+    constexpr int kThreads = 4;
+    constexpr int kBlocks = 5000;
+
+    std::vector<std::vector<void*>> produced(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &produced, t]() {
+            for (int i = 0; i < kBlocks; ++i) {
+                auto* value = static_cast<int*>(pool.allocate());
+                *value = t * kBlocks + i;
+                produced[t].push_back(value);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    threads.clear();
+
+    // Every block still carries the value its producer wrote, then a different thread frees it
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, &produced, t]() {
+            const auto& blocks = produced[(t + 1) % kThreads];
+            for (int i = 0; i < kBlocks; ++i) {
+                if (*static_cast<int*>(blocks[i]) != ((t + 1) % kThreads) * kBlocks + i)
+                    throw std::runtime_error("block shared between allocations");
+                pool.deallocate(blocks[i]);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(pool.getStats().inUse == 0);
+}
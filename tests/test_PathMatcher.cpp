@@ -0,0 +1,44 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+
+using core::PathMatcher;
+
+TEST_CASE("PathMatcher matches gitignore patterns", "[PathMatcher]") {
+    SECTION("Names and extensions match at any depth") {
+        PathMatcher matcher({ "build", "*.o", "*_test.cpp" });
+        REQUIRE(matcher.isIgnored("build", true));
+        REQUIRE(matcher.isIgnored("src/build", true));
+        REQUIRE(matcher.isIgnored("src/main.o", false));
+        REQUIRE(matcher.isIgnored("src/parser_test.cpp", false));
+        REQUIRE_FALSE(matcher.isIgnored("src/main.cpp", false));
+        REQUIRE_FALSE(matcher.isIgnored("builder", true));
+    }
+
+    SECTION("Trailing slash only matches directories") {
+        PathMatcher matcher({ "out/" });
+        REQUIRE(matcher.isIgnored("out", true));
+        REQUIRE_FALSE(matcher.isIgnored("out", false));
+    }
+
+    SECTION("Patterns with a slash are anchored") {
+        PathMatcher matcher({ "/docs", "src/*.tmp", "assets/**/*.png", "logs/**" });
+        REQUIRE(matcher.isIgnored("docs", true));
+        REQUIRE_FALSE(matcher.isIgnored("src/docs", true));
+        REQUIRE(matcher.isIgnored("src/a.tmp", false));
+        REQUIRE_FALSE(matcher.isIgnored("src/sub/a.tmp", false));
+        REQUIRE(matcher.isIgnored("assets/icon.png", false));
+        REQUIRE(matcher.isIgnored("assets/ui/dark/icon.png", false));
+        REQUIRE(matcher.isIgnored("logs/2024/today.txt", false));
+    }
+
+    SECTION("Negations and character classes") {
+        PathMatcher matcher = PathMatcher::fromGitignore("# comment\n*.log\n!keep.log\nfile[0-9].txt\r\n");
+        REQUIRE(matcher.isIgnored("debug.log", false));
+        REQUIRE(matcher.match("keep.log", false) == PathMatcher::Result::Included);
+        REQUIRE(matcher.isIgnored("file7.txt", false));
+        REQUIRE_FALSE(matcher.isIgnored("fileA.txt", false));
+        REQUIRE(matcher.match("main.cpp", false) == PathMatcher::Result::None);
+    }
+}
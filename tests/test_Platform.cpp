@@ -0,0 +1,23 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+
+TEST_CASE("Platform file locks are exclusive until released", "[Platform]") {
+    const std::string dir = "LockTestDir";
+    core::FileSystem::remove(dir);
+    REQUIRE(core::FileSystem::createDirectory(dir));
+    const std::filesystem::path file = dir + "/session.lock";
+
+    auto first = core::Platform::lockFile(file);
+    REQUIRE(first.has_value());
+    REQUIRE(core::FileSystem::exists(file.string()));
+    REQUIRE_FALSE(core::Platform::lockFile(file).has_value());
+
+    core::Platform::unlockFile(*first);
+    auto second = core::Platform::lockFile(file);
+    REQUIRE(second.has_value());
+    core::Platform::unlockFile(*second);
+
+    core::FileSystem::remove(dir);
+}
@@ -0,0 +1,137 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace {
+
+    const core::Profiler::ThreadEvents* FindThread(const std::vector<core::Profiler::ThreadEvents>& threads, const std::string& name) {
+        auto it = std::find_if(threads.begin(), threads.end(), [&](const auto& thread) { return thread.name == name; });
+        return it == threads.end() ? nullptr : &*it;
+    }
+
+    void Nested() {
+        PROFILE_ZONE("outer");
+        PROFILE_ZONE("inner");
+    }
+
+}
+
+TEST_CASE("Profiler records nested zones per thread", "[Profiler]") {
+    core::Profiler::SetEnabled(true);
+
+    SECTION("Inner zones complete first and lie inside their parent") {
+        std::thread worker([] {
+            core::Profiler::SetThreadName("profiler nested");
+            Nested();
+        });
+        worker.join();
+
+        const auto threads = core::Profiler::Collect();
+        const auto* thread = FindThread(threads, "profiler nested");
+        REQUIRE(thread != nullptr);
+        REQUIRE(thread->events.size() == 2);
+
+        const core::ProfileEvent& inner = thread->events[0];
+        const core::ProfileEvent& outer = thread->events[1];
+        REQUIRE(std::string(inner.site->name) == "inner");
+        REQUIRE(std::string(outer.site->name) == "outer");
+        REQUIRE(outer.begin <= inner.begin);
+        REQUIRE(inner.end <= outer.end);
+    }
+
+    SECTION("A call site is interned once") {
+        std::thread worker([] {
+            core::Profiler::SetThreadName("profiler sites");
+            for (int i = 0; i < 3; ++i)
+                Nested();
+        });
+        worker.join();
+
+        const auto threads = core::Profiler::Collect();
+        const auto* thread = FindThread(threads, "profiler sites");
+        REQUIRE(thread != nullptr);
+        REQUIRE(thread->events.size() == 6);
+        REQUIRE(thread->events[0].site == thread->events[2].site);
+        REQUIRE(thread->events[1].site == thread->events[5].site);
+    }
+
+    SECTION("Disabled zones are not recorded") {
+        core::Profiler::SetEnabled(false);
+        std::thread worker([] {
+            core::Profiler::SetThreadName("profiler disabled");
+            Nested();
+        });
+        worker.join();
+        core::Profiler::SetEnabled(true);
+
+        const auto threads = core::Profiler::Collect();
+        const auto* thread = FindThread(threads, "profiler disabled");
+        REQUIRE(thread != nullptr);
+        REQUIRE(thread->events.empty());
+    }
+
+    SECTION("The ring keeps the newest events and Collect filters by time") {
+        std::uint64_t middle = 0;
+        std::thread worker([&] {
+            core::Profiler::SetThreadName("profiler ring");
+            for (std::size_t i = 0; i < core::Profiler::BufferCapacity; ++i) {
+                PROFILE_ZONE("tick");
+            }
+            middle = core::Profiler::Now();
+            for (int i = 0; i < 10; ++i) {
+                PROFILE_ZONE("tock");
+            }
+        });
+        worker.join();
+
+        const auto threads = core::Profiler::Collect();
+        const auto* all = FindThread(threads, "profiler ring");
+        REQUIRE(all != nullptr);
+        // The oldest slot is always given up, its owner could be overwriting it
+        REQUIRE(all->events.size() == core::Profiler::BufferCapacity - 1);
+        REQUIRE(std::string(all->events.back().site->name) == "tock");
+
+        const auto recentThreads = core::Profiler::Collect(middle);
+        const auto* recent = FindThread(recentThreads, "profiler ring");
+        REQUIRE(recent != nullptr);
+        REQUIRE(recent->events.size() == 10);
+    }
+
+    SECTION("Ticks convert to increasing nanoseconds") {
+        const std::uint64_t start = core::Profiler::Now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const double elapsed = core::Profiler::ToNanoseconds(core::Profiler::Now()) - core::Profiler::ToNanoseconds(start);
+        REQUIRE(elapsed >= 4e6);
+        REQUIRE(elapsed < 1e9);
+    }
+
+    SECTION("Trace export names threads and writes complete events") {
+        std::thread worker([] {
+            core::Profiler::SetThreadName("profiler \"trace\"");
+            Nested();
+        });
+        worker.join();
+
+        const std::string trace = core::Profiler::ExportTrace(60.0);
+        REQUIRE(trace.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+        REQUIRE(trace.find("\"args\":{\"name\":\"profiler \\\"trace\\\"\"}") != std::string::npos);
+        REQUIRE(trace.find("{\"name\":\"inner\",\"cat\":\"zone\",\"ph\":\"X\"") != std::string::npos);
+        REQUIRE(trace.find("]}") == trace.size() - 3);
+    }
+
+    SECTION("Trace export ends where it was asked to") {
+        Nested();
+        const std::uint64_t end = core::Profiler::Now();
+        {
+            PROFILE_ZONE("after the capture");
+        }
+
+        const std::string trace = core::Profiler::ExportTrace(60.0, end);
+        REQUIRE(trace.find("\"name\":\"inner\"") != std::string::npos);
+        REQUIRE(trace.find("after the capture") == std::string::npos);
+    }
+}
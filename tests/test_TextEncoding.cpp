@@ -0,0 +1,78 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+
+using core::TextEncoding;
+
+TEST_CASE("TextEncoding detects and converts file contents to UTF-8", "[TextEncoding]") {
+    SECTION("UTF-8 is left untouched") {
+        std::string text = "int main() { return 0; } // \xC3\xA9t\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80\n";
+        const std::string original = text;
+        REQUIRE(core::DecodeText(text) == TextEncoding::Utf8);
+        REQUIRE(text == original);
+    }
+
+    SECTION("A UTF-8 byte order mark is stripped") {
+        std::string text = "\xEF\xBB\xBFhello";
+        REQUIRE(core::DecodeText(text) == TextEncoding::Utf8Bom);
+        REQUIRE(text == "hello");
+    }
+
+    SECTION("UTF-16 is converted, surrogate pairs included") {
+        std::string little("\xFF\xFE" "a\0\xE9\0\x3D\xD8\x00\xDE", 10);
+        REQUIRE(core::DecodeText(little) == TextEncoding::Utf16LE);
+        REQUIRE(little == "a\xC3\xA9\xF0\x9F\x98\x80");
+
+        std::string big("\xFE\xFF\0a\xD8\x3D", 6);
+        REQUIRE(core::DecodeText(big) == TextEncoding::Utf16BE);
+        REQUIRE(big == "a\xEF\xBF\xBD"); // unpaired surrogate
+    }
+
+    SECTION("Invalid UTF-8 is read as Latin-1") {
+        std::string text = "caf\xE9";
+        REQUIRE(core::DecodeText(text) == TextEncoding::Latin1);
+        REQUIRE(text == "caf\xC3\xA9");
+    }
+
+    SECTION("Validation rejects overlong forms, surrogates and truncated sequences") {
+        REQUIRE(core::IsValidUtf8(""));
+        REQUIRE(core::IsValidUtf8("plain ascii that is longer than one word"));
+        REQUIRE(core::IsValidUtf8("\xF4\x8F\xBF\xBF"));
+        REQUIRE_FALSE(core::IsValidUtf8("\xC0\xAF"));
+        REQUIRE_FALSE(core::IsValidUtf8("\xE0\x80\xAF"));
+        REQUIRE_FALSE(core::IsValidUtf8("\xED\xA0\x80"));
+        REQUIRE_FALSE(core::IsValidUtf8("\xF4\x90\x80\x80"));
+        REQUIRE_FALSE(core::IsValidUtf8("ascii prefix \xE2\x82"));
+    }
+
+    SECTION("Encoding the decoded text gives back the original bytes") {
+        const std::string files[] = {
+            "plain \xC3\xA9t\xC3\xA9\n",
+            "\xEF\xBB\xBFwith a byte order mark\n",
+            std::string("\xFF\xFE" "a\0\xE9\0\x3D\xD8\x00\xDE\n\0", 12),
+            std::string("\xFE\xFF\0a\0\xE9\xD8\x3D\xDE\x00\0\n", 12),
+            "caf\xE9 cr\xE8me\n",
+        };
+        for (const std::string& file : files) {
+            std::string text = file;
+            const TextEncoding encoding = core::DecodeText(text);
+            REQUIRE(core::CanEncode(text, encoding));
+            REQUIRE(core::EncodeText(text, encoding) == file);
+        }
+    }
+
+    SECTION("Latin-1 cannot store characters above U+00FF") {
+        const std::string text = "caf\xC3\xA9 \xE2\x82\xAC";
+        REQUIRE_FALSE(core::CanEncode(text, TextEncoding::Latin1));
+        REQUIRE(core::CanEncode(text, TextEncoding::Utf16LE));
+        REQUIRE(core::EncodeText(text, TextEncoding::Latin1) == "caf\xE9 ?");
+    }
+
+    SECTION("Lines are indexed by their first character") {
+        using Starts = std::vector<std::size_t>;
+        REQUIRE(core::IndexLines("") == Starts({ 0 }));
+        REQUIRE(core::IndexLines("a\nbc\n\nd") == Starts({ 0, 2, 5, 6 }));
+        REQUIRE(core::IndexLines("end\n") == Starts({ 0, 4 }));
+    }
+}
@@ -0,0 +1,182 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    struct Hit {
+        std::size_t line;
+        std::size_t column;
+        std::size_t length;
+
+        bool operator==(const Hit&) const = default;
+    };
+
+    using Hits = std::vector<Hit>;
+
+    Hits Search(std::string_view pattern, std::string_view text, bool regex, bool caseSensitive = true) {
+        auto searcher = core::TextSearcher::create(pattern, core::SearchOptions{ regex, caseSensitive });
+        REQUIRE(searcher.has_value());
+
+        Hits hits;
+        searcher->forEachMatchingLine(text, [&](const core::TextSearcher::LineMatch& match) {
+            hits.push_back({ match.line, match.column, match.length });
+            return true;
+        });
+        return hits;
+    }
+
+    bool IsValid(std::string_view pattern) {
+        std::string error;
+        const bool valid = core::TextSearcher::create(pattern, core::SearchOptions{ true, true }, &error).has_value();
+        return valid && error.empty();
+    }
+
+}
+
+TEST_CASE("TextSearcher finds literals", "[TextSearch]") {
+    SECTION("FindLiteral agrees with std::string::find at every alignment") {
+        std::string text;
+        for (int i = 0; i < 300; ++i)
+            text += static_cast<char>('a' + (i * 7) % 26);
+        for (const std::string needle : { "a", "hov", "zgnu", "ahovcjqxe", "qxelsz", "not there" }) {
+            for (std::size_t from = 0; from < 40; ++from)
+                REQUIRE(core::TextSearcher::FindLiteral(text, needle, true, from) == text.find(needle, from));
+        }
+        REQUIRE(core::TextSearcher::FindLiteral("abc", "abcd", true) == std::string_view::npos);
+    }
+
+    SECTION("Case-insensitive search folds ASCII letters only") {
+        const std::string text = std::string(50, '-') + "Hello, WORLD" + std::string(50, '-');
+        REQUIRE(core::TextSearcher::FindLiteral(text, "world", false) == 57);
+        REQUIRE(core::TextSearcher::FindLiteral(text, "world", true) == std::string_view::npos);
+        REQUIRE(core::TextSearcher::FindLiteral(text, "hello,", false) == 50);
+        REQUIRE(core::TextSearcher::FindLiteral("a@b", "a`b", false) == std::string_view::npos);
+    }
+
+    SECTION("Each matching line is reported once with its first match") {
+        const Hits hits = Search("foo", "foo foo\nbar\n\nxfoo\nfo", false);
+        REQUIRE(hits == Hits({ { 0, 0, 3 }, { 3, 1, 3 } }));
+    }
+
+    SECTION("Empty patterns and line breaks are rejected") {
+        std::string error;
+        REQUIRE_FALSE(core::TextSearcher::create("", {}, &error).has_value());
+        REQUIRE_FALSE(error.empty());
+        REQUIRE_FALSE(core::TextSearcher::create("a\nb", {}).has_value());
+    }
+}
+
+TEST_CASE("TextSearcher matches regular expressions line by line", "[TextSearch]") {
+    SECTION("Classes, quantifiers and alternation") {
+        const std::string text = "int x = 42;\nfloat y;\nreturn x+1;\n";
+        REQUIRE(Search("[0-9]+", text, true) == Hits({ { 0, 8, 2 }, { 2, 9, 1 } }));
+        REQUIRE(Search("\\w+ [xy]", text, true) == Hits({ { 0, 0, 5 }, { 1, 0, 7 }, { 2, 0, 8 } }));
+        REQUIRE(Search("float|return", text, true) == Hits({ { 1, 0, 5 }, { 2, 0, 6 } }));
+        REQUIRE(Search("x\\+1", text, true) == Hits({ { 2, 7, 3 } }));
+        REQUIRE(Search("(ab){2,3}c", "abc\nababc\nabababababc\n", true) == Hits({ { 1, 0, 5 }, { 2, 4, 7 } }));
+        REQUIRE(Search("colou?r", "color\ncolour\ncolouur", true) == Hits({ { 0, 0, 5 }, { 1, 0, 6 } }));
+    }
+
+    SECTION("Anchors match at line boundaries") {
+        const std::string text = "abc\nxabc\nabcx\n\nabc";
+        REQUIRE(Search("^abc", text, true) == Hits({ { 0, 0, 3 }, { 2, 0, 3 }, { 4, 0, 3 } }));
+        REQUIRE(Search("abc$", text, true) == Hits({ { 0, 0, 3 }, { 1, 1, 3 }, { 4, 0, 3 } }));
+        REQUIRE(Search("^$", text, true) == Hits({ { 3, 0, 0 } }));
+        REQUIRE(Search("a.*c", "a\nb\nc\nabbc", true) == Hits({ { 3, 0, 4 } }));
+    }
+
+    SECTION("Lines found through a required literal are confirmed by the expression") {
+        REQUIRE(Search("abc[0-9]def", "abcXdef abc1def\nabc2de\n", true) == Hits({ { 0, 8, 7 } }));
+        REQUIRE(Search("HELLO\\d", "say hello1\nhello", true, false) == Hits({ { 0, 4, 6 } }));
+    }
+
+    SECTION("Case-insensitive and negated classes") {
+        REQUIRE(Search("[a-c]+X", "ABCx\nabz", true, false) == Hits({ { 0, 0, 4 } }));
+        REQUIRE(Search("[^a-z ]", "abc def\nabc1", true) == Hits({ { 1, 3, 1 } }));
+    }
+
+    SECTION("Invalid expressions are reported") {
+        REQUIRE(IsValid("a(b|c)*d{2,}"));
+        REQUIRE_FALSE(IsValid("a(b"));
+        REQUIRE_FALSE(IsValid("a)"));
+        REQUIRE_FALSE(IsValid("[abc"));
+        REQUIRE_FALSE(IsValid("*a"));
+        REQUIRE_FALSE(IsValid("a{3,1}"));
+        REQUIRE_FALSE(IsValid("\\q"));
+    }
+
+    SECTION("Copies search independently") {
+        auto searcher = core::TextSearcher::create("b+", core::SearchOptions{ true, true });
+        REQUIRE(searcher.has_value());
+        core::TextSearcher copy = *searcher;
+        std::size_t lines = 0;
+        copy.forEachMatchingLine("abbb\nc\nb", [&](const core::TextSearcher::LineMatch&) { ++lines; return true; });
+        REQUIRE(lines == 2);
+    }
+}
+
+TEST_CASE("FileSearch searches a directory tree on the thread pool", "[TextSearch]") {
+    const std::string dir = "SearchTestDir";
+    core::FileSystem::remove(dir);
+    REQUIRE(core::FileSystem::createDirectory(dir));
+    REQUIRE(core::FileSystem::createDirectory(dir + "/src"));
+    REQUIRE(core::FileSystem::createDirectory(dir + "/build"));
+
+    // The match on the last line sits behind several chunks of lines
+    std::string big;
+    for (int i = 0; i < 100000; ++i)
+        big += "filler line without a hit\n";
+    big += "needle at the end";
+
+    REQUIRE(core::FileSystem::writeFile(dir + "/.gitignore", "build/\n"));
+    REQUIRE(core::FileSystem::writeFile(dir + "/src/a.cpp", "one\nneedle here\nthree needle\n"));
+    REQUIRE(core::FileSystem::writeFile(dir + "/src/big.txt", big));
+    // A line longer than a chunk
+    REQUIRE(core::FileSystem::writeFile(dir + "/src/long.txt", std::string(3 << 20, 'x') + "needle\nneedle"));
+    REQUIRE(core::FileSystem::writeFile(dir + "/src/binary.bin", std::string("needle\0", 7)));
+    REQUIRE(core::FileSystem::writeFile(dir + "/build/out.cpp", "needle"));
+
+    std::mutex mutex;
+    std::vector<core::FileSearch::FileResult> results;
+    bool finished = false;
+
+    core::ThreadPool pool(4);
+    auto searcher = core::TextSearcher::create("needle", {});
+    REQUIRE(searcher.has_value());
+    core::FileSearch search(pool, dir, *searcher, {}, [&](core::FileSearch::FileResult&& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(std::move(result));
+    }, [&]() { finished = true; });
+    search.wait();
+
+    REQUIRE(search.isFinished());
+    REQUIRE(finished);
+    std::sort(results.begin(), results.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+    REQUIRE(results.size() == 3);
+
+    REQUIRE(results[0].path.filename() == "a.cpp");
+    REQUIRE(results[0].lines.size() == 2);
+    REQUIRE(results[0].lines[1].line == 2);
+    REQUIRE(results[0].lines[1].column == 6);
+    REQUIRE(results[0].lines[1].preview == "three needle");
+
+    REQUIRE(results[1].path.filename() == "big.txt");
+    REQUIRE(results[1].lines.size() == 1);
+    REQUIRE(results[1].lines[0].line == 100000);
+
+    REQUIRE(results[2].path.filename() == "long.txt");
+    REQUIRE(results[2].lines.size() == 2);
+    REQUIRE(results[2].lines[0].column == (3 << 20));
+    REQUIRE(results[2].lines[1].line == 1);
+    REQUIRE(search.getMatchCount() == 5);
+
+    core::FileSystem::remove(dir);
+}
@@ -0,0 +1,170 @@
+#define NOMINMAX
+#include <catch2/catch_test_macros.hpp>
+
+#include "Core.hpp"
+#include <algorithm>
+#include <ctime>
+#include <numeric>
+
+TEST_CASE("ThreadPool runs enqueued tasks", "[ThreadPool]") {
+    core::ThreadPool pool(4);
+
+    SECTION("Futures return results") {
+        auto sum = pool.enqueue([](int a, int b) { return a + b; }, 2, 3);
+        REQUIRE(sum.get() == 5);
+    }
+
+    SECTION("waitIdle waits for every task") {
+        std::atomic<int> count{ 0 };
+        for (int i = 0; i < 1000; ++i)
+            pool.enqueue([&count]() { ++count; });
+        pool.waitIdle();
+        REQUIRE(count.load() == 1000);
+    }
+
+    SECTION("Tasks can wait for nested tasks without deadlocking") {
+        // More waiting parents than workers, only works if waiting workers keep running tasks
+        std::function<long(int)> fib = [&](int n) -> long {
+            if (n < 2)
+                return n;
+            auto left = pool.enqueue(fib, n - 1);
+            const long right = fib(n - 2);
+            pool.waitFor(left);
+            return left.get() + right;
+        };
+        REQUIRE(pool.enqueue(fib, 18).get() == 2584);
+    }
+
+    SECTION("A task can wait for shared futures") {
+        std::vector<std::shared_future<int>> parts;
+        for (int i = 0; i < 16; ++i)
+            parts.push_back(pool.enqueue([i]() { return i; }).share());
+        auto total = pool.enqueue([&pool, &parts]() {
+            int sum = 0;
+            for (const auto& part : parts) {
+                pool.waitFor(part);
+                sum += part.get();
+            }
+            return sum;
+        });
+        REQUIRE(total.get() == 120);
+    }
+
+    SECTION("A worker waiting with nothing to run does not spin") {
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        auto waiting = pool.enqueue([&pool, released]() { pool.waitFor(released); });
+
+        const std::clock_t start = std::clock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        const double cpuSeconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        release.set_value();
+        waiting.get();
+        REQUIRE(cpuSeconds < 0.15);
+    }
+
+    SECTION("Exceptions reach the future") {
+        auto failing = pool.enqueue([]() -> int { throw std::runtime_error("task failed"); });
+        bool thrown = false;
+        try {
+            failing.get();
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        REQUIRE(thrown);
+    }
+}
+
+TEST_CASE("WorkStealingDeque hands out every item exactly once", "[ThreadPool]") {
+    constexpr int count = 100000;
+    std::vector<int> items(count);
+    std::iota(items.begin(), items.end(), 0);
+    std::vector<std::atomic<int>> seen(count);
+
+    core::WorkStealingDeque<int> deque(4); // small so it has to grow
+    std::atomic<bool> done{ false };
+
+    auto thief = [&]() {
+        while (!done.load() || !deque.empty()) {
+            if (int* item = deque.steal())
+                ++seen[*item];
+        }
+    };
+    std::thread thief1(thief), thief2(thief);
+
+    for (int i = 0; i < count; ++i) {
+        deque.push(&items[i]);
+        if (i % 3 == 0) {
+            if (int* item = deque.pop())
+                ++seen[*item];
+        }
+    }
+    while (int* item = deque.pop())
+        ++seen[*item];
+
+    done.store(true);
+    thief1.join();
+    thief2.join();
+
+    bool exactlyOnce = true;
+    for (const auto& s : seen)
+        exactlyOnce = exactlyOnce && s.load() == 1;
+    REQUIRE(exactlyOnce);
+}
+
+TEST_CASE("ThreadPool schedules by priority and honours cancellation", "[ThreadPool]") {
+    core::ThreadPool pool(1);
+
+    // Keeps the only worker busy until the test has queued everything
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    auto blocker = pool.enqueue([released]() { released.wait(); });
+
+    SECTION("Interactive tasks run before queued background tasks") {
+        std::mutex mutex;
+        std::vector<core::TaskPriority> order;
+        auto record = [&](core::TaskPriority priority) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(priority);
+        };
+
+        for (int i = 0; i < 16; ++i)
+            pool.enqueue(core::TaskPriority::Background, record, core::TaskPriority::Background);
+        for (int i = 0; i < 16; ++i)
+            pool.enqueue(core::TaskPriority::Interactive, record, core::TaskPriority::Interactive);
+
+        release.set_value();
+        pool.waitIdle();
+
+        REQUIRE(order.size() == 32);
+        const auto lastInteractive = std::find(order.rbegin(), order.rend(), core::TaskPriority::Interactive);
+        const auto backgroundFirst = std::count(lastInteractive, order.rend(), core::TaskPriority::Background);
+        REQUIRE(backgroundFirst <= 3); // only the starvation protection lets background work in early
+    }
+
+    SECTION("Cancelled tasks are skipped") {
+        core::CancellationToken token;
+        bool ran = false;
+        auto cancelled = pool.enqueue(core::TaskPriority::Normal, token, [&ran]() { ran = true; });
+        token.cancel();
+
+        release.set_value();
+        bool thrown = false;
+        try {
+            cancelled.get();
+        }
+        catch (const core::TaskCancelled&) {
+            thrown = true;
+        }
+        REQUIRE(thrown);
+        REQUIRE_FALSE(ran);
+
+        pool.waitIdle();
+        const auto stats = pool.getStats();
+        REQUIRE(stats.cancelled == 1);
+        REQUIRE(stats.completed == 2);
+        REQUIRE(stats.queued == 0);
+        REQUIRE(stats.running == 0);
+    }
+}